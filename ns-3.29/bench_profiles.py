@@ -0,0 +1,88 @@
+#!/usr/bin/env python
+# Benchmark matrix of build profiles on the scratch experiments.
+#
+# Each profile is configured and built in its own output directory
+# (build/<profile>, with its own waf lock file) so the main build is left
+# untouched.  Every experiment is then run --repeats times per profile with
+# --counters, and the median wall clock time, the simulator event count and
+# the event rate are reported, together with the speedup over the first
+# profile of the list.
+import os
+import sys
+import subprocess
+import argparse
+from experiment_runner import run_experiment, median
+
+MODULES = "core,network,internet,point-to-point,nix-vector-routing,traffic-control,flow-monitor,brite"
+
+def waf(profile, arguments):
+    env = dict(os.environ, WAFLOCK=".lock-waf_" + profile)
+    command = [sys.executable, "./waf"] + arguments
+    print(" ".join(command))
+    subprocess.check_call(command, env=env)
+
+def build(profile):
+    out = os.path.join("build", profile)
+    waf(profile, ["configure", "--build-profile=" + profile, "--out=" + out] + Args.configure_args.split())
+    waf(profile, ["build"])
+    return out
+
+def run_profile(out, experiment, N):
+    name, arguments = experiment
+    return run_experiment(out, Args.brite, name, ["--N=" + N, "--no_runs=" + str(Args.no_runs),
+                                                   "--topology=" + Args.topology] + arguments.split())
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument("-p", "--profiles", default="debug,optimized,production", help="build profiles to compare, use format: debug,optimized")
+parser.add_argument("-e", "--experiments", default="bcast,tree,tree:--B=4,hyper,hyper:--C=2",
+                    help="experiments and extra arguments, use format: tree:--B=4 --group,hyper")
+parser.add_argument("-s", "--experiment_sizes", default="256", help="number of nodes for different experiments, use format: 8,16,32")
+parser.add_argument("-t", "--topology", default="star", help="topology: star, star_as or brite")
+parser.add_argument("-n", "--no_runs", default=3, type=int, help="number of protocol runs per experiment")
+parser.add_argument("-r", "--repeats", default=3, type=int, help="number of times to repeat each experiment")
+parser.add_argument("-c", "--configure_args", default="--disable-werror --with-brite=../BRITE --enable-modules=" + MODULES,
+                    help="extra arguments for waf configure")
+parser.add_argument("-b", "--brite", default="../BRITE", help="directory of libbrite.so")
+parser.add_argument("--no_build", action="store_true", help="use the existing build/<profile> directories")
+parser.add_argument("-o", "--output", help="csv file to store the results")
+Args = parser.parse_args()
+
+profiles = Args.profiles.split(',')
+sizes = Args.experiment_sizes.split(',')
+experiments = [(e.split(':', 1) + [""])[:2] for e in Args.experiments.split(',')]
+
+outs = {}
+for profile in profiles:
+    outs[profile] = os.path.join("build", profile) if(Args.no_build) else build(profile)
+
+rows = []
+for name, arguments in experiments:
+    for N in sizes:
+        baseline = None
+        for profile in profiles:
+            walls = []
+            for i in range(Args.repeats):
+                wall, counters = run_profile(outs[profile], (name, arguments), N)
+                walls.append(wall)
+            wall = median(walls)
+            events = int(counters.get("events", 0))
+            if(baseline is None):
+                baseline = wall
+            rows.append([name + (" " + arguments if(arguments) else ""), N, profile,
+                         "%.3f" % wall, str(events), "%.0f" % (events / wall), "%.2f" % (baseline / wall)])
+            print(",".join(rows[-1]))
+            sys.stdout.flush()
+
+header = ["experiment", "N", "profile", "wall_s", "events", "events_per_s", "speedup"]
+widths = [max(len(str(row[i])) for row in rows + [header]) for i in range(len(header))]
+print("")
+for row in [header] + rows:
+    print("  ".join(str(row[i]).ljust(widths[i]) for i in range(len(header))))
+
+if(Args.output):
+    results = open(Args.output, "w")
+    results.write(",".join(header) + "\n")
+    for row in rows:
+        results.write(",".join(row) + "\n")
+    results.close()
@@ -0,0 +1,128 @@
+#!/usr/bin/env python
+# Canonical benchmark suite of the scratch experiments.
+#
+# Runs the workloads we study (bcast, tree with B=2, 4, 16 and --bcast,
+# hyper with C=1, 2, 4 with and without --group) on the star, star_as and
+# brite topologies, at fixed sizes and with a fixed --RngSeed/--RngRun, so
+# that the numbers of two builds or two commits are comparable.  Each
+# workload is run --repeats times and the median times are reported with
+# the event count and the peak resident set size of the process:
+#
+#   setup_s       wall clock time to build the topology and connect the sockets
+#   wall_s        wall clock time of the measured protocol runs
+#   sim_s         simulated time at the end of the experiment
+#   events        events processed, setup included
+#   events_per_s  events of the measured runs per second of wall_s
+#   peak_rss_kb   peak resident set size of the experiment process
+#
+# With --baseline, the results are compared to those of a previous --output
+# csv file: a workload whose wall_s grew by more than --tolerance is a
+# regression and makes the script exit with status 1.  A change of the
+# event count means the simulated behaviour changed, and is reported too.
+import sys
+import argparse
+import json
+from experiment_runner import run_experiment, median
+
+EXPERIMENTS = ["bcast", "tree", "tree:--B=4", "tree:--B=16", "tree:--bcast",
+               "hyper:--C=1", "hyper:--C=2", "hyper:--C=4",
+               "hyper:--C=1 --group", "hyper:--C=2 --group", "hyper:--C=4 --group"]
+TOPOLOGIES = ["star", "star_as", "brite"]
+HEADER = ["topology", "experiment", "N", "setup_s", "wall_s", "sim_s", "events", "events_per_s", "peak_rss_kb"]
+
+def run_workload(name, arguments, N, topology):
+    wall, counters = run_experiment(Args.build, Args.brite, name,
+                                    ["--N=" + N, "--no_runs=" + str(Args.no_runs), "--topology=" + topology,
+                                     "--RngSeed=" + str(Args.seed), "--RngRun=" + str(Args.run)] +
+                                    arguments.split() + Args.arguments.split())
+    return counters
+
+def benchmark(name, arguments, N, topology):
+    samples = [run_workload(name, arguments, N, topology) for i in range(Args.repeats)]
+    events = set(s["events"] for s in samples)
+    if(len(events) != 1):
+        print("warning: " + name + " " + arguments + " N=" + N + " on " + topology +
+              " processed a different number of events in each repeat: " + ",".join(events))
+    wall = median([float(s["wall_s"]) for s in samples])
+    run_events = int(samples[0]["events"]) - int(samples[0]["setup_events"])
+    return [topology, name + (" " + arguments if(arguments) else ""), N,
+            "%.3f" % median([float(s["setup_s"]) for s in samples]),
+            "%.3f" % wall,
+            "%.6f" % float(samples[0]["sim_s"]),
+            samples[0]["events"],
+            "%.0f" % (run_events / wall if(wall > 0) else 0),
+            str(max(int(s["peak_rss_kb"]) for s in samples))]
+
+def compare(rows, baseline_file):
+    baseline = {}
+    lines = open(baseline_file).read().splitlines()
+    columns = lines[0].split(',')
+    for line in lines[1:]:
+        row = dict(zip(columns, line.split(',')))
+        baseline[(row["topology"], row["experiment"], row["N"])] = row
+    regressions = 0
+    print("")
+    print("compared to " + baseline_file + ":")
+    for row in rows:
+        row = dict(zip(HEADER, row))
+        base = baseline.get((row["topology"], row["experiment"], row["N"]))
+        if(base is None):
+            continue
+        ratio = float(row["wall_s"]) / float(base["wall_s"]) if(float(base["wall_s"]) > 0) else 1.0
+        notes = []
+        if(ratio > 1 + Args.tolerance):
+            notes.append("REGRESSION")
+            regressions += 1
+        if(row["events"] != base["events"]):
+            notes.append("events " + base["events"] + " -> " + row["events"])
+        print("  %-8s %-22s N=%-6s wall %8s -> %8s s (x%.2f)  rss %s -> %s kB  %s" %
+              (row["topology"], row["experiment"], row["N"], base["wall_s"], row["wall_s"], ratio,
+               base["peak_rss_kb"], row["peak_rss_kb"], " ".join(notes)))
+    return regressions
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument("-e", "--experiments", default=",".join(EXPERIMENTS),
+                    help="experiments and extra arguments, use format: tree:--B=4 --group,hyper")
+parser.add_argument("-t", "--topologies", default=",".join(TOPOLOGIES), help="topologies, use format: star,star_as")
+parser.add_argument("-s", "--experiment_sizes", default="256",
+                    help="number of nodes, use format: 256,1024 (brite needs at least 256)")
+parser.add_argument("-n", "--no_runs", default=2, type=int, help="protocol runs per experiment")
+parser.add_argument("-r", "--repeats", default=3, type=int, help="number of times to repeat each experiment")
+parser.add_argument("--seed", default=1, type=int, help="RngSeed of every experiment")
+parser.add_argument("--run", default=1, type=int, help="RngRun of every experiment")
+parser.add_argument("-args", "--arguments", default="", help="extra arguments for every experiment, e.g. --direct_links")
+parser.add_argument("-b", "--build", default="build", help="waf build directory")
+parser.add_argument("--brite", default="../BRITE", help="directory of libbrite.so")
+parser.add_argument("-o", "--output", help="csv file to store the results")
+parser.add_argument("-j", "--json", help="json file to store the results")
+parser.add_argument("--baseline", help="csv file of a previous run to compare against")
+parser.add_argument("--tolerance", default=0.10, type=float, help="relative wall time increase reported as a regression")
+Args = parser.parse_args()
+
+experiments = [(e.split(':', 1) + [""])[:2] for e in Args.experiments.split(',')]
+rows = []
+print(",".join(HEADER))
+for topology in Args.topologies.split(','):
+    for N in Args.experiment_sizes.split(','):
+        for name, arguments in experiments:
+            rows.append(benchmark(name, arguments, N, topology))
+            print(",".join(rows[-1]))
+            sys.stdout.flush()
+
+if(Args.output):
+    results = open(Args.output, "w")
+    results.write(",".join(HEADER) + "\n")
+    for row in rows:
+        results.write(",".join(row) + "\n")
+    results.close()
+
+if(Args.json):
+    results = open(Args.json, "w")
+    json.dump({"seed": Args.seed, "run": Args.run, "no_runs": Args.no_runs, "repeats": Args.repeats,
+               "arguments": Args.arguments, "results": [dict(zip(HEADER, row)) for row in rows]},
+              results, indent=1)
+    results.close()
+
+if(Args.baseline and compare(rows, Args.baseline) > 0):
+    sys.exit(1)
@@ -1,41 +1,63 @@
 #!/usr/bin/env python
+# Aggregates the runs of the experiments in a results directory.
+#
+# The scratch experiments run with --results=<dir> store one row per run in
+# <dir>/<experiment>/results.db, through the SqliteDataOutput of the stats
+# module: the Experiments table names the run, the Metadata table holds its
+# parameters and seed and the Singletons table its times and counters.  The
+# runs are pivoted and aggregated in a single query per database, so that
+# sweeps of tens of thousands of runs are summed up at once.
 import os
 import sys
+import argparse
+import sqlite3
 
-def get_time(time):
-    time_to_ns = float(time.lstrip("+").rstrip("s"))*1000000000
-    return "+" + '{:f}'.format(time_to_ns) + "ns"
+# the metadata which tell the runs apart rather than the experiments
+RUN_KEYS = ("invocation", "run", "seed", "rng_run")
 
-def parse_file(file, output):
-        first = True
-        for line in file:
-            if("RUN: " in line):
-                time = get_time(line.split()[0])
-                if(first):
-                    output.write("\nRUN: \n" + time + ',')
-                    first = False
-                else:
-                    output.write(time + '\n' + time + ',')
-            elif("all nodes are done" in line):
-                time = get_time(line.split()[0])
-                output.write(time + '\n')
-                
-def parse(directory):
-    experiments = sorted(os.listdir(directory))
-    data = open(os.path.join(directory, "data"), 'w')
+QUERY = """
+with runs as (
+    select max(experiment) as experiment, max(strategy) as topology, max(cast(input as integer)) as N,
+        max(case when variable = 'proposal_ns' then value end) as proposal_ns,
+        max(case when variable = 'done_ns' then value end) as done_ns,
+        max(case when variable = 'events' then value end) as events,
+        max(case when variable = 'wall_s' then value end) as wall_s,
+        group_concat(case when key not in (%s) then key || '=' || value end, ' ') as parameters,
+        max(case when key = 'run' then cast(value as integer) end) as run_index
+    from (select run, experiment, strategy, input, null as variable, null as key, null as value from Experiments
+          union all select run, null, null, null, variable, null, value from Singletons
+          union all select run, null, null, null, null, key, value from Metadata
+          order by run, key)
+    group by run)
+select experiment, topology, N, ifnull(parameters, ''), count(*),
+    avg(proposal_ns) / 1e9, min(proposal_ns) / 1e9, max(proposal_ns) / 1e9,
+    avg(done_ns) / 1e9, min(done_ns) / 1e9, max(done_ns) / 1e9,
+    avg(events), avg(wall_s)
+from runs
+where run_index >= ?
+group by experiment, topology, N, parameters
+order by experiment, N
+""" % ", ".join("'" + key + "'" for key in RUN_KEYS)
 
-    no = 0
-    for exp in experiments:
-        if("data" in exp):
-            continue
-        no += 1
-        file = open(os.path.join(directory, exp), 'r')
-        parse_file(file, data)
-        file.close()
-    print(no)
+HEADER = ["experiment", "topology", "N", "parameters", "runs",
+          "proposal_s", "proposal_min_s", "proposal_max_s",
+          "done_s", "done_min_s", "done_max_s", "events", "wall_s"]
 
-root = sys.argv[1]
-dirs = [dI for dI in os.listdir(root) if os.path.isdir(os.path.join(root,dI))]
-for dir in dirs:
-    print(os.path.join(root,dir))
-    parse(os.path.join(root,dir))
+parser = argparse.ArgumentParser()
+parser.add_argument("results", help="results directory of the experiments")
+parser.add_argument("-o", "--output", help="csv file to store the aggregates, standard output if none")
+parser.add_argument("-w", "--warm_up", default=0, type=int, help="number of runs of each process to leave out")
+Args = parser.parse_args()
+
+output = open(Args.output, "w") if(Args.output) else sys.stdout
+output.write(",".join(HEADER) + "\n")
+for exp in sorted(os.listdir(Args.results)):
+    path = os.path.join(Args.results, exp, "results.db")
+    if(not os.path.isfile(path)):
+        continue
+    db = sqlite3.connect(path)
+    for row in db.execute(QUERY, (Args.warm_up,)):
+        output.write(",".join(str(value) for value in row) + "\n")
+    db.close()
+if(Args.output):
+    output.close()
@@ -2,6 +2,7 @@
 import os
 import sys
 import argparse
+import sqlite3
 import matplotlib
 #matplotlib.use('Agg')
 import matplotlib.pyplot as plt
@@ -16,10 +17,8 @@ def get_data_points(data,size):
         no_runs = max(5, int(len(run)/2))
         print(str(size) + " " + str(no_runs))
         for p in range(len(run) - no_runs, len(run)):
-            start_time = float(run[p][0].lstrip("+").rstrip("ns"))/1000000000
             for i in range(1,len(run[p])):
-                time = float(run[p][i].lstrip("+").rstrip("ns"))/1000000000
-                sums[i-1] += time-start_time
+                sums[i-1] += run[p][i] - run[p][0]
         for i in range(len(sums)):
             sums[i] /= no_runs
         data_points.append(sums)
@@ -46,9 +45,7 @@ def plot_dist(data, size, show, latex):
     for run in data[size]:
         end_times = []
         for data_point in run:
-            end_time = float(data_point[len(data_point) - 1].lstrip("+").rstrip("ns"))/1000000000
-            start_time = float(data_point[0].lstrip("+").rstrip("ns"))/1000000000
-            end_times.append(end_time-start_time)
+            end_times.append(data_point[-1] - data_point[0])
         plt.plot(end_times, marker="o")
         plt.xlabel("number of runs")
         plt.ylabel("latency (s)")
@@ -110,15 +107,28 @@ def plot_avg(data, sizes, show, latex):
     if(show):
         plt.show()
 
-def parse_data(file, data, size):
-    data[size] = []
-    for line in file:
-        if("RUN" in line or "new" in line):
-            data[size].append([])
-        elif(line.strip()):
-            pt = line.strip(',\n').split(',')
-            if len(pt) > 1:
-                data[size][len(data[size]) - 1].append(pt)
+# the proposal and done times in seconds of the runs, in the order of the runs of each process
+QUERY = """
+select max(cast(input as integer)) as N, max(case when key = 'invocation' then value end) as invocation,
+    max(case when variable = 'proposal_ns' then value end) / 1e9,
+    max(case when variable = 'done_ns' then value end) / 1e9
+from (select run, input, null as variable, null as key, null as value from Experiments
+      union all select run, null, variable, null, value from Singletons
+      union all select run, null, null, key, value from Metadata)
+group by run
+order by N, invocation, max(case when key = 'run' then cast(value as integer) end)
+"""
+
+def parse_data(results_dir, data, sizes_loc):
+    db = sqlite3.connect(os.path.join(results_dir, "results.db"))
+    last = None
+    for size, invocation, proposal, done in db.execute(QUERY):
+        if((size, invocation) != last):
+            data.setdefault(size, []).append([])
+            sizes_loc[size] = results_dir
+            last = (size, invocation)
+        data[size][-1].append([.0, proposal, done])
+    db.close()
 
 parser = argparse.ArgumentParser()
 parser.add_argument("-r", "--results", nargs = "+", required=True, help="results directory of the experiment")
@@ -131,21 +141,12 @@ Args = parser.parse_args()
 Args.len = 3
 Args.fig = 0
 
-sizes = set()
 sizes_loc = {}
 data = {}
 
 for results_dir in Args.results:
-    for d in os.listdir(results_dir):
-        if(os.path.isdir(os.path.join(results_dir, d))):
-            sizes.add(int(d))
-            sizes_loc[int(d)] = results_dir
-sizes = sorted(sizes)
-
-for size in sizes:
-    data_file = open(os.path.join(sizes_loc[size], str(size), "data"))
-    parse_data(data_file, data, size)
-    data_file.close()
+    parse_data(results_dir, data, sizes_loc)
+sizes = sorted(sizes_loc)
 data = OrderedDict(sorted(data.items(), key = lambda t: t[0]))
 
 for size in sizes:
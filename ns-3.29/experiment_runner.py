@@ -0,0 +1,37 @@
+# Runs the scratch experiments of a waf build directory.
+#
+# Shared by bench_profiles.py, benchmark.py and replicate.py: the experiment
+# binaries are run directly, with the libraries of the build and of BRITE on
+# the LD_LIBRARY_PATH, and the COUNTERS line printed by --counters is parsed
+# into a dictionary.  A run can be given its own working directory, for the
+# files the experiment leaves there (BRITE seed files in particular).
+import os
+import subprocess
+import time
+
+def library_environment(build, brite):
+    # the environment with the libraries of the build and of BRITE
+    env = dict(os.environ)
+    libs = [os.path.abspath(os.path.join(build, "lib")), os.path.abspath(brite)]
+    if(env.get("LD_LIBRARY_PATH")):
+        libs.append(env["LD_LIBRARY_PATH"])
+    env["LD_LIBRARY_PATH"] = ":".join(libs)
+    return env
+
+def run_experiment(build, brite, name, arguments, cwd=None):
+    # runs build/scratch/<name> with --counters and the list of arguments in
+    # the directory cwd (default: the current one), returns the wall clock
+    # time of the process and its counters
+    command = [os.path.abspath(os.path.join(build, "scratch", name)), "--counters"] + arguments
+    start = time.time()
+    output = subprocess.check_output(command, env=library_environment(build, brite), cwd=cwd,
+                                     stderr=subprocess.STDOUT).decode()
+    wall = time.time() - start
+    for line in output.splitlines():
+        if(line.startswith("COUNTERS: ")):
+            return wall, dict(field.split("=") for field in line[len("COUNTERS: "):].split())
+    raise RuntimeError("no COUNTERS line in the output of " + " ".join(command))
+
+def median(values):
+    values = sorted(values)
+    return values[len(values) // 2]
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+# Independent replications of a scratch experiment with statistical stopping.
+#
+# Replication r runs the experiment in its own process with --RngRun=r (and
+# a fixed --RngSeed), so every replication draws from a distinct substream of
+# the ns-3 random number generator and any sample can be reproduced by
+# rerunning its run number.  Up to --workers replications run at a time.
+# The driver collects the completion times printed by --counters and stops
+# once the confidence interval of the mean completion time is narrower than
+# --precision (relative half width), or after --max_replications.
+# Only the replications first_run..k with no gap count, both for the
+# stopping rule and for the final estimate, so that neither depends on which
+# worker finished first.  Needs Python 3.8 for statistics.NormalDist.
+# Every replication runs in a temporary directory of its own, so that the
+# seed files BRITE writes to the working directory are not shared by the
+# replications running at the same time; paths given with -args must be
+# absolute.
+import os
+import sys
+import argparse
+import math
+import statistics
+import tempfile
+from concurrent.futures import ThreadPoolExecutor, FIRST_COMPLETED, wait
+from experiment_runner import run_experiment
+
+METRICS = ["last_run_done_ns", "last_run_proposal_ns", "events", "wall_s"]
+
+def t_quantile(p, df):
+    # Student t quantile from the normal one (Abramowitz & Stegun 26.7.5)
+    z = statistics.NormalDist().inv_cdf(p)
+    return (z + (z**3 + z) / (4.0 * df) + (5 * z**5 + 16 * z**3 + 3 * z) / (96.0 * df**2) +
+            (3 * z**7 + 19 * z**5 + 17 * z**3 - 15 * z) / (384.0 * df**3) +
+            (79 * z**9 + 776 * z**7 + 1482 * z**5 - 1920 * z**3 - 945 * z) / (92160.0 * df**4))
+
+def half_width(samples):
+    n = len(samples)
+    return t_quantile(0.5 + Args.confidence / 2.0, n - 1) * statistics.stdev(samples) / math.sqrt(n)
+
+def prefix_samples(results):
+    # samples of the runs first_run..k with no gap
+    samples = []
+    while(Args.first_run + len(samples) in results):
+        samples.append(float(results[Args.first_run + len(samples)][Args.metric]))
+    return samples
+
+def run_replication(run):
+    arguments = [" --" + arg.strip() for arg in Args.arguments.split(',')] if(Args.arguments) else []
+    with tempfile.TemporaryDirectory(prefix="replication_" + str(run) + "_") as cwd:
+        wall, counters = run_experiment(Args.build, Args.brite, Args.experiment_file,
+                                        ["--N=" + Args.N, "--no_runs=" + str(Args.no_runs), "--topology=" + Args.topology,
+                                         "--brite_conf_dir=" + os.path.join(os.path.abspath(Args.brite), "conf_files"),
+                                         "--RngSeed=" + str(Args.seed), "--RngRun=" + str(run)] +
+                                        "".join(arguments).split(), cwd=cwd)
+    return run, counters
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument("-e", "--experiment_file", required=True, help="experiment to run: bcast, tree or hyper")
+parser.add_argument("-N", "--N", required=True, help="number of nodes")
+parser.add_argument("-t", "--topology", default="star", help="topology: star, star_as or brite")
+parser.add_argument("-n", "--no_runs", default=2, type=int, help="protocol runs per replication, the last one is measured")
+parser.add_argument("-args", "--arguments", help="extra arguments for ns3, use format: C=2,group")
+parser.add_argument("-w", "--workers", default=os.cpu_count(), type=int, help="number of replications running at a time")
+parser.add_argument("--min_replications", default=5, type=int, help="replications before testing the confidence interval")
+parser.add_argument("--max_replications", default=100, type=int, help="maximum number of replications")
+parser.add_argument("-c", "--confidence", default=0.95, type=float, help="confidence level")
+parser.add_argument("-p", "--precision", default=0.01, type=float, help="target relative half width of the confidence interval")
+parser.add_argument("-m", "--metric", default="last_run_done_ns", choices=METRICS, help="metric the stopping rule applies to")
+parser.add_argument("-s", "--seed", default=1, type=int, help="RngSeed shared by all replications")
+parser.add_argument("-f", "--first_run", default=1, type=int, help="RngRun of the first replication")
+parser.add_argument("-b", "--build", default="build", help="waf build directory")
+parser.add_argument("--brite", default="../BRITE", help="directory of libbrite.so and of the conf_files")
+parser.add_argument("-o", "--output", help="csv file to store the samples")
+Args = parser.parse_args()
+
+results = {}
+next_run = Args.first_run
+stop = False
+pool = ThreadPoolExecutor(max_workers=Args.workers)
+pending = set()
+while(pending or not stop):
+    while(not stop and len(pending) < Args.workers and next_run < Args.first_run + Args.max_replications):
+        pending.add(pool.submit(run_replication, next_run))
+        next_run += 1
+    if(not pending):
+        break
+    done, pending = wait(pending, return_when=FIRST_COMPLETED)
+    for future in done:
+        run, counters = future.result()
+        results[run] = counters
+        print("run " + str(run) + ": " + " ".join(m + "=" + counters[m] for m in METRICS))
+        sys.stdout.flush()
+
+    samples = prefix_samples(results)
+    if(len(samples) >= max(Args.min_replications, 2)):
+        mean = statistics.mean(samples)
+        width = half_width(samples)
+        print("%d replications: mean %s = %f, %g%% CI half width = %f (%.3f%%)" %
+              (len(samples), Args.metric, mean, Args.confidence * 100, width, 100 * width / mean if(mean) else 0))
+        if(width <= Args.precision * abs(mean)):
+            stop = True
+    if(len(results) >= Args.max_replications):
+        stop = True
+pool.shutdown()
+
+samples = prefix_samples(results)
+if(len(samples) >= 2):
+    mean = statistics.mean(samples)
+    width = half_width(samples)
+    print("done: %d replications, mean %s = %f +- %f (%g%% CI)" % (len(samples), Args.metric, mean, width, Args.confidence * 100))
+
+if(Args.output):
+    output = open(Args.output, "w")
+    output.write("run," + ",".join(METRICS) + "\n")
+    for run in sorted(results):
+        output.write(str(run) + "," + ",".join(results[run][m] for m in METRICS) + "\n")
+    output.close()
@@ -53,7 +53,7 @@ void set_experiment_name()
 	}
 	else
 	{
-		assert(false);
+		NS_FATAL_ERROR("unknown topology " << topology);
 	}
 }
 
@@ -70,10 +70,10 @@ void run(int argc, char *argv[])
 
 	start_node = 0;
 	generate_topology(false);
-	set_messages(messages);
+	make_schedule("bcast_N" + std::to_string(N), &set_messages);
 	if(verbose)
 	{
-		print_messages(messages);
+		print_messages();
 	}
 
 	run_experiment();
@@ -3,6 +3,11 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <fstream>
+#include <cstdio>
+#include <random>
+#include <sys/resource.h>
+#include <ctime>
 
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
@@ -11,6 +16,10 @@
 #include "ns3/internet-module.h"
 #include "ns3/brite-module.h"
 #include "ns3/ipv4-nix-vector-helper.h"
+#include "ns3/traffic-control-helper.h"
+#ifdef HAVE_SQLITE3
+#include "ns3/stats-module.h"
+#endif
 
 using namespace ns3;
 using std::string;
@@ -41,6 +50,15 @@ int no_AS;
 
 //optimization variables
 bool full_msg_sizes;
+bool direct_links;
+bool coalesce_delivery;
+bool lazy_headers;
+uint32_t segment_offload;
+bool skip_handshake;
+
+//profiling variables
+uint32_t profile_events;
+double memory_report;
 
 //send message size variables
 const int HMAC_SIZE = 32;
@@ -51,6 +69,10 @@ const int HEADERS = 32 + 32;
 const int TCP_PAYLOAD = MTU - HEADERS;
 uint8_t dummy_data[TCP_PAYLOAD]; //data to write into packets
 
+//random stream variables, draws depend on --RngSeed and --RngRun only
+const int BRITE_STREAM = 3;
+const int SHUFFLE_STREAM = 4;
+
 //node IP + AS assignment variables
 map<int, Ipv4Address>   node_ips;
 map<Ipv4Address, int>   node_ids;
@@ -69,18 +91,56 @@ map<int, Ptr<Socket>>   *sockets;
 int current_run;
 int no_runs;
 
-//communication logic variables
+//communication schedule variables, the drivers fill one message list per node which is then compiled
+//into one array: the messages of node n are schedule_messages[schedule_offsets[n]] to schedule_messages[schedule_offsets[n+1]-1]
 vector<message> *messages;
-vector<int>		*node_buffers;
-int             *current_msg;
+vector<int>     schedule_offsets;
+vector<message> schedule_messages;
+string          schedule_dir; //directory of the compiled schedules reused by later runs, empty for none
+
+//communication logic variables
+int             *current_msg; //index in schedule_messages of the current message of each node
+//messages from a peer arrive in the order the node receives them, so a message which arrives early
+//is matched at once with the next message of the node from that peer, whose slot is marked as arrived
+vector<int>     next_recv_slot; //for each message received, the next message the node receives from the same peer, -1 if none
+vector<pair<int, int>> recv_links; //node and peer of each connection a node receives from, its index is bound to recv
+vector<int>     recv_slot; //slot of the next message received on each connection, -1 if none
+vector<bool>    arrived; //messages received before their node expected them
+int             *no_buffered; //messages received early by each node and not handled yet
 int             no_rcvd_proposal;
 int             no_rcvd_hash;
 
+//results variables, one row per run in results_dir/experiment/results.db
+struct run_result
+{
+	Time start;
+	Time proposal; //all nodes received the proposal
+	Time done; //all nodes are done
+	uint64_t events;
+	double wall_seconds;
+};
+vector<run_result>  run_results;
+map<string, double> parameters; //parameters of the driver, stored with every run
+uint64_t            run_start_events;
+SystemWallClockMs   run_clock;
+
 //logging variables
-std::ofstream       results;
 bool                verbose;
+bool                trace; //ascii traces of the devices and of IPv4
+bool                pcap; //packet captures of the devices
+uint32_t            snaplen; //bytes of each packet captured, 0 for all
 bool                log_experiment;
 bool                monitor_flow;
+
+//counter variables, kept in every build profile
+bool                print_counters;
+uint64_t            messages_sent;
+uint64_t            messages_buffered;
+uint64_t            bytes_received;
+Time                last_run_start;
+Time                last_run_proposal;
+Time                last_run_done;
+SystemWallClockMs   setup_clock; //topology and connection setup, up to the measured runs
 FlowMonitorHelper   fmh;
 Ptr<FlowMonitor>    monitor;
 
@@ -93,23 +153,25 @@ NodeContainer nodes;
 string results_dir;
 string experiment;
 string topology;
+string brite_conf_dir;
 int	  start_node;
 
 void connect_sockets(NodeContainer nodes);
 void set_callbacks();
 void write(Ptr<Socket> socket, uint32_t available);
 void send(int node);
-void recv(Ptr<Socket> socket);
+void recv(int link, Ptr<Socket> socket);
 void generate_brite_topology(bool group);
 void generate_AS_star_topology(bool group);
 void generate_star_topology();
+void reset_schedule();
 
 void allocate()
 {
 	AS_members = new vector<int>[no_AS]();
 	messages = new vector<message>[N]();
-	node_buffers = new vector<int>[N]();
 	current_msg = new int[N]();
+	no_buffered = new int[N]();
 
 	sockets = new map<int,Ptr<Socket>>[N]();
 }
@@ -119,11 +181,7 @@ void reset_experiment()
 	no_rcvd_hash = 0;
 	no_rcvd_proposal = 1;    
 
-	for (int i = 0; i < N; i++)
-	{
-		node_buffers[i].clear();
-		current_msg[i] = 0;
-	}
+	reset_schedule();
 
 	for(int i = 0; i < N; i++)
 	{
@@ -141,22 +199,190 @@ void reset_experiment()
 	}
 }
 
-void print_messages(vector<message> *messages)
+void print_messages()
 {
 	cout << "messages..." << endl;
 
 	for(int node = 0; node < N; node++)
 	{
 		cout << node << ": ";
-		for(unsigned int i = 0; i < messages[node].size(); i++)
+		for(int i = schedule_offsets[node]; i < schedule_offsets[node + 1]; i++)
 		{
-			cout << "(" << messages[node][i].send_to << "," << messages[node][i].recv_from << "," <<
-							messages[node][i].phase << "," << messages[node][i].size << ");";
+			cout << "(" << schedule_messages[i].send_to << "," << schedule_messages[i].recv_from << "," <<
+							schedule_messages[i].phase << "," << schedule_messages[i].size << ");";
 		}
 		cout << endl;
 	}
 }	
 
+/*
+*	schedule functions
+*/
+
+const char SCHEDULE_MAGIC[8] = {'N', 'S', '3', 'S', 'C', 'H', 'D', '1'};
+
+void compile_schedule()
+{
+	schedule_offsets.assign(N + 1, 0);
+	for(int node = 0; node < N; node++)
+	{
+		schedule_offsets[node + 1] = schedule_offsets[node] + messages[node].size();
+	}
+	schedule_messages.clear();
+	schedule_messages.reserve(schedule_offsets[N]);
+	for(int node = 0; node < N; node++)
+	{
+		schedule_messages.insert(schedule_messages.end(), messages[node].begin(), messages[node].end());
+	}
+	delete[] messages;
+	messages = NULL;
+}
+
+string schedule_path(string key)
+{
+	return schedule_dir + "/" + key + ".schedule";
+}
+
+//binary file: magic, key, N, offsets, then the fields of each message, all integers in host byte order
+void save_schedule(string key)
+{
+	//written aside and renamed, runs started in parallel may save the same schedule
+	string path = schedule_path(key);
+	string tmp_path = path + "." + std::to_string(std::random_device()());
+	std::ofstream out(tmp_path, std::ios::binary);
+	int32_t key_size = key.size();
+	int32_t n = N;
+	out.write(SCHEDULE_MAGIC, sizeof(SCHEDULE_MAGIC));
+	out.write((const char *) &key_size, sizeof(key_size));
+	out.write(key.data(), key_size);
+	out.write((const char *) &n, sizeof(n));
+	out.write((const char *) schedule_offsets.data(), (N + 1) * sizeof(int));
+	for(const message &m : schedule_messages)
+	{
+		int32_t fields[6] = {m.send_to, m.recv_from, m.size, m.phase, m.c_phase, m.broadcast};
+		out.write((const char *) fields, sizeof(fields));
+	}
+	out.close();
+	if(!out || std::rename(tmp_path.c_str(), path.c_str()) != 0)
+	{
+		std::remove(tmp_path.c_str());
+		NS_LOG_WARN("cannot save the schedule to " << path);
+	}
+}
+
+bool load_schedule(string key)
+{
+	std::ifstream in(schedule_path(key), std::ios::binary);
+	char magic[sizeof(SCHEDULE_MAGIC)];
+	int32_t key_size = 0;
+	if(!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), SCHEDULE_MAGIC) ||
+		!in.read((char *) &key_size, sizeof(key_size)) || key_size != (int32_t) key.size())
+	{
+		return false;
+	}
+	string file_key(key_size, ' ');
+	int32_t n = 0;
+	if(!in.read(&file_key[0], key_size) || file_key != key || !in.read((char *) &n, sizeof(n)) || n != N)
+	{
+		return false;
+	}
+	vector<int> offsets(N + 1);
+	if(!in.read((char *) offsets.data(), (N + 1) * sizeof(int)) || offsets[0] != 0)
+	{
+		return false;
+	}
+	vector<message> entries(offsets[N]);
+	for(message &m : entries)
+	{
+		int32_t fields[6];
+		if(!in.read((char *) fields, sizeof(fields)))
+		{
+			return false;
+		}
+		m = message{fields[0], fields[1], fields[2], fields[3], fields[4], fields[5] != 0};
+	}
+	schedule_offsets.swap(offsets);
+	schedule_messages.swap(entries);
+	delete[] messages;
+	messages = NULL;
+	return true;
+}
+
+//links each message received to the next one from the same peer
+void index_schedule()
+{
+	next_recv_slot.assign(schedule_messages.size(), -1);
+	arrived.assign(schedule_messages.size(), false);
+	for(int node = 0; node < N; node++)
+	{
+		map<int, int> next;
+		for(int i = schedule_offsets[node + 1] - 1; i >= schedule_offsets[node]; i--)
+		{
+			int peer = schedule_messages[i].recv_from;
+			if(peer != -1)
+			{
+				map<int, int>::iterator it = next.find(peer);
+				next_recv_slot[i] = (it == next.end()) ? -1 : it->second;
+				next[peer] = i;
+			}
+		}
+	}
+}
+
+//points each connection at the first message its node receives on it
+void reset_recv_slots()
+{
+	recv_slot.assign(recv_links.size(), -1);
+	//the links of a node are consecutive
+	for(size_t link = 0; link < recv_links.size();)
+	{
+		int node = recv_links[link].first;
+		map<int, int> first;
+		for(int i = schedule_offsets[node + 1] - 1; i >= schedule_offsets[node]; i--)
+		{
+			if(schedule_messages[i].recv_from != -1)
+			{
+				first[schedule_messages[i].recv_from] = i;
+			}
+		}
+		for(; link < recv_links.size() && recv_links[link].first == node; link++)
+		{
+			map<int, int>::iterator it = first.find(recv_links[link].second);
+			recv_slot[link] = (it == first.end()) ? -1 : it->second;
+		}
+	}
+}
+
+void reset_schedule()
+{
+	std::fill(arrived.begin(), arrived.end(), false);
+	for(int node = 0; node < N; node++)
+	{
+		current_msg[node] = schedule_offsets[node];
+		no_buffered[node] = 0;
+	}
+	reset_recv_slots();
+}
+
+//key names everything the schedule depends on, set_messages fills the message lists of the nodes
+void make_schedule(string key, void (*set_messages)(vector<message> *))
+{
+	if(schedule_dir.compare("") != 0 && load_schedule(key))
+	{
+		cout << "schedule loaded from " << schedule_path(key) << endl;
+	}
+	else
+	{
+		set_messages(messages);
+		compile_schedule();
+		if(schedule_dir.compare("") != 0)
+		{
+			save_schedule(key);
+		}
+	}
+	index_schedule();
+}
+
 void setup_experiment()
 {
 	if(verbose)
@@ -166,6 +392,7 @@ void setup_experiment()
 
 	no_rcvd_proposal = 1;
 	no_rcvd_hash = 0;
+	reset_schedule();
 
 	for(int i = 0; i < TCP_PAYLOAD; i++)
 	{
@@ -175,14 +402,29 @@ void setup_experiment()
 
 void initialize_variables()
 {
-	srand(time(NULL));
 	N = 8;
 	no_AS = 0;
 	no_runs = 1;
 	verbose = false;
+	trace = false;
+	pcap = false;
+	snaplen = 0;
 	monitor_flow = false;
+	print_counters = false;
+	messages_sent = 0;
+	messages_buffered = 0;
+	bytes_received = 0;
+	direct_links = false;
+	coalesce_delivery = false;
+	lazy_headers = false;
+	segment_offload = 0;
+	skip_handshake = false;
+	profile_events = 0;
+	memory_report = 0;
 	topology = "star";
+	brite_conf_dir = "../BRITE/conf_files";
 	results_dir = "";
+	schedule_dir = "";
 }
 
 void parse_default_arguments(CommandLine &cmd, int argc, char *argv[])
@@ -191,11 +433,41 @@ void parse_default_arguments(CommandLine &cmd, int argc, char *argv[])
 	cmd.AddValue("AS", "number of ASes", no_AS);
 	cmd.AddValue("verbose", "print detailed info", verbose);
 	cmd.AddValue("monitor_flow", "monitor flows", monitor_flow);
+	cmd.AddValue("trace", "write ascii traces of the devices and of IPv4 to experiment.tr, see AsyncTraceBuffer and TraceCompression", trace);
+	cmd.AddValue("pcap", "capture the packets of the devices in experiment-node-device.pcap", pcap);
+	cmd.AddValue("snaplen", "bytes of each packet captured, 0 for all", snaplen);
+	cmd.AddValue("counters", "print event and message counters at the end", print_counters);
 	cmd.AddValue("topology", "topology", topology);
+	cmd.AddValue("brite_conf_dir", "directory of the BRITE configuration files", brite_conf_dir);
 	cmd.AddValue("no_runs", "number of runs", no_runs);
-	cmd.AddValue("results", "directory for the results", results_dir);
+	cmd.AddValue("results", "directory of the results database, one row per run in results/experiment/results.db", results_dir);
+	cmd.AddValue("schedule_dir", "directory where compiled schedules are saved and reused, empty for none", schedule_dir);
 	cmd.AddValue("full_msg_sizes", "turns off the optimization for message sizes", full_msg_sizes);
+	cmd.AddValue("direct_links", "links bypass queue discs, device queues and PPP framing", direct_links);
+	cmd.AddValue("coalesce_delivery", "one pending delivery event per link direction, delivering every packet due at once", coalesce_delivery);
+	cmd.AddValue("lazy_headers", "headers travel as objects, serialized only when the bytes are needed", lazy_headers);
+	cmd.AddValue("segment_offload", "bytes of data TCP sends as one super-segment, 0 for no offload", segment_offload);
+	cmd.AddValue("skip_handshake", "connect the sockets directly in the established state, without SYN exchanges", skip_handshake);
+	cmd.AddValue("profile_events", "time one event out of this many and print where the wall time goes, 0 for no profile", profile_events);
+	cmd.AddValue("memory_report", "simulated time in seconds at which to print the memory held by type and node, 0 for no report", memory_report);
     cmd.Parse(argc, argv);
+	setup_clock.Start();
+
+#ifndef HAVE_SQLITE3
+	if(results_dir.compare("") != 0)
+	{
+		NS_FATAL_ERROR("--results needs the SQLite output of the stats module, configure ns-3 with libsqlite3");
+	}
+#endif
+
+	if(lazy_headers)
+	{
+		Packet::EnableLazyHeaders();
+	}
+	if(profile_events)
+	{
+		Config::SetDefault("ns3::DefaultSimulatorImpl::EventProfilePeriod", UintegerValue(profile_events));
+	}
     
     if(no_AS == 0)
 	{
@@ -205,8 +477,21 @@ void parse_default_arguments(CommandLine &cmd, int argc, char *argv[])
     allocate();
 }
 
+void shuffle_node_ids(vector<int> &node_id_set)
+{
+	Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+	rng->SetStream(SHUFFLE_STREAM);
+	for(int i = (int) node_id_set.size() - 1; i > 0; i--)
+	{
+		std::swap(node_id_set[i], node_id_set[rng->GetInteger(0, i)]);
+	}
+}
+
 void generate_topology(bool group)
 {
+	point_to_point.SetDeviceAttribute("DirectLink", BooleanValue(direct_links));
+	point_to_point.SetChannelAttribute("CoalesceDelivery", BooleanValue(coalesce_delivery));
+
 	if(topology.compare("star") == 0)
 	{
 		generate_star_topology();
@@ -221,20 +506,95 @@ void generate_topology(bool group)
 	}
 	else
 	{
-		assert(false);
+		NS_FATAL_ERROR("unknown topology " << topology);
 	}
 }
 
-void run_experiment()
+void report_counters(double setup_seconds, uint64_t setup_events, double wall_seconds)
 {
-	if(results_dir.compare("") != 0)
+	uint64_t events = Simulator::GetEventCount();
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	cout << "COUNTERS: events=" << events
+		<< " setup_events=" << setup_events
+		<< " setup_s=" << setup_seconds
+		<< " wall_s=" << wall_seconds
+		<< " sim_s=" << Simulator::Now().GetSeconds()
+		<< " peak_rss_kb=" << usage.ru_maxrss
+		<< " events_per_s=" << (wall_seconds > 0 ? events / wall_seconds : 0)
+		<< " messages_sent=" << messages_sent
+		<< " messages_buffered=" << messages_buffered
+		<< " bytes_received=" << bytes_received
+		<< " last_run_proposal_ns=" << (last_run_proposal - last_run_start).GetNanoSeconds()
+		<< " last_run_done_ns=" << (last_run_done - last_run_start).GetNanoSeconds()
+		<< endl;
+}
+
+#ifdef HAVE_SQLITE3
+//values of a run, output as the singletons of the run
+class run_values : public DataCalculator
+{
+public:
+	vector<pair<string, double>> values;
+
+	void Output(DataOutputCallback &callback) const
+	{
+		for(const pair<string, double> &value : values)
+		{
+			callback.OutputSingleton(m_context, value.first, value.second);
+		}
+	}
+};
+
+void write_results()
+{
+	if(results_dir.compare("") == 0)
 	{
-		string dir = results_dir + "/" + experiment + "/" + std::to_string(N) + "/data";
-		results.open(dir, std::ios_base::app);
-		results << endl << "RUN: " << endl;
-	}	
+		return;
+	}
+
+	string dir = results_dir + "/" + experiment;
+	SystemPath::MakeDirectories(dir);
+	Ptr<SqliteDataOutput> output = CreateObject<SqliteDataOutput>();
+	output->SetFilePrefix(dir + "/results");
+
+	//the runs of this process, whose warm up runs may be left out by the aggregation,
+	//written in a single transaction
+	output->BeginBatch();
+	string invocation = std::to_string(time(NULL)) + "-" + std::to_string(std::random_device()());
+	for(int run = 0; run < current_run; run++)
+	{
+		const run_result &r = run_results[run];
+		DataCollector collector;
+		collector.DescribeRun(experiment, topology, std::to_string(N), invocation + "/" + std::to_string(run));
+		collector.AddMetadata("invocation", invocation);
+		collector.AddMetadata("run", (uint32_t) run);
+		collector.AddMetadata("seed", RngSeedManager::GetSeed());
+		collector.AddMetadata("rng_run", std::to_string(RngSeedManager::GetRun()));
+		for(const pair<const string, double> &parameter : parameters)
+		{
+			collector.AddMetadata(parameter.first, parameter.second);
+		}
 
-	bool trace = false;
+		Ptr<run_values> values = CreateObject<run_values>();
+		values->values.push_back(pair<string, double>("start_ns", r.start.GetNanoSeconds()));
+		values->values.push_back(pair<string, double>("proposal_ns", (r.proposal - r.start).GetNanoSeconds()));
+		values->values.push_back(pair<string, double>("done_ns", (r.done - r.start).GetNanoSeconds()));
+		values->values.push_back(pair<string, double>("events", r.events));
+		values->values.push_back(pair<string, double>("wall_s", r.wall_seconds));
+		collector.AddDataCalculator(values);
+		output->Output(collector);
+	}
+	output->EndBatch();
+}
+#else
+void write_results()
+{
+}
+#endif
+
+void run_experiment()
+{
 	if(trace)
 	{
 		AsciiTraceHelper ascii;
@@ -245,6 +605,14 @@ void run_experiment()
 		Ptr<OutputStreamWrapper> routingStream = Create<OutputStreamWrapper> (experiment + ".routes", std::ios::out);
 		g.PrintRoutingTableAllAt(Seconds(10), routingStream);
 	}
+	if(pcap)
+	{
+		if(snaplen > 0)
+		{
+			Config::SetDefault("ns3::PcapFileWrapper::CaptureSize", UintegerValue(snaplen));
+		}
+		point_to_point.EnablePcapAll(experiment);
+	}
 
 	setup_experiment();
 
@@ -262,8 +630,24 @@ void run_experiment()
 	}
 	
 	current_run = 0;
+	double setup_seconds = setup_clock.End() / 1000.0;
+	uint64_t setup_events = Simulator::GetEventCount();
+	SystemWallClockMs wall_clock;
+	wall_clock.Start();
+	if(memory_report > 0)
+	{
+		Time delay = Max(Seconds(memory_report) - Simulator::Now(), Time(0));
+		MemoryAccounting::PrintAt(delay, Create<OutputStreamWrapper>(&std::cout));
+	}
 	Simulator::ScheduleNow(&send, start_node);
 	Simulator::Run();
+	double wall_seconds = wall_clock.End() / 1000.0;
+	write_results();
+
+	if(print_counters)
+	{
+		report_counters(setup_seconds, setup_events, wall_seconds);
+	}
 		
 	if(monitor_flow)
 	{
@@ -299,6 +683,7 @@ Ptr<Socket> get_socket(Ptr<Node> node)
 {
 	Ptr<Socket> socket = Socket::CreateSocket(node, TypeId::LookupByName("ns3::TcpSocketFactory"));
 	socket->SetAttribute ("SegmentSize", UintegerValue (TCP_PAYLOAD));
+	socket->SetAttribute ("SegmentOffload", UintegerValue (segment_offload));
 	return socket;
 }
 
@@ -312,6 +697,22 @@ void socket_accept(Ptr<Socket> socket, const Address &address)
 	sockets[node][peer] = socket;
 }
 
+void connect_socket(int node, int peer)
+{
+	sockets[node][peer] = get_socket(nodes.Get(node));
+	if(!skip_handshake)
+	{
+		sockets[node][peer]->Connect(InetSocketAddress(node_ips[peer], 80));
+		return;
+	}
+
+	//the peer socket stands for the one its listening socket would have accepted
+	sockets[peer][node] = get_socket(nodes.Get(peer));
+	int connected = DynamicCast<TcpSocketBase>(sockets[node][peer])->ConnectEstablished(
+		DynamicCast<TcpSocketBase>(sockets[peer][node]), InetSocketAddress(node_ips[peer], 80));
+	NS_ABORT_MSG_IF(connected != 0, "cannot connect node " << node << " to node " << peer);
+}
+
 void connect_sockets(NodeContainer nodes)
 {
 	NS_LOG_INFO("creating listening sockets for nodes");
@@ -326,19 +727,17 @@ void connect_sockets(NodeContainer nodes)
 	NS_LOG_INFO("connect each socket to its peers");
 	for (int n = 0; n < N; n++)
 	{
-		for(unsigned int i = 0; i < messages[n].size(); i++)
+		for(int i = schedule_offsets[n]; i < schedule_offsets[n + 1]; i++)
 		{
-			int send_to =  messages[n][i].send_to;
-			int recv_from = messages[n][i].recv_from;
+			int send_to =  schedule_messages[i].send_to;
+			int recv_from = schedule_messages[i].recv_from;
 			if(send_to != -1 && send_to > n &&(sockets[n].find(send_to) == sockets[n].end()))
 			{
-				sockets[n][send_to] = get_socket(nodes.Get(n));
-				sockets[n][send_to]->Connect(InetSocketAddress(node_ips[send_to], 80));
+				connect_socket(n, send_to);
 			}
 			if(recv_from != -1 && recv_from > n &&(sockets[n].find(recv_from) == sockets[n].end()))
 			{
-				sockets[n][recv_from] = get_socket(nodes.Get(n));
-				sockets[n][recv_from]->Connect(InetSocketAddress(node_ips[recv_from], 80));
+				connect_socket(n, recv_from);
 			}
 		}
 	}
@@ -348,17 +747,23 @@ void set_callbacks()
 {
 	NS_LOG_INFO("setting regular callback functions for sockets ");
 
+	recv_links.clear();
 	for(int node = 0; node < N; node++)
 	{
 		for(pair<int, Ptr<Socket>> socket : sockets[node])
 		{
 			socket.second->SetSendCallback(MakeCallback(&write));
-			socket.second->SetRecvCallback(MakeCallback(&recv));
+			if(socket.first != node)
+			{
+				socket.second->SetRecvCallback(MakeBoundCallback(&recv, (int) recv_links.size()));
+				recv_links.push_back(pair<int, int>(node, socket.first));
+			}
 			sent_data[socket.second];
 			rcvd_data[socket.second];
 			to_send[socket.second];
 		}
 	}
+	reset_recv_slots();
 }
 
 /*
@@ -416,26 +821,27 @@ void send(int node)
 {
 	int current = current_msg[node];
 	
-	if(current == (int) messages[node].size())
+	if(current == schedule_offsets[node + 1])
 	{
 		return;
 	}
 
-	if(node == start_node && current == 0)
+	if(node == start_node && current == schedule_offsets[node])
 	{
 		NS_LOG_INFO("RUN: " << current_run);
-		if(results_dir.compare("") != 0)
-		{
-			results << Simulator::Now() << ",";		
-		}
+		run_results.push_back(run_result{Simulator::Now(), Time(0), Time(0), 0, 0});
+		run_start_events = Simulator::GetEventCount();
+		run_clock.Start();
 		log_experiment = (current_run == no_runs - 1);
+		last_run_start = Simulator::Now();
 		if(log_experiment)
 		{
 			NS_LOG_INFO("START OF EXPERIMENT");
 		}
 	}
 
-	int peer = messages[node][current].send_to;
+	const message &m = schedule_messages[current];
+	int peer = m.send_to;
 	if(peer == -1)
 	{
 		return;
@@ -443,16 +849,17 @@ void send(int node)
 
 	rcvd_data[sockets[peer][node]].push_back(0);
 	sent_data[sockets[node][peer]].push_back(0);
-	to_send[sockets[node][peer]].push_back(messages[node][current].size);
+	to_send[sockets[node][peer]].push_back(m.size);
 
 	write(sockets[node][peer],sockets[node][peer]->GetTxAvailable());
+	messages_sent++;
 		
 	if(log_experiment)
 	{
 		NS_LOG_INFO("node " << node << " sent " << sent_data[sockets[node][peer]].back() << " bytes to node " << peer << "@" << node_ips[peer]);
 	}
 
-	if(messages[node][current_msg[node]].recv_from == -1)
+	if(schedule_messages[current_msg[node]].recv_from == -1)
 	{
 		current_msg[node]++;
 		send(node);
@@ -461,28 +868,26 @@ void send(int node)
 
 void handle_message(int node, int peer)
 {
-	if(current_msg[node] == 0)
+	if(current_msg[node] == schedule_offsets[node])
 	{
 		no_rcvd_proposal++;
 		if(no_rcvd_proposal == N)
 		{
+			last_run_proposal = Simulator::Now();
 			if(log_experiment)
 			{
 				NS_LOG_INFO("LOG TIMESTAMP: all nodes received proposal");
 			}
-			if(results_dir.compare("") != 0)
-			{
-				results << Simulator::Now() << ",";	
-			}
+			run_results.back().proposal = Simulator::Now();
 		}
 	}
 
 	current_msg[node]++;
 	send(node);
 	
-	if(current_msg[node] == (int) messages[node].size())
+	if(current_msg[node] == schedule_offsets[node + 1])
 	{
-		assert(node_buffers[node].size() == 0);
+		assert(no_buffered[node] == 0);
 		if(log_experiment)
 		{
 			NS_LOG_INFO("DONE: " << node);
@@ -490,22 +895,18 @@ void handle_message(int node, int peer)
 		no_rcvd_hash++;
 		if(no_rcvd_hash == N)
 		{
+			last_run_done = Simulator::Now();
 			if(log_experiment)
 			{
 				NS_LOG_INFO("LOG TIMESTAMP: all nodes are done");
 			}
 
-			if(results_dir.compare("") != 0)
-			{
-				results << Simulator::Now() << ",";		
-			}
+			run_results.back().done = Simulator::Now();
+			run_results.back().events = Simulator::GetEventCount() - run_start_events;
+			run_results.back().wall_seconds = run_clock.End() / 1000.0;
 			current_run++;
 			if(current_run < no_runs)
 			{
-				if(results_dir.compare("") != 0)
-				{
-					results << endl;
-				}
 				reset_experiment();
 				send(start_node);
 			}
@@ -520,44 +921,30 @@ void handle_message(int node, int peer)
 
 void check_buffer(int node)
 {
-	bool changed;
 	vector<int> unbuffered;
-	do
+	while(current_msg[node] != schedule_offsets[node + 1] && arrived[current_msg[node]])
 	{
-		changed = false;
-		int peer = messages[node][current_msg[node]].recv_from;
-		vector<int>::iterator it = node_buffers[node].begin();
-		while(it != node_buffers[node].end())
-		{
-			if (*it == peer)
-			{
-				it = node_buffers[node].erase(it);
-				unbuffered.push_back(peer);
-				handle_message(node, peer);
-				changed = true;
-				break;
-			}
-			else
-			{
-				++it;
-			}
-		}
+		arrived[current_msg[node]] = false;
+		no_buffered[node]--;
+		int peer = schedule_messages[current_msg[node]].recv_from;
+		unbuffered.push_back(peer);
+		handle_message(node, peer);
 	}
-	while(changed);
 
-	if(!unbuffered.empty())
+#ifdef NS3_LOG_ENABLE
+	if(log_experiment && !unbuffered.empty())
 	{
 		string s = "";
 		for(int i : unbuffered)
 		{
 			s += std::to_string(i) + ",";
 		}
-		if(log_experiment)
-			NS_LOG_INFO("node " << node << " unbuffered message from " << s);
+		NS_LOG_INFO("node " << node << " unbuffered message from " << s);
 	}
+#endif
 }
 
-void recv(Ptr<Socket> socket)
+void recv(int link, Ptr<Socket> socket)
 {
 	Address node_address;
 	socket->GetSockName(node_address);
@@ -573,6 +960,7 @@ void recv(Ptr<Socket> socket)
 	int msg_index = get_message_index(sockets[peer][node], socket, false);
 
 	rcvd_data[socket][msg_index] += packet->GetSize();
+	bytes_received += packet->GetSize();
 
 	int msg_size = to_send[sockets[peer][node]][msg_index];
 
@@ -591,10 +979,15 @@ void recv(Ptr<Socket> socket)
 	{
 		total_size -= msg_size;
 
-		assert(messages[node][current_msg[node]].recv_from != -1);
-		if(messages[node][current_msg[node]].recv_from != peer)
+		assert(schedule_messages[current_msg[node]].recv_from != -1);
+		assert(recv_links[link].first == node && recv_links[link].second == peer && recv_slot[link] != -1);
+		int msg_slot = recv_slot[link];
+		recv_slot[link] = next_recv_slot[msg_slot];
+		if(msg_slot != current_msg[node])
 		{
-			node_buffers[node].push_back(peer);
+			arrived[msg_slot] = true;
+			no_buffered[node]++;
+			messages_buffered++;
 			if(log_experiment)
 			{
 				NS_LOG_INFO("node " << node << " buffered " << msg_size << " bytes from node " << peer << "@" << address.GetIpv4());
@@ -621,6 +1014,15 @@ void recv(Ptr<Socket> socket)
 * topology generation functions
 */
 
+void remove_queue_discs(NetDeviceContainer devices)
+{
+	if(direct_links)
+	{
+		TrafficControlHelper tch;
+		tch.Uninstall(devices);
+	}
+}
+
 void generate_brite_topology(bool group)
 {
 	Ipv4NixVectorHelper nixRouting;
@@ -632,12 +1034,12 @@ void generate_brite_topology(bool group)
 
 	ipv4.SetBase ("10.1.1.0", "255.255.255.0");
 
-	std::string filename = "../BRITE/conf_files/TDBW" + std::to_string(no_AS) + ".conf";
+	std::string filename = brite_conf_dir + "/TDBW" + std::to_string(no_AS) + ".conf";
 	cout << "filename: " << filename << endl;
 
 	BriteTopologyHelper bth(filename);
 	cout << "imported file..." << endl;
-	bth.AssignStreams(3);
+	bth.AssignStreams(BRITE_STREAM);
 	bth.BuildBriteTopology(internet);
 	bth.AssignIpv4Addresses(ipv4);
 
@@ -659,7 +1061,7 @@ void generate_brite_topology(bool group)
 	}
 	if(!group)
 	{
-		std::random_shuffle(node_id_set.begin(), node_id_set.end());
+		shuffle_node_ids(node_id_set);
 	}
 
 	point_to_point.SetDeviceAttribute("DataRate", StringValue("10Gbps"));
@@ -676,6 +1078,7 @@ void generate_brite_topology(bool group)
 			ipv4.Assign(devices.Get(0));
 			node_ips[node_id] = ipv4.Assign(devices.Get(1)).GetAddress(0);
 			node_ids[node_ips[node_id]] = node_id;
+			remove_queue_discs(devices);
 			if(first_member || (node_id == start_node))
 			{
 				AS_leads[a] = node_id;
@@ -720,7 +1123,7 @@ void generate_AS_star_topology(bool group)
 	}
 	if(!group)
 	{
-		std::random_shuffle(node_id_set.begin(), node_id_set.end());
+		shuffle_node_ids(node_id_set);
 	}
 
 	for(int a = 0; a < no_AS; a++)
@@ -734,6 +1137,7 @@ void generate_AS_star_topology(bool group)
 			ipv4.Assign(devices.Get(0));
 			node_ips[node_id] = ipv4.Assign(devices.Get(1)).GetAddress(0);
 			node_ids[node_ips[node_id]] = node_id;
+			remove_queue_discs(devices);
 			if(first_member || (node_id == start_node))
 			{
 				AS_leads[a] = node_id;
@@ -757,6 +1161,7 @@ void generate_AS_star_topology(bool group)
 		NetDeviceContainer devices = point_to_point.Install(routers.Get(no_AS), routers.Get(a));
 		ipv4.Assign(devices.Get(0));
 		ipv4.Assign(devices.Get(1));
+		remove_queue_discs(devices);
 		ipv4.NewNetwork();
 	}
 }
@@ -789,6 +1194,7 @@ void generate_star_topology()
 		ipv4.Assign(devices.Get(0));
 		node_ips[i] = ipv4.Assign(devices.Get(1)).GetAddress(0);
 		node_ids[node_ips[i]] = i;
+		remove_queue_discs(devices);
 		if(verbose)
 			cout << "node " << i << ", id: " << nodes.Get(i)->GetId() << " assigned " << node_ips[i] << endl;
 		ipv4.NewNetwork();
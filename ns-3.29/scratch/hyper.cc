@@ -1,6 +1,9 @@
 #include "communication_model.h"
 #include <tuple>
 #include <set>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 using std::tuple;
 using std::make_tuple;
@@ -13,9 +16,11 @@ int D; //log_B N
 int C; //compaction factor
 bool group;
 
-map<int, set<int>> *peers_send;
-map<int, set<int>> *peers_recv;
-map<int, map<int, set<int>>> *peers_dest;
+bool verify_schedule;
+
+vector<vector<int>> *peers_send;
+vector<vector<int>> *peers_recv;
+vector<int> *dests_from;
 
 void compact_broadcast_messages(vector<message> *messages)
 {
@@ -57,22 +62,77 @@ void set_broadcast_messages(vector<message> *messages, int node, int phase_of_no
 	}
 }
 
+//checks that the message of every node reaches every other node once and only once, one bitset of N bits per thread
+void verify_coverage()
+{
+	unsigned int no_threads = std::max(1u, std::thread::hardware_concurrency());
+	std::atomic<int> next_node(0);
+	std::atomic<int> failed_node(-1);
+	vector<std::thread> threads;
+	for(unsigned int t = 0; t < no_threads; t++)
+	{
+		threads.emplace_back([&]()
+		{
+			vector<uint64_t> reached((N + 63) / 64);
+			vector<pair<int, int>> stack;
+			for(int node = next_node++; node < N && failed_node < 0; node = next_node++)
+			{
+				std::fill(reached.begin(), reached.end(), 0);
+				reached[node / 64] |= 1ULL << (node % 64);
+				int counter = 0;
+				stack.push_back(make_pair(node, 0));
+				while(!stack.empty())
+				{
+					pair<int, int> peer_and_phase = stack.back();
+					stack.pop_back();
+					for(int d = peer_and_phase.second; d < D; d++)
+					{
+						for(int peer : peers_send[peer_and_phase.first][d])
+						{
+							if(reached[peer / 64] & (1ULL << (peer % 64)))
+							{
+								failed_node = node;
+							}
+							reached[peer / 64] |= 1ULL << (peer % 64);
+							counter++;
+							stack.push_back(make_pair(peer, d + 1));
+						}
+					}
+				}
+				if(counter != N - 1)
+				{
+					failed_node = node;
+				}
+			}
+		});
+	}
+	for(std::thread &thread : threads)
+	{
+		thread.join();
+	}
+	if(failed_node >= 0)
+	{
+		NS_FATAL_ERROR("the message of node " << failed_node << " does not reach every other node exactly once");
+	}
+}
+
 void set_messages(vector<message> *messages)
 {
 	//broadcast stage
 	set_broadcast_messages(messages, start_node, 0);
 
 	//hypercube stage
-	peers_send = new map<int, set<int>>[N]();
+	peers_send = new vector<vector<int>>[N]();
 
 	for(int node = 0; node < N; node++)
 	{
+		peers_send[node].resize(D);
 		for(int d = 0; d < D; d++)
 		{
 			int peer = node ^ (1 << d);
 			if(peer < N)
 			{
-				peers_send[node][d].emplace(peer);
+				peers_send[node][d].push_back(peer);
 			}
 			else if(node >= (1 << (D - 1))) //peer does not exist
 			{
@@ -89,7 +149,7 @@ void set_messages(vector<message> *messages)
                 while(future_phase < D && future_peer >= N);
 
                 assert(future_phase < D && future_peer < N);
-				peers_send[node][d].emplace(future_peer);
+				peers_send[node][d].push_back(future_peer);
 			}			
 		}
 	}
@@ -100,21 +160,26 @@ void set_messages(vector<message> *messages)
 		compact_broadcast_messages(messages);
 
 		//hypercube compaction
-		map<int, set<int>> *compacted_peers_send = new map<int, set<int>>[N]();
+		vector<vector<int>> *compacted_peers_send = new vector<vector<int>>[N]();
 		int compacted_D = ceil(D*1.0/C);
 
 		for(int node = 0; node < N; node++)
 		{
+			compacted_peers_send[node].resize(compacted_D);
 			int phase = 0;
 			for(int cD = 0; cD < compacted_D; cD++)
 			{
+				vector<int> &compacted_peers = compacted_peers_send[node][cD];
 				vector<pair<int, int>> stack;
 				stack.push_back(make_pair(node, phase));
 				while(!stack.empty())
 				{
 					pair<int,int> peer_and_phase = stack.back();
 					stack.pop_back();
-					compacted_peers_send[node][cD].emplace(peer_and_phase.first);
+					if(peer_and_phase.first != node)
+					{
+						compacted_peers.push_back(peer_and_phase.first);
+					}
 					for(int d = peer_and_phase.second; d < min(phase + C, D); d++)
 					{
 						for(int peer : peers_send[peer_and_phase.first][d])
@@ -124,20 +189,12 @@ void set_messages(vector<message> *messages)
 					}
 				}
 				
-				compacted_peers_send[node][cD].erase(node);				
+				std::sort(compacted_peers.begin(), compacted_peers.end());
+				compacted_peers.erase(std::unique(compacted_peers.begin(), compacted_peers.end()), compacted_peers.end());
 				phase += C;			
 			}				
 		}
 
-		//free memory
-		for(int node = 0; node < N; node++)
-		{
-			for(int d = 0; d < D; d++)
-			{
-				peers_send[node][d].clear();
-			}	
-			peers_send[node].clear();
-		}
 		delete[] peers_send;
 		peers_send = compacted_peers_send;	
 
@@ -145,133 +202,84 @@ void set_messages(vector<message> *messages)
 		cout << "D: " << D << endl;
 	}
 	
-	//each message sent by each node goes to which nodes, necessary to calculate message sizes in uneven cubes, compacted phases etc.
-	peers_dest = new map<int, map<int, set<int>>>[N]();
+	//number of final destinations of the messages a node sends from a phase on, its own and the ones it relays
+	//the message to a peer in phase d goes to the peer and to the destinations of the peer from phase d+1 on
+	dests_from = new vector<int>[N]();
+	for(int node = 0; node < N; node++)
+	{
+		dests_from[node].assign(D + 1, 0);
+	}
 	for(int d = D-1; d >= 0; d--)
 	{
 		for(int node = 0; node < N; node++)
 		{
+			dests_from[node][d] = dests_from[node][d + 1];
 			for(int peer : peers_send[node][d])
 			{
-				peers_dest[node][d][peer].emplace(peer);
-				for(int d2 = D-1; d2 > d; d2--)
-				{
-					for(pair<int, set<int>> set : peers_dest[peer][d2])
-					{
-						peers_dest[node][d][peer].insert(set.second.begin(), set.second.end());
-					}
-				}
+				dests_from[node][d] += 1 + dests_from[peer][d + 1];
 			}
 		}
 	}
 
-	//check if each nodes message reaches every other node once and only once
+	//the counts add up to N-1 only if no node is reached twice, verify_schedule checks that every node is reached
 	for(int node = 0; node < N; node++)
 	{
-		//cout << "node: " << node << endl;
-		set<int> test;
-		unsigned int counter = 0;
-		for(int d = 0; d < D; d++)
-		{
-			//cout << "\td: " << d << endl;
-			for(pair<int, set<int>> set : peers_dest[node][d])
-			{
-				//cout << "\t\t" << set.first << ": ";
-				for(int i : set.second)
-				{
-					//cout << i << ",";
-					test.insert(i);
-					counter++;
-				}
-				//cout << endl;
-			}
-		}
-		assert(counter == test.size() && test.size() == (unsigned int) (N-1));
+		assert(dests_from[node][0] == N-1);
+	}
+	if(verify_schedule)
+	{
+		verify_coverage();
 	}
 
 	//peers receive messages from which nodes
-	peers_recv = new map<int, set<int>>[N]();
+	peers_recv = new vector<vector<int>>[N]();
+	for(int node = 0; node < N; node++)
+	{
+		peers_recv[node].resize(D);
+	}
 	for(int node = 0; node < N; node++)
 	{
 		for(int d = 0; d < D; d++)
 		{
 			for(int peer : peers_send[node][d])
 			{
-				peers_recv[peer][d].emplace(node);
+				peers_recv[peer][d].push_back(node);
 			}
 		}
 	}
 
-	//populate the message table
+	//populate the message table and set message sizes
 	for(int node = 0; node < N; node++)
 	{
 		for(int d = 0; d < D; d++)
 		{
 			for(int peer : peers_send[node][d]) //send
 			{
-				messages[node].push_back(message{peer, -1, -1, d, 0, false});
+				int size = full_msg_sizes ? HMAC_SIZE*N : HMAC_SIZE*(1 + dests_from[peer][d + 1]);
+				messages[node].push_back(message{peer, -1, size, d, 0, false});
 			}
 			for(int peer : peers_recv[node][d]) //recv
 			{
-				messages[node].push_back(message{-1, peer, -1, d, 0, false});
-			}
-		}
-	}
-
-	//set message sizes
-	for(int node = 0; node < N; node++)
-	{
-		for(unsigned int msg = 0; msg < messages[node].size(); msg++)
-		{
-			if(messages[node][msg].broadcast)
-			{
-				continue;
-			}
-			if(messages[node][msg].send_to != -1)
-			{
-				if(full_msg_sizes)
-				{
-					messages[node][msg].size = HMAC_SIZE*N;
-				}
-				else
-				{
-					messages[node][msg].size = HMAC_SIZE*(peers_dest[node][messages[node][msg].phase][messages[node][msg].send_to].size());
-				}
-			}
-			else if(messages[node][msg].recv_from != -1)
-			{
-				if(full_msg_sizes)
-				{
-					messages[node][msg].size = HMAC_SIZE*N;
-				}
-				else
-				{
-					messages[node][msg].size = HMAC_SIZE*(peers_dest[messages[node][msg].recv_from][messages[node][msg].phase][node].size());
-				}
+				int size = full_msg_sizes ? HMAC_SIZE*N : HMAC_SIZE*(1 + dests_from[node][d + 1]);
+				messages[node].push_back(message{-1, peer, size, d, 0, false});
 			}
 		}
 	}
 
 	//free memory
-	for(int node = 0; node < N; node++)
-	{
-		for(int d = 0; d < D; d++)
-		{
-			peers_send[node][d].clear();
-			peers_recv[node][d].clear();
-			for(pair<int, set<int>> p : peers_dest[node][d])
-			{
-				p.second.clear();
-			}
-			peers_dest[node][d].clear();
-		}
-		peers_send[node].clear();
-		peers_recv[node].clear();
-		peers_dest[node].clear();
-	}
 	delete[] peers_send;
 	delete[] peers_recv;
-	delete[] peers_dest;
+	delete[] dests_from;
+}
+
+string schedule_key()
+{
+	string key = "hyper_N" + std::to_string(N) + "_C" + std::to_string(C);
+	if(full_msg_sizes)
+	{
+		key += "_full";
+	}
+	return key;
 }
 
 void set_experiment_name()
@@ -290,7 +298,7 @@ void set_experiment_name()
 	}
 	else
 	{
-		assert(false);
+		NS_FATAL_ERROR("unknown topology " << topology);
 	}
 
 	if(C > 1)
@@ -313,23 +321,30 @@ void run(int argc, char *argv[])
 	initialize_variables();
 	group = false;
 	C = 1;
+	verify_schedule = false;
 
 	CommandLine cmd;
 	cmd.AddValue("C", "compaction factor", C);
 	cmd.AddValue("group", "group", group);
+	cmd.AddValue("verify_schedule", "check that every message reaches every node exactly once, O(N^2) on all cores", verify_schedule);
 	parse_default_arguments(cmd, argc, argv);
 
 	set_experiment_name();
+	parameters["C"] = C;
+	parameters["group"] = group;
 	D = ceil(log2(N));
 	cout << "N: " << N << " D: " << D <<  " C: " << C << " group: " << group << endl;
-	assert(C <= D);
+	if(C > D)
+	{
+		NS_FATAL_ERROR("compaction factor C=" << C << " is larger than the dimension D=" << D);
+	}
 
 	start_node = 0;
 	generate_topology(group);
-	set_messages(messages);
+	make_schedule(schedule_key(), &set_messages);
 	if(verbose)
 	{
-		print_messages(messages);
+		print_messages();
 	}
 
 	run_experiment();
@@ -134,6 +134,33 @@ void set_messages(vector<message> *messages)
 	}
 }
 
+string schedule_key()
+{
+	string key = "tree_N" + std::to_string(N) + "_B" + std::to_string(B);
+	if(bcast_tree)
+	{
+		//the broadcast tree follows the AS leads and members, which depend on the topology and the seed
+		uint64_t hash = 14695981039346656037ULL; //FNV-1a
+		for(int as = 0; as < no_AS; as++)
+		{
+			vector<int> ids(1, AS_leads[as]);
+			ids.insert(ids.end(), AS_members[as].begin(), AS_members[as].end());
+			for(int id : ids)
+			{
+				hash = (hash ^ (uint32_t) id) * 1099511628211ULL;
+			}
+		}
+		std::ostringstream oss;
+		oss << std::hex << hash;
+		key = "bcast_" + key + "_AS" + std::to_string(no_AS) + "_" + oss.str();
+	}
+	if(full_msg_sizes)
+	{
+		key += "_full";
+	}
+	return key;
+}
+
 void set_experiment_name()
 {
 	experiment = "";
@@ -157,7 +184,7 @@ void set_experiment_name()
 	}
 	else
 	{
-		assert(false);
+		NS_FATAL_ERROR("unknown topology " << topology);
 	}
 
 	if(B != 2)
@@ -189,6 +216,9 @@ void run(int argc, char *argv[])
 	parse_default_arguments(cmd, argc, argv);
 
 	set_experiment_name();
+	parameters["B"] = B;
+	parameters["group"] = group;
+	parameters["bcast"] = bcast_tree;
 	D = ceil(log(N)/log(B));
 	cout << "N: " << N << " B: " << B << " D: " << D << " group: " << group << endl;
 
@@ -196,16 +226,16 @@ void run(int argc, char *argv[])
 	generate_topology(group);
 	if(bcast_tree)
 	{
-		set_bcast_tree_messages(messages);;
+		make_schedule(schedule_key(), &set_bcast_tree_messages);
 	}
 	else
 	{
-		set_messages(messages);
+		make_schedule(schedule_key(), &set_messages);
 	}
 	
 	if(verbose)
 	{
-		print_messages(messages);
+		print_messages();
 	}
 
 	run_experiment();
@@ -42,7 +42,6 @@ NS_LOG_COMPONENT_DEFINE ("BriteMPITest");
 int
 main (int argc, char *argv[])
 {
-#ifdef NS3_MPI
   // Distributed simulation setup
   MpiInterface::Enable (&argc, &argv);
   GlobalValue::Bind ("SimulatorImplementationType",
@@ -199,8 +198,4 @@ main (int argc, char *argv[])
   MpiInterface::Disable ();
 
   return 0;
-
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
 }
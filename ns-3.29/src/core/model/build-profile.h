@@ -24,7 +24,8 @@
 /**
  * \file
  * \ingroup debugging
- * NS_BUILD_DEBUG, NS_BUILD_RELEASE, and NS_BUILD_OPTIMIZED
+ * NS_BUILD_DEBUG, NS_BUILD_RELEASE, NS_BUILD_OPTIMIZED,
+ * and NS_BUILD_PRODUCTION
  * macro definitions.
  */
 
@@ -87,6 +88,17 @@
 #define NS_BUILD_OPTIMIZED(code) NS_BUILD_PROFILE_NOOP (code)
 #endif
 
+#ifdef NS3_BUILD_PROFILE_PRODUCTION
+/**
+ * \ingroup debugging
+ * Execute a code snippet in production builds.
+ * \param [in] code The code to execute.
+ */
+#define NS_BUILD_PRODUCTION(code) NS_BUILD_PROFILE_OP (code)
+#else
+#define NS_BUILD_PRODUCTION(code) NS_BUILD_PROFILE_NOOP (code)
+#endif
+
 
 
 
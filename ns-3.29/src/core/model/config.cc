@@ -25,7 +25,11 @@
 #include "names.h"
 #include "pointer.h"
 #include "log.h"
+#include "simple-ref-count.h"
+#include "trace-source-accessor.h"
 
+#include <algorithm>
+#include <map>
 #include <sstream>
 
 /**
@@ -150,6 +154,9 @@ MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &
 /**
  * \ingroup config-impl
  * Helper to test if an array entry matches a config path specification.
+ *
+ * The specification is parsed once, into a sorted list of disjoint
+ * index ranges.
  */
 class ArrayMatcher
 {
@@ -167,7 +174,27 @@ public:
    * \returns \c true if the index matches the Config Path.
    */
   bool Matches (std::size_t i) const;
+  /**
+   * \returns \c true if the specification is \c *, which matches any index.
+   */
+  bool MatchesAll (void) const;
+  /**
+   * \returns The number of indices which match, when not MatchesAll().
+   */
+  uint64_t GetCount (void) const;
+
+  /** A range of matching indices, bounds included. */
+  typedef std::pair<uint32_t, uint32_t> Range;
+  /** The sorted, disjoint ranges of matching indices. */
+  std::vector<Range> m_ranges;
+
 private:
+  /**
+   * Add the indices matched by a Config path specification.
+   *
+   * \param [in] element The Config path specification.
+   */
+  void Parse (std::string element);
   /**
    * Convert a string to an \c uint32_t.
    *
@@ -176,80 +203,108 @@ private:
    * \returns \c true if the string could be converted.
    */
   bool StringToUint32 (std::string str, uint32_t *value) const;
-  /** The Config path element. */
-  std::string m_element;
+  /** Whether the Config path element is \c *. */
+  bool m_all;
 
 };  // class ArrayMatcher
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_all (false)
 {
   NS_LOG_FUNCTION (this << element);
+  Parse (element);
+  std::sort (m_ranges.begin (), m_ranges.end ());
+  std::vector<Range> merged;
+  for (std::vector<Range>::const_iterator i = m_ranges.begin (); i != m_ranges.end (); ++i)
+    {
+      if (!merged.empty () && i->first <= (uint64_t)merged.back ().second + 1)
+        {
+          merged.back ().second = std::max (merged.back ().second, i->second);
+        }
+      else
+        {
+          merged.push_back (*i);
+        }
+    }
+  m_ranges.swap (merged);
 }
-bool
-ArrayMatcher::Matches (std::size_t i) const
+void
+ArrayMatcher::Parse (std::string element)
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      m_all = true;
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      Parse (element.substr (0, tmp-0));
+      Parse (element.substr (tmp+1, element.size () - (tmp + 1)));
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
-      if (StringToUint32 (lowerBound, &min) && 
+      if (StringToUint32 (lowerBound, &min) &&
           StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
+          min <= max)
         {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
-        }
-      else
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          m_ranges.push_back (Range (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (StringToUint32 (element, &value))
+    {
+      m_ranges.push_back (Range (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (std::size_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_all)
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+      NS_LOG_DEBUG ("Array "<<i<<" matches *");
       return true;
     }
-  NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
+  for (std::vector<Range>::const_iterator r = m_ranges.begin (); r != m_ranges.end (); ++r)
+    {
+      if (i >= r->first && i <= r->second)
+        {
+          NS_LOG_DEBUG ("Array "<<i<<" matches ["<<r->first<<"-"<<r->second<<"]");
+          return true;
+        }
+    }
+  NS_LOG_DEBUG ("Array "<<i<<" does not match");
   return false;
 }
+bool
+ArrayMatcher::MatchesAll (void) const
+{
+  return m_all;
+}
+uint64_t
+ArrayMatcher::GetCount (void) const
+{
+  uint64_t count = 0;
+  for (std::vector<Range>::const_iterator r = m_ranges.begin (); r != m_ranges.end (); ++r)
+    {
+      count += (uint64_t)r->second - r->first + 1;
+    }
+  return count;
+}
 
 bool
 ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
@@ -263,47 +318,113 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
 
 /**
  * \ingroup config-impl
- * Abstract class to parse Config paths into object references.
+ * A Config path split into its segments, and the resolver walking it.
+ *
+ * Every segment is parsed when the path is constructed.  The attributes
+ * a segment names are looked up once per TypeId of the objects met at
+ * that depth, and so is the trace source named by the leaf.
  */
-class Resolver
+class CompiledPathImpl : public SimpleRefCount<CompiledPathImpl>
 {
 public:
   /**
-   * Construct from a base Config path.
+   * Construct from a Config path.
    *
    * \param [in] path The Config path.
    */
-  Resolver (std::string path);
-  /** Destructor. */
-  virtual ~Resolver ();
+  CompiledPathImpl (std::string path);
+
+  /** \returns The Config path. */
+  std::string GetPath (void) const;
+  /** \returns The last token of the path, after the final slash. */
+  std::string GetLeaf (void) const;
 
   /**
-   * Parse the stored Config path into an object reference,
-   * beginning at the indicated root object.
+   * Find the objects matching the path, from all the root namespace
+   * objects and then from the "/Names" namespace.
    *
-   * \param [in] root The object corresponding to the current position in
-   *                  in the Config path.
+   * \param [in] leaf Whether to stop before the leaf token, which then
+   *                  names an attribute or a trace source.
+   * \param [out] objects The matching objects.
+   * \param [out] contexts The matched paths, or 0 if not needed.
    */
-  void Resolve (Ptr<Object> root);
-  
+  void Resolve (bool leaf, std::vector<Ptr<Object> > *objects,
+                std::vector<std::string> *contexts);
+  /**
+   * Get the trace source named by the leaf token.
+   *
+   * \param [in] object The object holding the trace source.
+   * \returns The trace source accessor, or 0 if the object has none
+   *          with that name.
+   */
+  Ptr<const TraceSourceAccessor> LookupTraceSource (Ptr<Object> object);
+
 private:
-  /** Ensure the Config path starts and ends with a '/'. */
-  void Canonicalize (void);
+  /** An attribute referred to by a path segment. */
+  struct AttributeMatch
+  {
+    std::string name;                       //!< The attribute name.
+    Ptr<const AttributeAccessor> accessor;  //!< The accessor, 0 if not gettable.
+    bool pointer;                           //!< Pointer, or else object container.
+  };
+  /** The attributes a segment refers to, for one TypeId. */
+  typedef std::vector<struct AttributeMatch> AttributeMatches;
+
+  /** A parsed path token. */
+  struct Segment
+  {
+    /**
+     * Parse a path token.
+     * \param [in] token The path token.
+     */
+    Segment (std::string token);
+    std::string item;      //!< The path token.
+    bool names;            //!< Whether the token begins with "Names".
+    bool getObject;        //!< Whether the token is a $TypeId.
+    bool found;            //!< Whether the $TypeId exists.
+    TypeId tid;            //!< The $TypeId.
+    ArrayMatcher matcher;  //!< The token as an array specification.
+    /** The attributes the token refers to, by TypeId uid. */
+    std::map<uint16_t, AttributeMatches> attributes;
+  };
+
+  /**
+   * Ensure a Config path starts and ends with a '/'.
+   *
+   * \param [in] path The Config path.
+   * \returns The canonical path.
+   */
+  static std::string Canonicalize (std::string path);
   /**
-   * Parse the next element in the Config path.
+   * Split a canonical Config path into its tokens.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] path The canonical Config path.
+   * \returns The tokens.
+   */
+  static std::vector<std::string> Split (std::string path);
+  /**
+   * Resolve the next segment of the path.
+   *
+   * \param [in] depth The index of the segment.
    * \param [in] root The object corresponding to the current position
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (std::size_t depth, Ptr<Object> root);
+  /**
+   * Resolve an index segment of the path.
+   *
+   * \param [in] depth The index of the segment.
+   * \param [in] container The objects to select from.
+   */
+  void DoArrayResolve (std::size_t depth, const ObjectPtrContainerValue &container);
   /**
-   * Parse an index on the Config path.
+   * Continue the resolution with one selected array entry.
    *
-   * \param [in] path The remaining Config path.
-   * \param [in,out] vector The resulting list of matching objects.
+   * \param [in] depth The index of the segment.
+   * \param [in] index The index of the entry.
+   * \param [in] object The entry.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolveOne (std::size_t depth, std::size_t index, Ptr<Object> object);
   /**
    * Handle one object found on the path.
    *
@@ -311,66 +432,186 @@ private:
    */
   void DoResolveOne (Ptr<Object> object);
   /**
-   * Get the current Config path.
+   * Get the attributes a segment refers to on an object.
    *
-   * \returns The current Config path.
+   * \param [in] segment The path segment.
+   * \param [in] object The object.
+   * \returns The attributes, in the order of the TypeId hierarchy.
    */
-  std::string GetResolvedPath (void) const;
+  const AttributeMatches & LookupAttributes (struct Segment &segment, Ptr<Object> object) const;
   /**
-   * Handle one found object.
+   * Get the value of an attribute referred to by a segment.
    *
-   * \param [in] object The found object.
-   * \param [in] path The matching Config path context.
+   * \param [in] object The object.
+   * \param [in] match The attribute.
+   * \param [out] value The attribute value.
    */
-  virtual void DoOne (Ptr<Object> object, std::string path) = 0;
+  void GetAttribute (Ptr<Object> object, const struct AttributeMatch &match,
+                     AttributeValue &value) const;
+  /**
+   * Get the current Config path.
+   *
+   * \returns The current Config path.
+   */
+  std::string GetResolvedPath (void) const;
 
-  /** Current list of path tokens. */
-  std::vector<std::string> m_workStack;
   /** The Config path. */
   std::string m_path;
+  /** The path tokens. */
+  std::vector<struct Segment> m_segments;
+  /** Whether the path contains a slash, i.e. has a leaf. */
+  bool m_hasLeaf;
+  /** The number of tokens before the leaf. */
+  std::size_t m_leafDepth;
+  /** The leaf token. */
+  std::string m_leaf;
+  /** The trace sources named by the leaf, by TypeId uid. */
+  std::map<uint16_t, Ptr<const TraceSourceAccessor> > m_traceSources;
+
+  /** The number of tokens to resolve. */
+  std::size_t m_depth;
+  /** Current list of path tokens. */
+  std::vector<std::string> m_workStack;
+  /** The objects found. */
+  std::vector<Ptr<Object> > *m_objects;
+  /** The matching paths, or 0. */
+  std::vector<std::string> *m_contexts;
 
-};  // class Resolver
+};  // class CompiledPathImpl
 
-Resolver::Resolver (std::string path)
-  : m_path (path)
+CompiledPathImpl::Segment::Segment (std::string token)
+  : item (token),
+    names (token.substr (0, 5) == "Names"),
+    getObject (token.find ("$") == 0),
+    found (false),
+    matcher (token)
 {
-  NS_LOG_FUNCTION (this << path);
-  Canonicalize ();
+  if (getObject)
+    {
+      found = TypeId::LookupByNameFailSafe (token.substr (1, token.size () - 1), &tid);
+    }
 }
-Resolver::~Resolver ()
+
+CompiledPathImpl::CompiledPathImpl (std::string path)
+  : m_path (path),
+    m_hasLeaf (false),
+    m_leafDepth (0),
+    m_depth (0),
+    m_objects (0),
+    m_contexts (0)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << path);
+  std::vector<std::string> tokens = Split (Canonicalize (path));
+  for (std::vector<std::string>::const_iterator i = tokens.begin (); i != tokens.end (); ++i)
+    {
+      m_segments.push_back (Segment (*i));
+    }
+
+  // The leaf is whatever follows the final slash; the tokens before it
+  // are a prefix of the tokens of the whole path.
+  std::string::size_type slash = path.find_last_of ("/");
+  if (slash != std::string::npos)
+    {
+      m_hasLeaf = true;
+      m_leafDepth = Split (Canonicalize (path.substr (0, slash))).size ();
+      m_leaf = path.substr (slash+1, path.size ()-(slash+1));
+      NS_ASSERT (m_leafDepth <= m_segments.size ());
+    }
 }
-void
-Resolver::Canonicalize (void)
+
+std::string
+CompiledPathImpl::Canonicalize (std::string path)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (path);
 
   // ensure that we start and end with a '/'
-  std::string::size_type tmp = m_path.find ("/");
+  std::string::size_type tmp = path.find ("/");
   if (tmp != 0)
     {
       // no slash at start
-      m_path = "/" + m_path;
+      path = "/" + path;
     }
-  tmp = m_path.find_last_of ("/");
-  if (tmp != (m_path.size () - 1))
+  tmp = path.find_last_of ("/");
+  if (tmp != (path.size () - 1))
     {
       // no slash at end
-      m_path = m_path + "/";
+      path = path + "/";
     }
+  return path;
 }
 
-void 
-Resolver::Resolve (Ptr<Object> root)
+std::vector<std::string>
+CompiledPathImpl::Split (std::string path)
+{
+  NS_LOG_FUNCTION (path);
+  NS_ASSERT ((path.find ("/")) == 0);
+  std::vector<std::string> tokens;
+  std::string::size_type current = 0;
+  std::string::size_type next = path.find ("/", 1);
+  while (next != std::string::npos)
+    {
+      tokens.push_back (path.substr (current + 1, next - (current + 1)));
+      current = next;
+      next = path.find ("/", current + 1);
+    }
+  return tokens;
+}
+
+std::string
+CompiledPathImpl::GetPath (void) const
 {
-  NS_LOG_FUNCTION (this << root);
+  return m_path;
+}
 
-  DoResolve (m_path, root);
+std::string
+CompiledPathImpl::GetLeaf (void) const
+{
+  NS_ASSERT (m_hasLeaf);
+  return m_leaf;
+}
+
+void
+CompiledPathImpl::Resolve (bool leaf, std::vector<Ptr<Object> > *objects,
+                           std::vector<std::string> *contexts)
+{
+  NS_LOG_FUNCTION (this << leaf << objects << contexts);
+  NS_ASSERT (!leaf || m_hasLeaf);
+  m_depth = leaf ? m_leafDepth : m_segments.size ();
+  m_objects = objects;
+  m_contexts = contexts;
+  for (std::size_t i = 0; i < GetRootNamespaceObjectN (); i++)
+    {
+      DoResolve (0, GetRootNamespaceObject (i));
+    }
+
+  //
+  // See if we can do something with the object name service.  Starting with
+  // the root pointer zeroed indicates to the resolver that it should start
+  // looking at the root of the "/Names" namespace during this go.
+  //
+  DoResolve (0, 0);
+  m_objects = 0;
+  m_contexts = 0;
+}
+
+Ptr<const TraceSourceAccessor>
+CompiledPathImpl::LookupTraceSource (Ptr<Object> object)
+{
+  NS_LOG_FUNCTION (this << object);
+  TypeId tid = object->GetInstanceTypeId ();
+  std::map<uint16_t, Ptr<const TraceSourceAccessor> >::const_iterator i =
+    m_traceSources.find (tid.GetUid ());
+  if (i != m_traceSources.end ())
+    {
+      return i->second;
+    }
+  Ptr<const TraceSourceAccessor> accessor = tid.LookupTraceSourceByName (GetLeaf ());
+  m_traceSources[tid.GetUid ()] = accessor;
+  return accessor;
 }
 
 std::string
-Resolver::GetResolvedPath (void) const
+CompiledPathImpl::GetResolvedPath (void) const
 {
   NS_LOG_FUNCTION (this);
 
@@ -382,23 +623,89 @@ Resolver::GetResolvedPath (void) const
   return fullPath;
 }
 
-void 
-Resolver::DoResolveOne (Ptr<Object> object)
+void
+CompiledPathImpl::DoResolveOne (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
   NS_LOG_DEBUG ("resolved="<<GetResolvedPath ());
-  DoOne (object, GetResolvedPath ());
+  m_objects->push_back (object);
+  if (m_contexts != 0)
+    {
+      m_contexts->push_back (GetResolvedPath ());
+    }
+}
+
+const CompiledPathImpl::AttributeMatches &
+CompiledPathImpl::LookupAttributes (struct Segment &segment, Ptr<Object> object) const
+{
+  NS_LOG_FUNCTION (this << segment.item << object);
+  TypeId nextTid = object->GetInstanceTypeId ();
+  std::map<uint16_t, AttributeMatches>::const_iterator cached =
+    segment.attributes.find (nextTid.GetUid ());
+  if (cached != segment.attributes.end ())
+    {
+      return cached->second;
+    }
+
+  AttributeMatches &matches = segment.attributes[nextTid.GetUid ()];
+  TypeId tid;
+  do
+    {
+      tid = nextTid;
+
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info;
+          info = tid.GetAttribute (i);
+          if (info.name != segment.item && segment.item != "*")
+            {
+              continue;
+            }
+          struct AttributeMatch match;
+          match.name = info.name;
+          if ((info.flags & TypeId::ATTR_GET) && info.accessor->HasGetter ())
+            {
+              match.accessor = info.accessor;
+            }
+          // attempt to cast to a pointer checker.
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              match.pointer = true;
+              matches.push_back (match);
+            }
+          // attempt to cast to an object vector.
+          if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              match.pointer = false;
+              matches.push_back (match);
+            }
+          // this could be anything else and we don't know what to do with it.
+          // So, we just ignore it.
+        }
+
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return matches;
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+CompiledPathImpl::GetAttribute (Ptr<Object> object, const struct AttributeMatch &match,
+                                AttributeValue &value) const
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  if (match.accessor == 0 || !match.accessor->Get (PeekPointer (object), value))
+    {
+      // let ObjectBase report the error, or convert the value
+      object->GetAttribute (match.name, value);
+    }
+}
 
-  if (next == std::string::npos)
+void
+CompiledPathImpl::DoResolve (std::size_t depth, Ptr<Object> root)
+{
+  NS_LOG_FUNCTION (this << depth << root);
+
+  if (depth == m_depth)
     {
       //
       // If root is zero, we're beginning to see if we can use the object name 
@@ -414,8 +721,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  struct Segment &segment = m_segments[depth];
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -424,16 +730,12 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   // the root of the "/Names" namespace, so we just ignore it and move on to 
   // the next segment.
   //
-  if (root == 0)
+  if (root == 0 && segment.names)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
-        {
-          m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
-          m_workStack.pop_back ();
-          return;
-        }
+      m_workStack.push_back (segment.item);
+      DoResolve (depth + 1, root);
+      m_workStack.pop_back ();
+      return;
     }
 
   //
@@ -442,12 +744,12 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   // zero, this means to look in the root of the "/Names" name space, otherwise
   // it refers to a name space context (level).
   //
-  Ptr<Object> namedObject = Names::Find<Object> (root, item);
+  Ptr<Object> namedObject = Names::Find<Object> (root, segment.item);
   if (namedObject)
     {
-      NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
-      m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      NS_LOG_DEBUG ("Name system resolved item = " << segment.item << " to " << namedObject);
+      m_workStack.push_back (segment.item);
+      DoResolve (depth + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -463,119 +765,119 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       return;
     }
-  std::string::size_type dollarPos = item.find ("$");
-  if (dollarPos == 0)
+  if (segment.getObject)
     {
       // This is a call to GetObject
-      std::string tidString = item.substr (1, item.size () - 1);
-      NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
-      Ptr<Object> object = root->GetObject<Object> (tid);
+      NS_LOG_DEBUG ("GetObject="<<segment.item<<" on path="<<GetResolvedPath ());
+      if (!segment.found)
+        {
+          // report the unknown TypeId
+          TypeId::LookupByName (segment.item.substr (1, segment.item.size () - 1));
+        }
+      Ptr<Object> object = root->GetObject<Object> (segment.tid);
       if (object == 0)
         {
-          NS_LOG_DEBUG ("GetObject ("<<tidString<<") failed on path="<<GetResolvedPath ());
+          NS_LOG_DEBUG ("GetObject ("<<segment.item<<") failed on path="<<GetResolvedPath ());
           return;
         }
-      m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      m_workStack.push_back (segment.item);
+      DoResolve (depth + 1, object);
       m_workStack.pop_back ();
     }
   else 
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
+      const AttributeMatches &matches = LookupAttributes (segment, root);
       bool foundMatch = false;
-      
-      do
+      for (AttributeMatches::const_iterator i = matches.begin (); i != matches.end (); ++i)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          if (i->pointer)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<i->name<<" on path="<<GetResolvedPath ());
+              PointerValue pValue;
+              GetAttribute (root, *i, pValue);
+              Ptr<Object> object = pValue.Get<Object> ();
+              if (object == 0)
                 {
+                  NS_LOG_ERROR ("Requested object name=\""<<segment.item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
                   continue;
                 }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *pChecker = dynamic_cast<const PointerChecker *> (PeekPointer(info.checker));
-              if (pChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue pValue;
-                  root->GetAttribute (info.name, pValue);
-                  Ptr<Object> object = pValue.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
-                }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
-                }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              foundMatch = true;
+              m_workStack.push_back (i->name);
+              DoResolve (depth + 1, object);
+              m_workStack.pop_back ();
             }
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<i->name<<" on path="<<GetResolvedPath ());
+              foundMatch = true;
+              ObjectPtrContainerValue vector;
+              GetAttribute (root, *i, vector);
+              m_workStack.push_back (i->name);
+              DoArrayResolve (depth + 1, vector);
+              m_workStack.pop_back ();
+            }
+        }
 
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
-      
       if (!foundMatch)
         {
-          NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
+          NS_LOG_DEBUG ("Requested item="<<segment.item<<" does not exist on path="<<GetResolvedPath ());
           return;
         }
     }
 }
 
-void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+void
+CompiledPathImpl::DoArrayResolve (std::size_t depth, const ObjectPtrContainerValue &container)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION (this << depth << &container);
+  if (depth == m_depth)
     {
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const ArrayMatcher &matcher = m_segments[depth].matcher;
+
+  if (!matcher.MatchesAll () && matcher.GetCount () < container.GetN ())
+    {
+      // Fewer indices than entries: look them up rather than testing
+      // every entry of the container.
+      for (std::vector<ArrayMatcher::Range>::const_iterator r = matcher.m_ranges.begin ();
+           r != matcher.m_ranges.end (); ++r)
+        {
+          for (uint64_t index = r->first; index <= r->second; ++index)
+            {
+              Ptr<Object> object = container.Get (index);
+              if (object)
+                {
+                  DoArrayResolveOne (depth, index, object);
+                }
+            }
+        }
+      return;
+    }
 
-  ArrayMatcher matcher = ArrayMatcher (item);
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
-      if (matcher.Matches ((*it).first))
+      if ((*it).second && matcher.Matches ((*it).first))
         {
-          std::ostringstream oss;
-          oss << (*it).first;
-          m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
-          m_workStack.pop_back ();
+          DoArrayResolveOne (depth, (*it).first, (*it).second);
         }
     }
 }
 
+void
+CompiledPathImpl::DoArrayResolveOne (std::size_t depth, std::size_t index, Ptr<Object> object)
+{
+  std::ostringstream oss;
+  oss << index;
+  m_workStack.push_back (oss.str ());
+  DoResolve (depth + 1, object);
+  m_workStack.pop_back ();
+}
+
 /**
  * \ingroup config-impl
  * Config system implementation class.
@@ -607,15 +909,6 @@ public:
   Ptr<Object> GetRootNamespaceObject (std::size_t i) const;
 
 private:
-  /**
-   * Break a Config path into the leading path and the last leaf token.
-   * \param [in] path The Config path.
-   * \param [in,out] root The leading part of the \p path,
-   *   up to the final slash.
-   * \param [in,out] leaf The trailing part of the \p path.
-   */
-  void ParsePath (std::string path, std::string *root, std::string *leaf) const;
-
   /** Container type to hold the root Config path tokens. */
   typedef std::vector<Ptr<Object> > Roots;
 
@@ -624,98 +917,42 @@ private:
 
 };  // class ConfigImpl
 
-void 
-ConfigImpl::ParsePath (std::string path, std::string *root, std::string *leaf) const
-{
-  NS_LOG_FUNCTION (this << path << root << leaf);
-
-  std::string::size_type slash = path.find_last_of ("/");
-  NS_ASSERT (slash != std::string::npos);
-  *root = path.substr (0, slash);
-  *leaf = path.substr (slash+1, path.size ()-(slash+1));
-  NS_LOG_FUNCTION (path << *root << *leaf);
-}
-
 void 
 ConfigImpl::Set (std::string path, const AttributeValue &value)
 {
   NS_LOG_FUNCTION (this << path << &value);
-
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  MatchContainer container = LookupMatches (root);
-  container.Set (leaf, value);
+  CompiledPath (path).Set (value);
 }
 void 
 ConfigImpl::ConnectWithoutContext (std::string path, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << path << &cb);
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  MatchContainer container = LookupMatches (root);
-  container.ConnectWithoutContext (leaf, cb);
+  CompiledPath (path).ConnectWithoutContext (cb);
 }
 void 
 ConfigImpl::DisconnectWithoutContext (std::string path, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << path << &cb);
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  MatchContainer container = LookupMatches (root);
-  container.DisconnectWithoutContext (leaf, cb);
+  CompiledPath (path).DisconnectWithoutContext (cb);
 }
 void 
 ConfigImpl::Connect (std::string path, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << path << &cb);
-
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  MatchContainer container = LookupMatches (root);
-  container.Connect (leaf, cb);
+  CompiledPath (path).Connect (cb);
 }
 void 
 ConfigImpl::Disconnect (std::string path, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << path << &cb);
-
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  MatchContainer container = LookupMatches (root);
-  container.Disconnect (leaf, cb);
+  CompiledPath (path).Disconnect (cb);
 }
 
 MatchContainer 
 ConfigImpl::LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
-  class LookupMatchesResolver : public Resolver 
-  {
-  public:
-    LookupMatchesResolver (std::string path)
-      : Resolver (path)
-    {}
-    virtual void DoOne (Ptr<Object> object, std::string path)
-    {
-      m_objects.push_back (object);
-      m_contexts.push_back (path);
-    }
-    std::vector<Ptr<Object> > m_objects;
-    std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
-  for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
-    {
-      resolver.Resolve (*i);
-    }
-
-  //
-  // See if we can do something with the object name service.  Starting with
-  // the root pointer zeroed indicates to the resolver that it should start
-  // looking at the root of the "/Names" namespace during this go.
-  //
-  resolver.Resolve (0);
-
-  return MatchContainer (resolver.m_objects, resolver.m_contexts, path);
+  return CompiledPath (path).LookupMatches ();
 }
 
 void 
@@ -754,6 +991,122 @@ ConfigImpl::GetRootNamespaceObject (std::size_t i) const
 }
 
 
+
+CompiledPath::CompiledPath (std::string path)
+  : m_impl (new CompiledPathImpl (path))
+{
+  NS_LOG_FUNCTION (this << path);
+}
+CompiledPath::CompiledPath (const CompiledPath &o)
+  : m_impl (o.m_impl)
+{
+  m_impl->Ref ();
+}
+CompiledPath &
+CompiledPath::operator = (const CompiledPath &o)
+{
+  o.m_impl->Ref ();
+  m_impl->Unref ();
+  m_impl = o.m_impl;
+  return *this;
+}
+CompiledPath::~CompiledPath ()
+{
+  m_impl->Unref ();
+  m_impl = 0;
+}
+std::string
+CompiledPath::GetPath (void) const
+{
+  return m_impl->GetPath ();
+}
+
+MatchContainer
+CompiledPath::LookupMatches (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Ptr<Object> > objects;
+  std::vector<std::string> contexts;
+  m_impl->Resolve (false, &objects, &contexts);
+  return MatchContainer (objects, contexts, GetPath ());
+}
+void
+CompiledPath::Set (const AttributeValue &value) const
+{
+  NS_LOG_FUNCTION (this << &value);
+  std::vector<Ptr<Object> > objects;
+  m_impl->Resolve (true, &objects, 0);
+  std::string name = m_impl->GetLeaf ();
+  for (std::vector<Ptr<Object> >::const_iterator i = objects.begin (); i != objects.end (); ++i)
+    {
+      (*i)->SetAttribute (name, value);
+    }
+}
+void
+CompiledPath::Connect (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  std::vector<Ptr<Object> > objects;
+  std::vector<std::string> contexts;
+  m_impl->Resolve (true, &objects, &contexts);
+  std::string name = m_impl->GetLeaf ();
+  for (uint32_t i = 0; i < objects.size (); ++i)
+    {
+      Ptr<const TraceSourceAccessor> accessor = m_impl->LookupTraceSource (objects[i]);
+      if (accessor != 0)
+        {
+          accessor->Connect (PeekPointer (objects[i]), contexts[i] + name, cb);
+        }
+    }
+}
+void
+CompiledPath::ConnectWithoutContext (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  std::vector<Ptr<Object> > objects;
+  m_impl->Resolve (true, &objects, 0);
+  for (std::vector<Ptr<Object> >::const_iterator i = objects.begin (); i != objects.end (); ++i)
+    {
+      Ptr<const TraceSourceAccessor> accessor = m_impl->LookupTraceSource (*i);
+      if (accessor != 0)
+        {
+          accessor->ConnectWithoutContext (PeekPointer (*i), cb);
+        }
+    }
+}
+void
+CompiledPath::Disconnect (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  std::vector<Ptr<Object> > objects;
+  std::vector<std::string> contexts;
+  m_impl->Resolve (true, &objects, &contexts);
+  std::string name = m_impl->GetLeaf ();
+  for (uint32_t i = 0; i < objects.size (); ++i)
+    {
+      Ptr<const TraceSourceAccessor> accessor = m_impl->LookupTraceSource (objects[i]);
+      if (accessor != 0)
+        {
+          accessor->Disconnect (PeekPointer (objects[i]), contexts[i] + name, cb);
+        }
+    }
+}
+void
+CompiledPath::DisconnectWithoutContext (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  std::vector<Ptr<Object> > objects;
+  m_impl->Resolve (true, &objects, 0);
+  for (std::vector<Ptr<Object> >::const_iterator i = objects.begin (); i != objects.end (); ++i)
+    {
+      Ptr<const TraceSourceAccessor> accessor = m_impl->LookupTraceSource (*i);
+      if (accessor != 0)
+        {
+          accessor->DisconnectWithoutContext (PeekPointer (*i), cb);
+        }
+    }
+}
+
 void Reset (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
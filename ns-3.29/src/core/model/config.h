@@ -258,6 +258,88 @@ private:
  */
 MatchContainer LookupMatches (std::string path);
 
+class CompiledPathImpl;
+
+/**
+ * \ingroup config
+ * \brief A Config path parsed once, to be resolved many times.
+ *
+ * The functions above parse their path string again for every object
+ * they visit.  A CompiledPath splits the path into its segments, looks
+ * up the \c $TypeId segments and parses the array specifications
+ * (\c *, \c a|b, \c [x-y]) when it is constructed, and caches, for each
+ * TypeId it meets, the attributes a segment refers to and the trace
+ * source or attribute the leaf names.  Resolving the path then costs
+ * in proportion to the number of objects visited, which matters for
+ * paths that expand over every node and socket of a large topology.
+ * Copies share the parsed path and its caches.
+ *
+ * The Config functions taking a path string use a temporary
+ * CompiledPath, so both forms match exactly the same objects.
+ */
+class CompiledPath
+{
+public:
+  /**
+   * Parse a Config path.
+   * \param [in] path The Config path.
+   */
+  CompiledPath (std::string path);
+  /**
+   * Copy constructor.
+   * \param [in] o The CompiledPath to copy.
+   */
+  CompiledPath (const CompiledPath &o);
+  /**
+   * Assignment operator.
+   * \param [in] o The CompiledPath to copy.
+   * \returns This CompiledPath.
+   */
+  CompiledPath & operator = (const CompiledPath &o);
+  /** Destructor. */
+  ~CompiledPath ();
+
+  /**
+   * \returns The path this object was constructed from.
+   */
+  std::string GetPath (void) const;
+
+  /**
+   * \returns A container with all the objects which match the whole path.
+   * \sa ns3::Config::LookupMatches
+   */
+  MatchContainer LookupMatches (void) const;
+  /**
+   * \param [in] value The value to set in all matching attributes.
+   * \sa ns3::Config::Set
+   */
+  void Set (const AttributeValue &value) const;
+  /**
+   * \param [in] cb The callback to connect to the matching trace sources.
+   * \sa ns3::Config::Connect
+   */
+  void Connect (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The callback to connect to the matching trace sources.
+   * \sa ns3::Config::ConnectWithoutContext
+   */
+  void ConnectWithoutContext (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The callback to disconnect from the matching trace sources.
+   * \sa ns3::Config::Disconnect
+   */
+  void Disconnect (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The callback to disconnect from the matching trace sources.
+   * \sa ns3::Config::DisconnectWithoutContext
+   */
+  void DisconnectWithoutContext (const CallbackBase &cb) const;
+
+private:
+  /** The parsed path, shared between copies. */
+  CompiledPathImpl *m_impl;
+};
+
 /**
  * \ingroup config
  * \param [in] obj A new root object
@@ -25,10 +25,15 @@
 
 #include "ptr.h"
 #include "pointer.h"
+#include "uinteger.h"
+#include "string.h"
 #include "assert.h"
 #include "log.h"
 
+#include <chrono>
 #include <cmath>
+#include <fstream>
+#include <iostream>
 
 
 /**
@@ -53,6 +58,29 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("MaxEventsWithContext",
+                   "The maximum number of events scheduled from other "
+                   "threads that may be pending before the main thread "
+                   "picks them up.  Scheduling threads wait while the "
+                   "limit is reached.  Zero means no limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::SetMaxEventsWithContext,
+                                         &DefaultSimulatorImpl::GetMaxEventsWithContext),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("EventProfilePeriod",
+                   "Time the wall clock duration of one event out of this "
+                   "many, and print the profile by function and by context "
+                   "at Simulator::Destroy.  Zero disables the profiler.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::SetEventProfilePeriod,
+                                         &DefaultSimulatorImpl::GetEventProfilePeriod),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("EventProfileFile",
+                   "The file the event profile is written to, "
+                   "standard error if empty.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileFile),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -70,8 +98,8 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentUid = 0;
   m_currentTs = 0;
   m_currentContext = Simulator::NO_CONTEXT;
+  m_eventCount = 0;
   m_unscheduledEvents = 0;
-  m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
 }
 
@@ -108,6 +136,33 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+
+  if (m_profiler.GetSamplingPeriod () != 0)
+    {
+      if (m_profileFile.empty ())
+        {
+          m_profiler.Print (std::cerr);
+        }
+      else
+        {
+          std::ofstream os (m_profileFile.c_str ());
+          m_profiler.Print (os);
+        }
+      m_profiler.Clear ();
+    }
+}
+
+void
+DefaultSimulatorImpl::SetEventProfilePeriod (uint32_t period)
+{
+  NS_LOG_FUNCTION (this << period);
+  m_profiler.SetSamplingPeriod (period);
+}
+
+uint32_t
+DefaultSimulatorImpl::GetEventProfilePeriod (void) const
+{
+  return m_profiler.GetSamplingPeriod ();
 }
 
 void
@@ -145,8 +200,19 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   NS_LOG_LOGIC ("handle " << next.key.m_ts);
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
+  m_eventCount++;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler.Sample ())
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      next.impl->Invoke ();
+      std::chrono::nanoseconds ns = std::chrono::steady_clock::now () - start;
+      m_profiler.Record (next.impl, m_currentContext, ns.count ());
+    }
+  else
+    {
+      next.impl->Invoke ();
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -161,31 +227,35 @@ DefaultSimulatorImpl::IsFinished (void) const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  if (m_eventsWithContext.IsEmpty ())
     {
       return;
     }
 
-  // swap queues
-  EventsWithContext eventsWithContext;
-  {
-    CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
-  }
-  while (!eventsWithContext.empty ())
+  m_eventsWithContext.Drain ([this] (const EventWithContext &event)
     {
-       EventWithContext event = eventsWithContext.front ();
-       eventsWithContext.pop_front ();
-       Scheduler::Event ev;
-       ev.impl = event.event;
-       ev.key.m_ts = m_currentTs + event.timestamp;
-       ev.key.m_context = event.context;
-       ev.key.m_uid = m_uid;
-       m_uid++;
-       m_unscheduledEvents++;
-       m_events->Insert (ev);
-    }
+      Scheduler::Event ev;
+      ev.impl = event.event;
+      ev.key.m_ts = m_currentTs + event.timestamp;
+      ev.key.m_context = event.context;
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      m_unscheduledEvents++;
+      m_events->Insert (ev);
+    });
+}
+
+void
+DefaultSimulatorImpl::SetMaxEventsWithContext (uint32_t capacity)
+{
+  NS_LOG_FUNCTION (this << capacity);
+  m_eventsWithContext.SetCapacity (capacity);
+}
+
+uint32_t
+DefaultSimulatorImpl::GetMaxEventsWithContext (void) const
+{
+  return m_eventsWithContext.GetCapacity ();
 }
 
 void
@@ -268,11 +338,7 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       // Current time added in ProcessEventsWithContext()
       ev.timestamp = delay.GetTimeStep ();
       ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
-      }
+      m_eventsWithContext.Push (ev);
     }
 }
 
@@ -411,4 +477,16 @@ DefaultSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint64_t
+DefaultSimulatorImpl::GetEventCount (void) const
+{
+  return m_eventCount;
+}
+
+uint64_t
+DefaultSimulatorImpl::GetPendingEventCount (void) const
+{
+  return m_unscheduledEvents;
+}
+
 } // namespace ns3
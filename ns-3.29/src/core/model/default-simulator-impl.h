@@ -25,7 +25,8 @@
 #include "scheduler.h"
 #include "event-impl.h"
 #include "system-thread.h"
-#include "system-mutex.h"
+#include "mpsc-queue.h"
+#include "event-profiler.h"
 
 #include "ptr.h"
 
@@ -77,6 +78,8 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+  virtual uint64_t GetPendingEventCount (void) const;
 
 private:
   virtual void DoDispose (void);
@@ -85,6 +88,27 @@ private:
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
+
+  /**
+   * Set the maximum number of events pending from other threads.
+   * \param [in] capacity The capacity, 0 for no limit.
+   */
+  void SetMaxEventsWithContext (uint32_t capacity);
+  /**
+   * Get the maximum number of events pending from other threads.
+   * \returns The capacity, 0 if there is no limit.
+   */
+  uint32_t GetMaxEventsWithContext (void) const;
+  /**
+   * Set the sampling period of the event profiler.
+   * \param [in] period Time one event out of \p period, 0 to disable.
+   */
+  void SetEventProfilePeriod (uint32_t period);
+  /**
+   * Get the sampling period of the event profiler.
+   * \returns The sampling period, 0 if the profiler is disabled.
+   */
+  uint32_t GetEventProfilePeriod (void) const;
  
   /** Wrap an event with its execution context. */
   struct EventWithContext {
@@ -95,17 +119,11 @@ private:
     /** The event implementation. */
     EventImpl *event;
   };
-  /** Container type for the events from a different context. */
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
   /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * The events scheduled from other threads.  Producers push lock-free;
+   * the main thread drains the whole batch in ProcessEventsWithContext().
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
-  SystemMutex m_eventsWithContextMutex;
+  MpscQueue<struct EventWithContext> m_eventsWithContext;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
@@ -124,6 +142,8 @@ private:
   uint64_t m_currentTs;
   /** Execution context of the current event. */
   uint32_t m_currentContext;
+  /** The event count. */
+  uint64_t m_eventCount;
   /**
    * Number of events that have been inserted but not yet scheduled,
    *  not counting the Destroy events; this is used for validation
@@ -132,6 +152,11 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** The wall clock profile of the events. */
+  EventProfiler m_profiler;
+  /** The file the profile is written to, standard error if empty. */
+  std::string m_profileFile;
 };
 
 } // namespace ns3
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -65,6 +66,17 @@ public:
    * Checked by the simulation engine before calling Invoke().
    */
   bool IsCancelled (void);
+  /**
+   * Get the function or method this event calls.
+   *
+   * The events created by MakeEvent() return their function pointer,
+   * so that an event profiler can tell apart events of the same type
+   * calling different functions.
+   *
+   * \param [out] size The size of the function pointer, in bytes.
+   * \returns A pointer to the function pointer, or 0 if unknown.
+   */
+  virtual const void * PeekFunction (std::size_t &size) const;
 
 protected:
   /**
@@ -0,0 +1,306 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "log.h"
+#include "ns3/core-config.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+#include <cxxabi.h>
+
+#ifdef HAVE_DLFCN_H
+#include <dlfcn.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+/**
+ * Demangle a type or symbol name.
+ * \param [in] mangled The mangled name.
+ * \returns The demangled name, or \p mangled if it is not a C++ name.
+ */
+static std::string
+Demangle (const char *mangled)
+{
+  int status;
+  char *demangled = abi::__cxa_demangle (mangled, 0, 0, &status);
+  if (status != 0)
+    {
+      return mangled;
+    }
+  std::string name = demangled;
+  std::free (demangled);
+  return name;
+}
+
+EventProfiler::Stats::Stats ()
+  : count (0),
+    cancelled (0),
+    ns (0)
+{
+}
+
+bool
+EventProfiler::Key::operator < (const Key &o) const
+{
+  if (type != o.type)
+    {
+      return type->before (*o.type);
+    }
+  if (size != o.size)
+    {
+      return size < o.size;
+    }
+  return std::memcmp (function, o.function, sizeof (function)) < 0;
+}
+
+EventProfiler::EventProfiler ()
+  : m_period (0),
+    m_countdown (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EventProfiler::SetSamplingPeriod (uint32_t period)
+{
+  NS_LOG_FUNCTION (this << period);
+  m_period = period;
+  m_countdown = period;
+}
+
+uint32_t
+EventProfiler::GetSamplingPeriod (void) const
+{
+  return m_period;
+}
+
+EventProfiler::Key
+EventProfiler::GetKey (const EventImpl *event)
+{
+  Key key;
+  key.type = &typeid (*event);
+  std::memset (key.function, 0, sizeof (key.function));
+  const void *function = event->PeekFunction (key.size);
+  if (function != 0)
+    {
+      std::memcpy (key.function, function, std::min (key.size, sizeof (key.function)));
+    }
+  return key;
+}
+
+void
+EventProfiler::Record (EventImpl *event, uint32_t context, int64_t ns)
+{
+  bool cancelled = event->IsCancelled ();
+  Stats *stats[3];
+  stats[0] = &m_types[GetKey (event)];
+  if (context == 0xffffffff)
+    {
+      stats[1] = &m_noContext;
+    }
+  else
+    {
+      if (context >= m_contexts.size ())
+        {
+          m_contexts.resize (context + 1);
+        }
+      stats[1] = &m_contexts[context];
+    }
+  stats[2] = &m_total;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      stats[i]->count++;
+      stats[i]->cancelled += cancelled;
+      stats[i]->ns += ns;
+    }
+}
+
+uint64_t
+EventProfiler::GetSampleCount (void) const
+{
+  return m_total.count;
+}
+
+void
+EventProfiler::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_types.clear ();
+  m_contexts.clear ();
+  m_noContext = Stats ();
+  m_total = Stats ();
+  m_countdown = m_period;
+}
+
+std::string
+EventProfiler::GetEventName (const EventImpl *event)
+{
+  return GetName (GetKey (event));
+}
+
+std::string
+EventProfiler::GetName (const Key &key)
+{
+  std::string type = Demangle (key.type->name ());
+  if (key.size == 0)
+    {
+      return type;
+    }
+  uintptr_t address = key.function[0];
+  if (key.size == 2 * sizeof (uintptr_t) && (address & 1))
+    {
+      // Itanium C++ ABI: a pointer to a virtual method holds one plus
+      // the offset of the method in the vtable.  The type of the method
+      // is the first template argument of MakeEvent.
+      std::string method = type;
+      std::string::size_type start = type.find ("MakeEvent<");
+      if (start != std::string::npos)
+        {
+          start += std::strlen ("MakeEvent<");
+          int depth = 0;
+          std::string::size_type end = start;
+          for (; end < type.size (); ++end)
+            {
+              char c = type[end];
+              if (depth == 0 && (c == ',' || c == '>'))
+                {
+                  break;
+                }
+              depth += (c == '<' || c == '(') - (c == '>' || c == ')');
+            }
+          method = type.substr (start, end - start);
+        }
+      std::ostringstream oss;
+      oss << "virtual " << method << " at vtable offset " << address - 1;
+      return oss.str ();
+    }
+  std::ostringstream oss;
+#ifdef HAVE_DLFCN_H
+  Dl_info info;
+  if (dladdr (reinterpret_cast<void *> (address), &info) != 0)
+    {
+      if (info.dli_sname != 0)
+        {
+          return Demangle (info.dli_sname);
+        }
+      if (info.dli_fname != 0)
+        {
+          oss << info.dli_fname << "+0x" << std::hex
+              << address - reinterpret_cast<uintptr_t> (info.dli_fbase);
+          return oss.str ();
+        }
+    }
+#endif
+  oss << "0x" << std::hex << address << " (" << type << ")";
+  return oss.str ();
+}
+
+void
+EventProfiler::PrintStats (std::ostream &os, const Stats &stats, int64_t total, std::string name) const
+{
+  uint64_t scale = std::max<uint64_t> (m_period, 1);
+  os << std::fixed
+     << std::setw (6) << std::setprecision (2) << (total ? 100.0 * stats.ns / total : 0.0)
+     << std::setw (12) << std::setprecision (3) << stats.ns * scale / 1e6
+     << std::setw (12) << stats.count * scale
+     << std::setw (11) << stats.cancelled * scale
+     << std::setw (10) << std::setprecision (0) << (stats.count ? double (stats.ns) / stats.count : 0.0)
+     << "  " << name << std::endl;
+}
+
+void
+EventProfiler::Print (std::ostream &os, uint32_t maxContexts) const
+{
+  NS_LOG_FUNCTION (this << maxContexts);
+
+  std::ios_base::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  uint64_t scale = std::max<uint64_t> (m_period, 1);
+  os << "EVENT PROFILE: " << m_total.count << " events timed, one out of " << scale
+     << ", counts and times below are scaled up accordingly" << std::endl;
+
+  // the same function may be called by events of several types, for
+  // instance from MakeEvent with a raw pointer or a Ptr to the object
+  std::map<std::string, Stats> functions;
+  for (std::map<Key, Stats>::const_iterator it = m_types.begin (); it != m_types.end (); ++it)
+    {
+      Stats &stats = functions[GetName (it->first)];
+      stats.count += it->second.count;
+      stats.cancelled += it->second.cancelled;
+      stats.ns += it->second.ns;
+    }
+  std::vector<std::pair<const Stats *, std::string> > rows;
+  for (std::map<std::string, Stats>::const_iterator it = functions.begin (); it != functions.end (); ++it)
+    {
+      rows.push_back (std::make_pair (&it->second, it->first));
+    }
+  std::sort (rows.begin (), rows.end (),
+             [] (const std::pair<const Stats *, std::string> &a, const std::pair<const Stats *, std::string> &b)
+    {
+      return a.first->ns > b.first->ns;
+    });
+  os << "     %     wall_ms      events  cancelled  ns/event  function" << std::endl;
+  for (uint32_t i = 0; i < rows.size (); ++i)
+    {
+      PrintStats (os, *rows[i].first, m_total.ns, rows[i].second);
+    }
+  PrintStats (os, m_total, m_total.ns, "total");
+
+  std::vector<std::pair<const Stats *, uint32_t> > contexts;
+  for (uint32_t i = 0; i < m_contexts.size (); ++i)
+    {
+      if (m_contexts[i].count != 0)
+        {
+          contexts.push_back (std::make_pair (&m_contexts[i], i));
+        }
+    }
+  std::sort (contexts.begin (), contexts.end (),
+             [] (const std::pair<const Stats *, uint32_t> &a, const std::pair<const Stats *, uint32_t> &b)
+    {
+      return a.first->ns > b.first->ns;
+    });
+  os << "     %     wall_ms      events  cancelled  ns/event  context (" << contexts.size ()
+     << " contexts, top " << std::min<std::size_t> (maxContexts, contexts.size ()) << ")" << std::endl;
+  if (m_noContext.count != 0)
+    {
+      PrintStats (os, m_noContext, m_total.ns, "none");
+    }
+  for (uint32_t i = 0; i < contexts.size () && i < maxContexts; ++i)
+    {
+      std::ostringstream oss;
+      oss << contexts[i].second;
+      PrintStats (os, *contexts[i].first, m_total.ns, oss.str ());
+    }
+  os.flags (flags);
+  os.precision (precision);
+}
+
+} // namespace ns3
@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ * \brief Wall clock profile of the events run by a simulator.
+ *
+ * Unlike DesMetrics, which writes a record for every event scheduled,
+ * the profiler only keeps aggregates: for every kind of event (the
+ * EventImpl type and the function it calls, see EventImpl::PeekFunction)
+ * and for every context, the number of events run, how many of them had
+ * been cancelled and the wall clock time they took.
+ *
+ * With a sampling period of \c n, the simulator only times one event out
+ * of \c n, and the report scales the counts and times up by \c n.  The
+ * cost of the profiler for the other events is a counter decrement.
+ *
+ * Function names are looked up in the dynamic symbol table.  Functions
+ * of the main program are only found if it was linked with \c -rdynamic;
+ * otherwise the report gives the executable and the offset of the
+ * function, for \c addr2line.
+ */
+class EventProfiler
+{
+public:
+  /** Constructor, the profiler starts disabled. */
+  EventProfiler ();
+
+  /**
+   * Set the sampling period.
+   * \param [in] period Time one event out of \p period, 0 to disable.
+   */
+  void SetSamplingPeriod (uint32_t period);
+  /**
+   * Get the sampling period.
+   * \returns The sampling period, 0 if disabled.
+   */
+  uint32_t GetSamplingPeriod (void) const;
+
+  /**
+   * Check if the next event is to be timed.
+   * \returns \c true once every sampling period.
+   */
+  bool Sample (void)
+  {
+    if (m_countdown == 0 || --m_countdown != 0)
+      {
+        return false;
+      }
+    m_countdown = m_period;
+    return true;
+  }
+
+  /**
+   * Account a timed event.
+   * \param [in] event The event, after it was invoked.
+   * \param [in] context The context of the event.
+   * \param [in] ns The wall clock time the event took, in nanoseconds.
+   */
+  void Record (EventImpl *event, uint32_t context, int64_t ns);
+
+  /**
+   * Print the profile, largest wall clock time first.
+   * \param [in,out] os The output stream.
+   * \param [in] maxContexts The number of contexts to list.
+   */
+  void Print (std::ostream &os, uint32_t maxContexts = 20) const;
+
+  /** Forget the events recorded so far. */
+  void Clear (void);
+
+  /**
+   * Get the number of events timed so far.
+   * \returns The number of events recorded.
+   */
+  uint64_t GetSampleCount (void) const;
+
+  /**
+   * Get the name under which an event is reported.
+   * \param [in] event The event.
+   * \returns The function the event calls, or the event type.
+   */
+  static std::string GetEventName (const EventImpl *event);
+
+private:
+  /** The aggregates of a kind of event or of a context. */
+  struct Stats
+  {
+    Stats ();
+    uint64_t count;      //!< Number of events timed.
+    uint64_t cancelled;  //!< Number of those which had been cancelled.
+    int64_t ns;          //!< Wall clock time of the events, in nanoseconds.
+  };
+
+  /** A kind of event: its type and the function it calls. */
+  struct Key
+  {
+    const std::type_info *type;  //!< The EventImpl subclass.
+    std::size_t size;            //!< Size of the function pointer.
+    uintptr_t function[2];       //!< The function pointer.
+    /**
+     * Strict weak order.
+     * \param [in] o The other key.
+     * \returns \c true if this key is before \p o.
+     */
+    bool operator < (const Key &o) const;
+  };
+
+  /**
+   * Make the key of an event.
+   * \param [in] event The event.
+   * \returns The key.
+   */
+  static Key GetKey (const EventImpl *event);
+  /**
+   * Get the name of a kind of event.
+   * \param [in] key The key.
+   * \returns The name.
+   */
+  static std::string GetName (const Key &key);
+  /**
+   * Print a line of the report.
+   * \param [in,out] os The output stream.
+   * \param [in] stats The aggregates.
+   * \param [in] total The total wall clock time, in nanoseconds.
+   * \param [in] name The name of the line.
+   */
+  void PrintStats (std::ostream &os, const Stats &stats, int64_t total, std::string name) const;
+
+  uint32_t m_period;                      //!< Sampling period, 0 if disabled.
+  uint32_t m_countdown;                   //!< Events until the next sample.
+  std::map<Key, Stats> m_types;           //!< Aggregates by kind of event.
+  std::vector<Stats> m_contexts;          //!< Aggregates by context.
+  Stats m_noContext;                      //!< Aggregates of the events without context.
+  Stats m_total;                          //!< Aggregates of all the events.
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
@@ -52,6 +52,11 @@ protected:
     {
       (*m_function)();
     }
+    virtual const void * PeekFunction (std::size_t &size) const
+    {
+      size = sizeof (m_function);
+      return &m_function;
+    }
 private:
     F m_function;
   } *ev = new EventFunctionImpl0 (f);
@@ -375,6 +375,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)();
     }
+    virtual const void * PeekFunction (std::size_t &size) const
+    {
+      size = sizeof (m_function);
+      return &m_function;
+    }
     OBJ m_obj;
     MEM m_function;
   } *ev = new EventMemberImpl0 (obj, mem_ptr);
@@ -405,6 +410,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1);
     }
+    virtual const void * PeekFunction (std::size_t &size) const
+    {
+      size = sizeof (m_function);
+      return &m_function;
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -436,6 +446,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2);
     }
+    virtual const void * PeekFunction (std::size_t &size) const
+    {
+      size = sizeof (m_function);
+      return &m_function;
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -469,6 +484,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual const void * PeekFunction (std::size_t &size) const
+    {
+      size = sizeof (m_function);
+      return &m_function;
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -504,6 +524,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual const void * PeekFunction (std::size_t &size) const
+    {
+      size = sizeof (m_function);
+      return &m_function;
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -542,6 +567,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual const void * PeekFunction (std::size_t &size) const
+    {
+      size = sizeof (m_function);
+      return &m_function;
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -582,6 +612,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
+    virtual const void * PeekFunction (std::size_t &size) const
+    {
+      size = sizeof (m_function);
+      return &m_function;
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -617,6 +652,11 @@ private:
     {
       (*m_function)(m_a1);
     }
+    virtual const void * PeekFunction (std::size_t &size) const
+    {
+      size = sizeof (m_function);
+      return &m_function;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
   } *ev = new EventFunctionImpl1 (f, a1);
@@ -647,6 +687,11 @@ private:
     {
       (*m_function)(m_a1, m_a2);
     }
+    virtual const void * PeekFunction (std::size_t &size) const
+    {
+      size = sizeof (m_function);
+      return &m_function;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -680,6 +725,11 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual const void * PeekFunction (std::size_t &size) const
+    {
+      size = sizeof (m_function);
+      return &m_function;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -715,6 +765,11 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual const void * PeekFunction (std::size_t &size) const
+    {
+      size = sizeof (m_function);
+      return &m_function;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -752,6 +807,11 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual const void * PeekFunction (std::size_t &size) const
+    {
+      size = sizeof (m_function);
+      return &m_function;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -791,6 +851,11 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
+    virtual const void * PeekFunction (std::size_t &size) const
+    {
+      size = sizeof (m_function);
+      return &m_function;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
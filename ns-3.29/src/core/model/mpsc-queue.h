@@ -0,0 +1,281 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include "non-copyable.h"
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup thread
+ * ns3::MpscQueue declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup thread
+ * \brief A lock-free multi-producer, single-consumer queue.
+ *
+ * Any number of threads may Push() items concurrently; a single consumer
+ * thread takes every pending item at once with Drain().  Producers push
+ * onto an atomic singly linked stack with a compare-and-swap, and the
+ * consumer detaches the whole stack with a single exchange and reverses it,
+ * so items are handed to the consumer in the order they were pushed (per
+ * producer, and in linearization order across producers).
+ *
+ * The queue is unbounded by default.  With a non-zero capacity, Push()
+ * applies backpressure: a producer finding the queue full yields until the
+ * consumer has drained it.  TryPush() fails instead of waiting.
+ *
+ * \tparam T \explicit The item type; must be copyable.
+ */
+template <typename T>
+class MpscQueue : private NonCopyable
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] capacity The maximum number of pending items,
+   *             or 0 for an unbounded queue.
+   */
+  MpscQueue (std::size_t capacity = 0);
+  /** Destructor.  Pending items are discarded. */
+  ~MpscQueue ();
+
+  /**
+   * Set the maximum number of pending items.
+   * \param [in] capacity The capacity, or 0 for an unbounded queue.
+   */
+  void SetCapacity (std::size_t capacity);
+  /**
+   * Get the maximum number of pending items.
+   * \returns The capacity, 0 if the queue is unbounded.
+   */
+  std::size_t GetCapacity (void) const;
+
+  /**
+   * Add an item, waiting for room if the queue is bounded and full.
+   * \param [in] item The item.
+   */
+  void Push (const T &item);
+  /**
+   * Add an item if there is room for it.
+   * \param [in] item The item.
+   * \returns \c true if the item was added.
+   */
+  bool TryPush (const T &item);
+
+  /**
+   * Take every pending item.  Must only be called by the consumer thread.
+   *
+   * \tparam F \deduced The type of the function to apply.
+   * \param [in] f The function called on each item, in FIFO order.
+   * \returns The number of items drained.
+   */
+  template <typename F>
+  std::size_t Drain (F f);
+
+  /**
+   * Check for pending items.  The answer may be stale by the time it is
+   * returned, unless producers are known to be quiescent.
+   * \returns \c true if no items are pending.
+   */
+  bool IsEmpty (void) const;
+  /**
+   * Get the number of pending items (approximate under contention).
+   * \returns The number of pending items.
+   */
+  std::size_t GetSize (void) const;
+
+private:
+  /** A pending item. */
+  struct Node
+  {
+    T m_item;       //!< The item.
+    Node *m_next;   //!< The previously pushed node.
+  };
+
+  /**
+   * Reserve room for one item.
+   * \returns \c true if room was reserved.
+   */
+  bool Reserve (void);
+  /**
+   * Link a node onto the stack of pending items.
+   * \param [in] item The item.
+   */
+  void Link (const T &item);
+
+  std::atomic<Node *> m_head;         //!< Most recently pushed node.
+  std::atomic<std::size_t> m_size;    //!< Number of pending items.
+  std::atomic<std::size_t> m_capacity; //!< Maximum pending items, 0 if unbounded.
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+MpscQueue<T>::MpscQueue (std::size_t capacity)
+  : m_head (0),
+    m_size (0),
+    m_capacity (capacity)
+{
+}
+
+template <typename T>
+MpscQueue<T>::~MpscQueue ()
+{
+  Node *node = m_head.exchange (0);
+  while (node != 0)
+    {
+      Node *next = node->m_next;
+      delete node;
+      node = next;
+    }
+}
+
+template <typename T>
+void
+MpscQueue<T>::SetCapacity (std::size_t capacity)
+{
+  m_capacity.store (capacity, std::memory_order_relaxed);
+}
+
+template <typename T>
+std::size_t
+MpscQueue<T>::GetCapacity (void) const
+{
+  return m_capacity.load (std::memory_order_relaxed);
+}
+
+template <typename T>
+bool
+MpscQueue<T>::Reserve (void)
+{
+  std::size_t capacity = m_capacity.load (std::memory_order_relaxed);
+  if (capacity == 0)
+    {
+      m_size.fetch_add (1, std::memory_order_relaxed);
+      return true;
+    }
+  std::size_t size = m_size.load (std::memory_order_relaxed);
+  do
+    {
+      if (size >= capacity)
+        {
+          return false;
+        }
+    }
+  while (!m_size.compare_exchange_weak (size, size + 1, std::memory_order_relaxed));
+  return true;
+}
+
+template <typename T>
+void
+MpscQueue<T>::Link (const T &item)
+{
+  Node *node = new Node;
+  node->m_item = item;
+  node->m_next = m_head.load (std::memory_order_relaxed);
+  while (!m_head.compare_exchange_weak (node->m_next, node,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed))
+    {
+    }
+}
+
+template <typename T>
+void
+MpscQueue<T>::Push (const T &item)
+{
+  while (!Reserve ())
+    {
+      std::this_thread::yield ();
+    }
+  Link (item);
+}
+
+template <typename T>
+bool
+MpscQueue<T>::TryPush (const T &item)
+{
+  if (!Reserve ())
+    {
+      return false;
+    }
+  Link (item);
+  return true;
+}
+
+template <typename T>
+template <typename F>
+std::size_t
+MpscQueue<T>::Drain (F f)
+{
+  Node *node = m_head.exchange (0, std::memory_order_acquire);
+
+  // The stack holds the newest item first; reverse it to restore FIFO order.
+  Node *fifo = 0;
+  while (node != 0)
+    {
+      Node *next = node->m_next;
+      node->m_next = fifo;
+      fifo = node;
+      node = next;
+    }
+
+  std::size_t n = 0;
+  while (fifo != 0)
+    {
+      Node *next = fifo->m_next;
+      f (fifo->m_item);
+      delete fifo;
+      fifo = next;
+      ++n;
+    }
+  m_size.fetch_sub (n, std::memory_order_relaxed);
+  return n;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::IsEmpty (void) const
+{
+  return m_head.load (std::memory_order_relaxed) == 0;
+}
+
+template <typename T>
+std::size_t
+MpscQueue<T>::GetSize (void) const
+{
+  return m_size.load (std::memory_order_relaxed);
+}
+
+} // namespace ns3
+
+#endif /* MPSC_QUEUE_H */
@@ -61,7 +61,7 @@ ObjectPtrContainerValue::Get (std::size_t i) const
   Ptr<Object> value = 0;
   if ( it != m_objects.end () )
   {
-    value = m_objects.find (i)->second;
+    value = it->second;
   }
   return value;
 }
@@ -113,6 +113,13 @@ ObjectPtrContainerAccessor::Get (const ObjectBase * object, AttributeValue &valu
       return false;
     }
   v->m_objects.clear ();
+  return DoGetAll (object, &v->m_objects);
+}
+bool
+ObjectPtrContainerAccessor::DoGetAll (const ObjectBase *object,
+                                      std::map<std::size_t, Ptr<Object> > *objects) const
+{
+  NS_LOG_FUNCTION (this << object << objects);
   std::size_t n;
   bool ok = DoGetN (object, &n);
   if (!ok)
@@ -123,7 +130,8 @@ ObjectPtrContainerAccessor::Get (const ObjectBase * object, AttributeValue &valu
     {
       std::size_t index;
       Ptr<Object> o = DoGet (object, i, &index);
-      v->m_objects[index] = o;
+      // indices usually come in increasing order: append at the end
+      objects->emplace_hint (objects->end (), index, o)->second = o;
     }
   return true;
 }
@@ -238,6 +238,18 @@ private:
    * \returns The index requested.
    */
   virtual Ptr<Object> DoGet(const ObjectBase *object, std::size_t i, std::size_t *index) const = 0;
+  /**
+   * Get all the instances in the container.
+   *
+   * The default implementation calls DoGet() for each position;
+   * containers which cannot be indexed by position in constant time
+   * walk themselves once instead.
+   *
+   * \param [in] object The container object.
+   * \param [out] objects The instances, by index.
+   * \returns true if the instances could be obtained successfully.
+   */
+  virtual bool DoGetAll (const ObjectBase *object, std::map<std::size_t, Ptr<Object> > *objects) const;
 };
 
 template <typename T, typename U, typename INDEX>
@@ -109,6 +109,21 @@ MakeObjectVectorAccessor (U T::*memberVector)
       // quiet compiler.
       return 0;
     }
+    virtual bool DoGetAll (const ObjectBase *object, std::map<std::size_t, Ptr<Object> > *objects) const {
+      const T *obj = dynamic_cast<const T *> (object);
+      if (obj == 0)
+        {
+          return false;
+        }
+      typename U::const_iterator begin = (obj->*m_memberVector).begin ();
+      typename U::const_iterator end = (obj->*m_memberVector).end ();
+      std::size_t k = 0;
+      for (typename U::const_iterator j = begin; j != end; j++, k++)
+        {
+          objects->emplace_hint (objects->end (), k, *j)->second = *j;
+        }
+      return true;
+    }
     U T::*m_memberVector;
   } *spec = new MemberStdContainer ();
   spec->m_memberVector = memberVector;
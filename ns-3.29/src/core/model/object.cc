@@ -97,17 +97,22 @@ Object::Object ()
   : m_tid (Object::GetTypeId ()),
     m_disposed (false),
     m_initialized (false),
-    m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates))),
-    m_getObjectCount (0)
+    m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates)))
 {
   NS_LOG_FUNCTION (this);
   m_aggregates->n = 1;
+  m_aggregates->mask = 0;
+  m_aggregates->table = 0;
   m_aggregates->buffer[0] = this;
 }
 Object::~Object () 
 {
   // remove this object from the aggregate list
   NS_LOG_FUNCTION (this);
+  // the aggregate is going away: fall back to the linear lookup
+  // for the remaining objects.
+  std::free (m_aggregates->table);
+  m_aggregates->table = 0;
   uint32_t n = m_aggregates->n;
   for (uint32_t i = 0; i < n; i++)
     {
@@ -132,10 +137,11 @@ Object::Object (const Object &o)
   : m_tid (o.m_tid),
     m_disposed (false),
     m_initialized (false),
-    m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates))),
-    m_getObjectCount (0)
+    m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates)))
 {
   m_aggregates->n = 1;
+  m_aggregates->mask = 0;
+  m_aggregates->table = 0;
   m_aggregates->buffer[0] = this;
 }
 void
@@ -151,11 +157,28 @@ Object::DoGetObject (TypeId tid) const
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (CheckLoose ());
 
-  uint32_t n = m_aggregates->n;
+  const struct Aggregates *aggregates = m_aggregates;
+  if (aggregates->table != 0)
+    {
+      uint16_t uid = tid.GetUid ();
+      for (uint32_t i = uid & aggregates->mask;
+           aggregates->table[i].uid != 0;
+           i = (i + 1) & aggregates->mask)
+        {
+          if (aggregates->table[i].uid == uid)
+            {
+              return aggregates->table[i].object;
+            }
+        }
+      return 0;
+    }
+
+  // not aggregated: walk up the TypeId of this object.
+  uint32_t n = aggregates->n;
   TypeId objectTid = Object::GetTypeId ();
   for (uint32_t i = 0; i < n; i++)
     {
-      Object *current = m_aggregates->buffer[i];
+      Object *current = aggregates->buffer[i];
       TypeId cur = current->GetInstanceTypeId ();
       while (cur != tid && cur != objectTid)
         {
@@ -163,18 +186,7 @@ Object::DoGetObject (TypeId tid) const
         }
       if (cur == tid)
         {
-          // This is an attempt to 'cache' the result of this lookup.
-          // the idea is that if we perform a lookup for a TypeId on this object,
-          // we are likely to perform the same lookup later so, we make sure
-          // that the aggregate array is sorted by the number of accesses
-          // to each object.
-
-          // first, increment the access count
-          current->m_getObjectCount++;
-          // then, update the sort
-          UpdateSortedArray (m_aggregates, i);
-          // finally, return the match
-          return const_cast<Object *> (current);
+          return current;
         }
     }
   return 0;
@@ -236,16 +248,54 @@ restart:
     }
 }
 void
-Object::UpdateSortedArray (struct Aggregates *aggregates, uint32_t j) const
+Object::BuildTable (struct Aggregates *aggregates)
 {
-  NS_LOG_FUNCTION (this << aggregates << j);
-  while (j > 0 && 
-         aggregates->buffer[j]->m_getObjectCount > aggregates->buffer[j-1]->m_getObjectCount)
+  NS_LOG_FUNCTION (aggregates);
+  TypeId objectTid = Object::GetTypeId ();
+  uint32_t entries = 0;
+  for (uint32_t i = 0; i < aggregates->n; i++)
+    {
+      TypeId cur = aggregates->buffer[i]->GetInstanceTypeId ();
+      entries++;
+      while (cur != objectTid)
+        {
+          cur = cur.GetParent ();
+          entries++;
+        }
+    }
+
+  // keep the table at most half full so that probe sequences stay short.
+  uint32_t size = 1;
+  while (size < 2 * entries)
+    {
+      size <<= 1;
+    }
+  aggregates->mask = size - 1;
+  aggregates->table = (struct Aggregates::Slot *) std::calloc (size, sizeof (struct Aggregates::Slot));
+
+  for (uint32_t i = 0; i < aggregates->n; i++)
     {
-      Object *tmp = aggregates->buffer[j-1];
-      aggregates->buffer[j-1] = aggregates->buffer[j];
-      aggregates->buffer[j] = tmp;
-      j--;
+      Object *current = aggregates->buffer[i];
+      TypeId cur = current->GetInstanceTypeId ();
+      while (true)
+        {
+          uint16_t uid = cur.GetUid ();
+          uint32_t j = uid & aggregates->mask;
+          while (aggregates->table[j].uid != 0 && aggregates->table[j].uid != uid)
+            {
+              j = (j + 1) & aggregates->mask;
+            }
+          if (aggregates->table[j].uid == 0)
+            {
+              aggregates->table[j].uid = uid;
+              aggregates->table[j].object = current;
+            }
+          if (cur == objectTid)
+            {
+              break;
+            }
+          cur = cur.GetParent ();
+        }
     }
 }
 void 
@@ -263,6 +313,7 @@ Object::AggregateObject (Ptr<Object> o)
   struct Aggregates *aggregates = 
     (struct Aggregates *)std::malloc (sizeof(struct Aggregates)+(total-1)*sizeof(Object*));
   aggregates->n = total;
+  aggregates->table = 0;
 
   // copy our buffer to the new buffer
   std::memcpy (&aggregates->buffer[0], 
@@ -281,8 +332,8 @@ Object::AggregateObject (Ptr<Object> o)
                           other->GetInstanceTypeId () <<
                           " on objects of type " << typeId);
         }
-      UpdateSortedArray (aggregates, m_aggregates->n + i);
     }
+  BuildTable (aggregates);
 
   // keep track of the old aggregate buffers for the iteration
   // of NotifyNewAggregates
@@ -314,7 +365,9 @@ Object::AggregateObject (Ptr<Object> o)
     }
 
   // Now that we are done with them, we can free our old aggregate buffers
+  std::free (a->table);
   std::free (a);
+  std::free (b->table);
   std::free (b);
 }
 /**
@@ -331,10 +331,27 @@ private:
    * chunk of memory than the struct to allow space for a larger
    * variable sized buffer whose size is indicated by the element
    * \c n
+   *
+   * Once several Objects are aggregated, \c table maps the uid of every
+   * TypeId an aggregated Object is an instance of (its own TypeId and
+   * those of its parents up to Object) to the first such Object in
+   * \c buffer.  The table is built by AggregateObject() and only read
+   * by DoGetObject(), so lookups are constant time and do not modify
+   * the aggregate.
    */
   struct Aggregates {
     /** The number of entries in \c buffer. */
     uint32_t n;
+    /** The size of \c table minus one; the size is a power of two. */
+    uint32_t mask;
+    /**
+     * Open addressing TypeId uid lookup table, or 0 when this Object
+     * is not aggregated.
+     */
+    struct Slot {
+      uint16_t uid;     //!< TypeId uid, 0 if the slot is empty.
+      Object *object;   //!< The first aggregated Object of that TypeId.
+    } *table;
     /** The array of Objects. */
     Object *buffer[1];
   };
@@ -387,12 +404,14 @@ private:
   void Construct (const AttributeConstructionList &attributes);
 
   /**
-   * Keep the list of aggregates in most-recently-used order
+   * Build the TypeId lookup table of a list of aggregates.
+   *
+   * When several aggregated Objects are instances of the same TypeId
+   * (typically a common parent), the first one in the list wins.
    *
    * \param [in,out] aggregates The list of aggregated Objects.
-   * \param [in] i The most recently used entry in the list.
    */
-  void UpdateSortedArray (struct Aggregates *aggregates, uint32_t i) const;
+  static void BuildTable (struct Aggregates *aggregates);
   /**
    * Attempt to delete this Object.
    *
@@ -424,14 +443,6 @@ private:
    * so the size of the array is indirectly a reference count.
    */
   struct Aggregates * m_aggregates;
-  /**
-   * The number of times the Object was accessed with a
-   * call to GetObject().
-   *
-   * This integer is used to implement a heuristic to sort
-   * the array of aggregates in most-frequently accessed order.
-   */
-  uint32_t m_getObjectCount;
 };
 
 template <typename T>
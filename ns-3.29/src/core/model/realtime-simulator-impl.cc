@@ -89,6 +89,7 @@ RealtimeSimulatorImpl::RealtimeSimulatorImpl ()
   m_currentUid = 0;
   m_currentTs = 0;
   m_currentContext = Simulator::NO_CONTEXT;
+  m_eventCount = 0;
   m_unscheduledEvents = 0;
 
   m_main = SystemThread::Self();
@@ -348,6 +349,7 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
     //
     m_currentTs = next.key.m_ts;
     m_currentContext = next.key.m_context;
+    m_eventCount++;
     m_currentUid = next.key.m_uid;
 
     // 
@@ -817,6 +819,18 @@ RealtimeSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint64_t
+RealtimeSimulatorImpl::GetEventCount (void) const
+{
+  return m_eventCount;
+}
+
+uint64_t
+RealtimeSimulatorImpl::GetPendingEventCount (void) const
+{
+  return m_unscheduledEvents;
+}
+
 void 
 RealtimeSimulatorImpl::SetSynchronizationMode (enum SynchronizationMode mode)
 {
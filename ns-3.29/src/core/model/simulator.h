@@ -184,6 +184,29 @@ public:
    */
   static uint32_t GetContext (void);
 
+  /**
+   * Get the number of events executed so far.
+   *
+   * The count is kept in every build profile, including those which
+   * compile out logging and assertions, so it can be used to report
+   * the event rate of a simulation.
+   *
+   * \returns The number of events executed since the simulator
+   *          implementation was created.
+   */
+  static uint64_t GetEventCount (void);
+
+  /**
+   * Get the number of events scheduled and not yet run.
+   *
+   * Cancelled events which have not reached the head of the event list
+   * are included, and the events scheduled with Simulator::ScheduleDestroy
+   * are not.
+   *
+   * \returns The number of events in the event list.
+   */
+  static uint64_t GetPendingEventCount (void);
+
   /**
    * Context enum values.
    *
@@ -73,6 +73,9 @@ BuildProfileTestCase::DoRun (void)
 #elif NS3_BUILD_PROFILE_OPTIMIZED
   std::cout << GetName () << ": running in build profile optimized" << std::endl;
   NS_BUILD_OPTIMIZED (++i; ++j);
+#elif NS3_BUILD_PROFILE_PRODUCTION
+  std::cout << GetName () << ": running in build profile production" << std::endl;
+  NS_BUILD_PRODUCTION (++i; ++j);
 #else
   NS_TEST_ASSERT_MSG_EQ (0, 1, ": no build profile case executed");
 #endif
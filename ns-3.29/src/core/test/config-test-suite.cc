@@ -830,6 +830,124 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test for Config::CompiledPath, which is parsed once and resolved
+ * many times.
+ */
+class CompiledPathConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  CompiledPathConfigTestCase ();
+  /** Destructor. */
+  virtual ~CompiledPathConfigTestCase () {}
+
+  /**
+   * Trace callback with context path.
+   * \param path The context path.
+   * \param old The old value.
+   * \param newValue The new value.
+   */
+  void TraceWithPath (std::string path, int16_t old, int16_t newValue)
+  {
+    NS_UNUSED (old);
+    m_newValue = newValue;
+    m_path = path;
+  }
+
+private:
+  virtual void DoRun (void);
+
+  int16_t m_newValue; //!< Flag to detect tracing result.
+  std::string m_path; //!< The context path.
+};
+
+CompiledPathConfigTestCase::CompiledPathConfigTestCase ()
+  : TestCase ("Check that a CompiledPath matches like the Config functions")
+{
+}
+
+void
+CompiledPathConfigTestCase::DoRun (void)
+{
+  IntegerValue iv;
+
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  root->SetNodeA (a);
+
+  //
+  // Enough objects that the index specifications below select fewer
+  // entries than the vector holds.
+  //
+  std::vector<Ptr<ConfigTestObject> > objects;
+  for (uint32_t i = 0; i < 20; ++i)
+    {
+      objects.push_back (CreateObject<ConfigTestObject> ());
+      a->AddNodeA (objects.back ());
+      objects.back ()->AddNodeB (CreateObject<DerivedConfigTestObject> ());
+    }
+
+  Config::CompiledPath all ("/NodeA/NodesA/*");
+  Config::MatchContainer matches = all.LookupMatches ();
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 20, "Wrong number of matches for *");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (7), objects[7], "Matches not in index order");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (7), "/NodeA/NodesA/7/", "Wrong matched path");
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/NodeA/NodesA/*").GetN (), 20,
+                         "Config::LookupMatches disagrees with CompiledPath");
+
+  Config::CompiledPath some ("/NodeA/NodesA/3|[10-12]|1|11/A");
+  some.Set (IntegerValue (-20));
+  for (uint32_t i = 0; i < objects.size (); ++i)
+    {
+      bool selected = i == 1 || i == 3 || (i >= 10 && i <= 12);
+      objects[i]->GetAttribute ("A", iv);
+      NS_TEST_ASSERT_MSG_EQ (iv.Get (), selected ? -20 : 10, "Wrong objects set for index " << i);
+    }
+
+  //
+  // A second resolution goes through the cached attributes and sees
+  // the objects added in the meantime.
+  //
+  Ptr<ConfigTestObject> last = CreateObject<ConfigTestObject> ();
+  a->AddNodeA (last);
+  NS_TEST_ASSERT_MSG_EQ (all.LookupMatches ().GetN (), 21, "Added object not matched");
+  Config::CompiledPath copy = some;
+  NS_TEST_ASSERT_MSG_EQ (copy.GetPath (), some.GetPath (), "Copy has a different path");
+  Config::CompiledPath ("/NodeA/NodesA/20/A").Set (IntegerValue (-21));
+  last->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -21, "Object added later not set");
+
+  //
+  // Trace connection through objects of a derived TypeId, with context.
+  //
+  Config::CompiledPath trace ("/NodeA/NodesA/[4-5]/NodesB/0/Source");
+  trace.Connect (MakeCallback (&CompiledPathConfigTestCase::TraceWithPath, this));
+  ObjectVectorValue nodesB;
+  objects[5]->GetAttribute ("NodesB", nodesB);
+  m_newValue = 0;
+  nodesB.Get (0)->SetAttribute ("Source", IntegerValue (-3));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, -3, "Trace did not fire");
+  NS_TEST_ASSERT_MSG_EQ (m_path, "/NodeA/NodesA/5/NodesB/0/Source", "Wrong trace context");
+
+  trace.Disconnect (MakeCallback (&CompiledPathConfigTestCase::TraceWithPath, this));
+  m_newValue = 0;
+  nodesB.Get (0)->SetAttribute ("Source", IntegerValue (-4));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, 0, "Trace fired after Disconnect");
+
+  //
+  // Indices out of range and unknown attributes match nothing.
+  //
+  NS_TEST_ASSERT_MSG_EQ (Config::CompiledPath ("/NodeA/NodesA/[30-40]").LookupMatches ().GetN (), 0,
+                         "Indices out of range matched");
+  NS_TEST_ASSERT_MSG_EQ (Config::CompiledPath ("/NodeA/NoSuchAttribute/*").LookupMatches ().GetN (), 0,
+                         "Unknown attribute matched");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -848,6 +966,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new CompiledPathConfigTestCase);
 }
 
 /**
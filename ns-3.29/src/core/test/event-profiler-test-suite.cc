@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/event-profiler.h"
+#include "ns3/make-event.h"
+#include "ns3/event-impl.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup simulator
+ * EventProfiler test suite.
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+
+/**
+ * \ingroup core-tests
+ * Event functions with distinct names.
+ */
+class EventProfilerTarget
+{
+public:
+  /** An event method. */
+  void Ping (void)
+  {
+  }
+  /** Another event method. */
+  void Pong (void)
+  {
+  }
+};
+
+/** An event function. */
+void
+EventProfilerTargetFunction (int)
+{
+}
+
+
+/**
+ * \ingroup core-tests
+ * Check the names and counts of the profile.
+ */
+class EventProfilerRecordTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  EventProfilerRecordTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+EventProfilerRecordTestCase::EventProfilerRecordTestCase ()
+  : TestCase ("Check the events recorded by EventProfiler")
+{
+}
+
+void
+EventProfilerRecordTestCase::DoRun (void)
+{
+  EventProfilerTarget target;
+  Ptr<EventImpl> ping = Ptr<EventImpl> (MakeEvent (&EventProfilerTarget::Ping, &target), false);
+  Ptr<EventImpl> pong = Ptr<EventImpl> (MakeEvent (&EventProfilerTarget::Pong, &target), false);
+  Ptr<EventImpl> function = Ptr<EventImpl> (MakeEvent (&EventProfilerTargetFunction, 1), false);
+
+  NS_TEST_ASSERT_MSG_EQ (EventProfiler::GetEventName (PeekPointer (ping)), "ns3::tests::EventProfilerTarget::Ping()",
+                         "Wrong name for a method event");
+  NS_TEST_ASSERT_MSG_EQ (EventProfiler::GetEventName (PeekPointer (function)), "ns3::tests::EventProfilerTargetFunction(int)",
+                         "Wrong name for a function event");
+
+  EventProfiler profiler;
+  profiler.SetSamplingPeriod (2);
+  uint32_t samples = 0;
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      samples += profiler.Sample ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (samples, 5, "Wrong sampling rate");
+
+  profiler.Record (PeekPointer (ping), 3, 1000000);
+  profiler.Record (PeekPointer (ping), 3, 1000000);
+  profiler.Record (PeekPointer (function), 0xffffffff, 500000);
+  pong->Cancel ();
+  profiler.Record (PeekPointer (pong), 7, 100000);
+  NS_TEST_ASSERT_MSG_EQ (profiler.GetSampleCount (), 4, "Wrong number of samples");
+
+  std::ostringstream oss;
+  profiler.Print (oss);
+  std::string profile = oss.str ();
+  // counts and times are scaled up by the sampling period
+  NS_TEST_EXPECT_MSG_NE (profile.find ("4.000           4          0   1000000  ns3::tests::EventProfilerTarget::Ping()"),
+                         std::string::npos, "Ping missing from the profile:\n" << profile);
+  NS_TEST_EXPECT_MSG_NE (profile.find ("0.200           2          2    100000  ns3::tests::EventProfilerTarget::Pong()"),
+                         std::string::npos, "Pong missing from the profile:\n" << profile);
+  NS_TEST_EXPECT_MSG_NE (profile.find ("1.000           2          0    500000  none"),
+                         std::string::npos, "Events without context missing from the profile:\n" << profile);
+  NS_TEST_EXPECT_MSG_NE (profile.find ("4.000           4          0   1000000  3\n"),
+                         std::string::npos, "Context 3 missing from the profile:\n" << profile);
+  NS_TEST_EXPECT_MSG_LT (profile.find ("Ping"), profile.find ("Pong"), "Profile not sorted by time");
+
+  profiler.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (profiler.GetSampleCount (), 0, "Samples left after Clear");
+}
+
+
+/**
+ * \ingroup core-tests
+ * Check that the simulator writes a profile at Destroy.
+ */
+class EventProfilerSimulatorTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  EventProfilerSimulatorTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+EventProfilerSimulatorTestCase::EventProfilerSimulatorTestCase ()
+  : TestCase ("Check the event profile of DefaultSimulatorImpl")
+{
+}
+
+void
+EventProfilerSimulatorTestCase::DoRun (void)
+{
+  std::string file = CreateTempDirFilename ("event-profile.txt");
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventProfilePeriod", UintegerValue (1));
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventProfileFile", StringValue (file));
+
+  EventProfilerTarget target;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      Simulator::Schedule (Seconds (i), &EventProfilerTarget::Ping, &target);
+      Simulator::ScheduleWithContext (5, Seconds (i), &EventProfilerTargetFunction, i);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  Config::Reset ();
+
+  std::ifstream is (file.c_str ());
+  std::stringstream profile;
+  profile << is.rdbuf ();
+  NS_TEST_EXPECT_MSG_NE (profile.str ().find ("EVENT PROFILE: 6 events timed, one out of 1"),
+                         std::string::npos, "Wrong event count:\n" << profile.str ());
+  NS_TEST_EXPECT_MSG_NE (profile.str ().find ("ns3::tests::EventProfilerTarget::Ping()"),
+                         std::string::npos, "Ping missing from the profile:\n" << profile.str ());
+  NS_TEST_EXPECT_MSG_NE (profile.str ().find ("ns3::tests::EventProfilerTargetFunction(int)"),
+                         std::string::npos, "Function missing from the profile:\n" << profile.str ());
+  std::remove (file.c_str ());
+}
+
+
+/**
+ * \ingroup core-tests
+ * EventProfiler test suite.
+ */
+class EventProfilerTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  EventProfilerTestSuite ();
+};
+
+EventProfilerTestSuite::EventProfilerTestSuite ()
+  : TestSuite ("event-profiler")
+{
+  AddTestCase (new EventProfilerRecordTestCase, TestCase::QUICK);
+  AddTestCase (new EventProfilerSimulatorTestCase, TestCase::QUICK);
+}
+
+/**
+ * \ingroup core-tests
+ * EventProfilerTestSuite instance variable.
+ */
+static EventProfilerTestSuite g_eventProfilerTestSuite;
+
+
+}  // namespace tests
+
+}  // namespace ns3
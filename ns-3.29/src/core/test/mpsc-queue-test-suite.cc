@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/mpsc-queue.h"
+#include "ns3/system-thread.h"
+
+#include <list>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup thread
+ * MpscQueue test suite.
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+
+/**
+ * \ingroup core-tests
+ * Single threaded FIFO order and bounded mode checks.
+ */
+class MpscQueueSingleThreadTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  MpscQueueSingleThreadTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MpscQueueSingleThreadTestCase::MpscQueueSingleThreadTestCase ()
+  : TestCase ("Check FIFO order and capacity of MpscQueue")
+{
+}
+
+void
+MpscQueueSingleThreadTestCase::DoRun (void)
+{
+  MpscQueue<int> queue;
+  NS_TEST_ASSERT_MSG_EQ (queue.IsEmpty (), true, "New queue not empty");
+
+  for (int i = 0; i < 10; ++i)
+    {
+      queue.Push (i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (queue.GetSize (), 10, "Wrong size");
+
+  std::vector<int> items;
+  std::size_t n = queue.Drain ([&items] (int i) { items.push_back (i); });
+  NS_TEST_ASSERT_MSG_EQ (n, 10, "Wrong number of items drained");
+  NS_TEST_ASSERT_MSG_EQ (queue.IsEmpty (), true, "Drained queue not empty");
+  NS_TEST_ASSERT_MSG_EQ (queue.GetSize (), 0, "Drained queue has a size");
+  for (int i = 0; i < 10; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (items[i], i, "Items not drained in FIFO order");
+    }
+
+  queue.SetCapacity (3);
+  NS_TEST_ASSERT_MSG_EQ (queue.TryPush (1), true, "Push into bounded queue failed");
+  NS_TEST_ASSERT_MSG_EQ (queue.TryPush (2), true, "Push into bounded queue failed");
+  NS_TEST_ASSERT_MSG_EQ (queue.TryPush (3), true, "Push into bounded queue failed");
+  NS_TEST_ASSERT_MSG_EQ (queue.TryPush (4), false, "Push into full queue succeeded");
+  queue.Drain ([] (int i) {});
+  NS_TEST_ASSERT_MSG_EQ (queue.TryPush (4), true, "Push into drained queue failed");
+}
+
+
+/**
+ * \ingroup core-tests
+ * Several producer threads push concurrently while the test drains.
+ */
+class MpscQueueMultiThreadTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] producers The number of producer threads.
+   * \param [in] capacity The queue capacity, 0 for unbounded.
+   */
+  MpscQueueMultiThreadTestCase (unsigned int producers, std::size_t capacity);
+
+private:
+  virtual void DoRun (void);
+
+  /** Item type: the producer and its sequence number. */
+  typedef std::pair<unsigned int, unsigned int> Item;
+
+  /**
+   * Producer thread body.
+   * \param [in] context The test case and the producer number.
+   */
+  static void Produce (std::pair<MpscQueueMultiThreadTestCase *, unsigned int> context);
+
+  unsigned int m_producers;    //!< Number of producer threads.
+  MpscQueue<Item> m_queue;     //!< The queue under test.
+
+  /** Number of items pushed by each producer. */
+  static const unsigned int ITEMS = 20000;
+};
+
+MpscQueueMultiThreadTestCase::MpscQueueMultiThreadTestCase (unsigned int producers, std::size_t capacity)
+  : TestCase ("Check MpscQueue with " + std::to_string (producers) +
+              " producers, capacity " + std::to_string (capacity)),
+    m_producers (producers),
+    m_queue (capacity)
+{
+}
+
+void
+MpscQueueMultiThreadTestCase::Produce (std::pair<MpscQueueMultiThreadTestCase *, unsigned int> context)
+{
+  for (unsigned int i = 0; i < ITEMS; ++i)
+    {
+      context.first->m_queue.Push (Item (context.second, i));
+    }
+}
+
+void
+MpscQueueMultiThreadTestCase::DoRun (void)
+{
+  std::list<Ptr<SystemThread> > threads;
+  for (unsigned int p = 0; p < m_producers; ++p)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (
+          MakeBoundCallback (&MpscQueueMultiThreadTestCase::Produce,
+                             std::pair<MpscQueueMultiThreadTestCase *, unsigned int> (this, p)));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+
+  std::vector<unsigned int> next (m_producers, 0);
+  std::size_t capacity = m_queue.GetCapacity ();
+  bool ordered = true;
+  bool bounded = true;
+  unsigned int total = 0;
+  while (total < m_producers * ITEMS)
+    {
+      if (capacity != 0 && m_queue.GetSize () > capacity)
+        {
+          bounded = false;
+        }
+      total += m_queue.Drain ([&next, &ordered] (const Item &item)
+        {
+          ordered = ordered && item.second == next[item.first];
+          next[item.first] = item.second + 1;
+        });
+    }
+
+  for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (ordered, true, "Items of a producer drained out of order");
+  NS_TEST_EXPECT_MSG_EQ (bounded, true, "Capacity exceeded");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.IsEmpty (), true, "Items left in the queue");
+  for (unsigned int p = 0; p < m_producers; ++p)
+    {
+      NS_TEST_EXPECT_MSG_EQ (next[p], ITEMS, "Items of producer " << p << " lost");
+    }
+}
+
+
+/**
+ * \ingroup core-tests
+ * MpscQueue test suite.
+ */
+class MpscQueueTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  MpscQueueTestSuite ();
+};
+
+MpscQueueTestSuite::MpscQueueTestSuite ()
+  : TestSuite ("mpsc-queue")
+{
+  AddTestCase (new MpscQueueSingleThreadTestCase, TestCase::QUICK);
+  AddTestCase (new MpscQueueMultiThreadTestCase (1, 0), TestCase::QUICK);
+  AddTestCase (new MpscQueueMultiThreadTestCase (4, 0), TestCase::QUICK);
+  AddTestCase (new MpscQueueMultiThreadTestCase (4, 1024), TestCase::QUICK);
+}
+
+/**
+ * \ingroup core-tests
+ * MpscQueueTestSuite instance variable.
+ */
+static MpscQueueTestSuite g_mpscQueueTestSuite;
+
+
+}  // namespace tests
+
+}  // namespace ns3
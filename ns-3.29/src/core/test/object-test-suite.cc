@@ -396,6 +396,26 @@ AggregateObjectTestCase::DoRun (void)
 
   baseA = baseB->GetObject<BaseA> ();
   NS_TEST_ASSERT_MSG_NE (baseA, 0, "Unable to GetObject on released object");
+
+  //
+  // Lookups through the aggregate must find every parent TypeId, and must
+  // not reorder the aggregate: the iterator keeps the aggregation order.
+  //
+  Ptr<DerivedA> derivedA = CreateObject<DerivedA> ();
+  Ptr<DerivedB> derivedB = CreateObject<DerivedB> ();
+  derivedA->AggregateObject (derivedB);
+  for (int i = 0; i < 3; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (derivedA->GetObject<DerivedB> (), derivedB, "GetObject<DerivedB> through the aggregate failed");
+      NS_TEST_ASSERT_MSG_EQ (derivedA->GetObject<BaseB> (), derivedB, "GetObject<BaseB> through the aggregate failed");
+      NS_TEST_ASSERT_MSG_EQ (derivedB->GetObject<BaseA> (), derivedA, "GetObject<BaseA> through the aggregate failed");
+      NS_TEST_ASSERT_MSG_EQ (baseB->GetObject<DerivedA> (), 0, "GetObject<DerivedA> through the aggregate is not null");
+      NS_TEST_ASSERT_MSG_EQ (derivedB->GetObject<Object> (), derivedA, "GetObject<Object> does not return the first aggregated Object");
+    }
+  Object::AggregateIterator iterator = derivedB->GetAggregateIterator ();
+  NS_TEST_ASSERT_MSG_EQ (iterator.Next (), derivedA, "GetObject reordered the aggregate");
+  NS_TEST_ASSERT_MSG_EQ (iterator.Next (), derivedB, "GetObject reordered the aggregate");
+  NS_TEST_ASSERT_MSG_EQ (iterator.HasNext (), false, "Unexpected Object in the aggregate");
 }
 
 /**
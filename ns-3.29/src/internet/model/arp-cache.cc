@@ -25,6 +25,7 @@
 #include "ns3/node.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/names.h"
+#include "ns3/memory-accounting.h"
 
 #include "arp-cache.h"
 #include "arp-header.h"
@@ -36,6 +37,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("ArpCache");
 
 NS_OBJECT_ENSURE_REGISTERED (ArpCache);
+NS_MEMORY_ACCOUNTANT (ArpCache);
 
 TypeId 
 ArpCache::GetTypeId (void)
@@ -84,6 +86,16 @@ ArpCache::GetTypeId (void)
   return tid;
 }
 
+void
+ArpCache::AccountMemory (Ptr<Object> object, MemoryAccounting &accounting)
+{
+  Ptr<ArpCache> cache = DynamicCast<ArpCache> (object);
+  uint64_t entries = cache->m_arpCache.size ();
+  accounting.Add ("ARP cache entries", entries * (sizeof (Cache::value_type) + sizeof (ArpCache::Entry)
+                                                  + MemoryAccounting::CONTAINER_NODE_OVERHEAD),
+                  entries);
+}
+
 ArpCache::ArpCache ()
   : m_device (0), 
     m_interface (0)
@@ -37,6 +37,7 @@
 
 namespace ns3 {
 
+class MemoryAccounting;
 class NetDevice;
 class Ipv4Interface;
 class Ipv4Header;
@@ -71,6 +72,12 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+  /**
+   * \brief Account the entries of a cache, see MemoryAccounting
+   * \param object the cache
+   * \param accounting the accounting to add to
+   */
+  static void AccountMemory (Ptr<Object> object, MemoryAccounting &accounting);
   class Entry;
   ArpCache ();
   ~ArpCache ();
@@ -473,4 +473,33 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
   return GetSerializedSize ();
 }
 
+Header *
+Ipv4Header::Copy (void) const
+{
+  return new Ipv4Header (*this);
+}
+
+bool
+Ipv4Header::Assign (const Header &header)
+{
+  const Ipv4Header &other = static_cast<const Ipv4Header &> (header);
+  if (m_calcChecksum || other.m_calcChecksum)
+    {
+      // the checksum field is only known once serialized
+      return false;
+    }
+  m_tos = other.m_tos;
+  m_payloadSize = other.m_payloadSize;
+  m_identification = other.m_identification;
+  m_flags = other.m_flags;
+  m_fragmentOffset = other.m_fragmentOffset;
+  m_ttl = other.m_ttl;
+  m_protocol = other.m_protocol;
+  m_checksum = 0;
+  m_source = other.m_source;
+  m_destination = other.m_destination;
+  m_headerSize = 5*4;
+  return true;
+}
+
 } // namespace ns3
@@ -33,6 +33,8 @@
 #include "ns3/boolean.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/segment-offload-tag.h"
+#include "ns3/memory-accounting.h"
 
 #include "loopback-net-device.h"
 #include "arp-l3-protocol.h"
@@ -49,6 +51,7 @@ NS_LOG_COMPONENT_DEFINE ("Ipv4L3Protocol");
 const uint16_t Ipv4L3Protocol::PROT_NUMBER = 0x0800;
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4L3Protocol);
+NS_MEMORY_ACCOUNTANT (Ipv4L3Protocol);
 
 TypeId 
 Ipv4L3Protocol::GetTypeId (void)
@@ -107,6 +110,13 @@ Ipv4L3Protocol::GetTypeId (void)
   return tid;
 }
 
+void
+Ipv4L3Protocol::AccountMemory (Ptr<Object> object, MemoryAccounting &accounting)
+{
+  Ptr<Ipv4L3Protocol> ipv4 = DynamicCast<Ipv4L3Protocol> (object);
+  accounting.Visit (ipv4->m_routingProtocol);
+}
+
 Ipv4L3Protocol::Ipv4L3Protocol()
 {
   NS_LOG_FUNCTION (this);
@@ -930,7 +940,8 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to gateway " << route->GetGateway ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu ()
+               && !IsSegmentOffload (packet) )
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -957,7 +968,8 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to destination " << ipHeader.GetDestination ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu ()
+               && !IsSegmentOffload (packet) )
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -982,6 +994,13 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
     }
 }
 
+bool
+Ipv4L3Protocol::IsSegmentOffload (Ptr<const Packet> packet) const
+{
+  SegmentOffloadTag tag;
+  return packet->PeekPacketTag (tag);
+}
+
 // This function analogous to Linux ip_mr_forward()
 void
 Ipv4L3Protocol::IpMulticastForward (Ptr<Ipv4MulticastRoute> mrtentry, Ptr<const Packet> p, const Ipv4Header &header)
@@ -39,6 +39,7 @@ class Ipv4L3ProtocolTestCase;
 
 namespace ns3 {
 
+class MemoryAccounting;
 class Packet;
 class NetDevice;
 class Ipv4Interface;
@@ -85,6 +86,12 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+  /**
+   * \brief Account the routing protocol, which is not an attribute, see MemoryAccounting
+   * \param object the protocol
+   * \param accounting the accounting to add to
+   */
+  static void AccountMemory (Ptr<Object> object, MemoryAccounting &accounting);
   static const uint16_t PROT_NUMBER; //!< Protocol number (0x0800)
 
   Ipv4L3Protocol();
@@ -405,6 +412,13 @@ private:
    */
   void DoFragmentation (Ptr<Packet> packet, const Ipv4Header& ipv4Header, uint32_t outIfaceMtu, std::list<Ipv4PayloadHeaderPair>& listFragments);
 
+  /**
+   * \brief Check if a packet is a TCP super-segment to be sent unfragmented
+   * \param packet the packet
+   * \returns true if the packet carries a SegmentOffloadTag
+   */
+  bool IsSegmentOffload (Ptr<const Packet> packet) const;
+
   /**
    * \brief Process a packet fragment
    * \param packet the packet
@@ -22,6 +22,7 @@
 #include "ns3/ipv4-route.h"
 #include "ns3/node.h"
 #include "ns3/ipv4-static-routing.h"
+#include "ns3/memory-accounting.h"
 #include "ipv4-list-routing.h"
 
 namespace ns3 {
@@ -29,6 +30,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Ipv4ListRouting");
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4ListRouting);
+NS_MEMORY_ACCOUNTANT (Ipv4ListRouting);
 
 TypeId
 Ipv4ListRouting::GetTypeId (void)
@@ -41,6 +43,17 @@ Ipv4ListRouting::GetTypeId (void)
   return tid;
 }
 
+void
+Ipv4ListRouting::AccountMemory (Ptr<Object> object, MemoryAccounting &accounting)
+{
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (object);
+  for (Ipv4RoutingProtocolList::const_iterator it = list->m_routingProtocols.begin ();
+       it != list->m_routingProtocols.end (); ++it)
+    {
+      accounting.Visit (it->second);
+    }
+}
+
 
 Ipv4ListRouting::Ipv4ListRouting () 
   : m_ipv4 (0)
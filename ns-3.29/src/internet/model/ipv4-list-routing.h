@@ -26,6 +26,8 @@
 
 namespace ns3 {
 
+class MemoryAccounting;
+
 /**
  * \ingroup ipv4Routing
  *
@@ -49,6 +51,12 @@ public:
    * \return type ID
    */
   static TypeId GetTypeId (void);
+  /**
+   * \brief Account the routing protocols of the list, see MemoryAccounting
+   * \param object the list
+   * \param accounting the accounting to add to
+   */
+  static void AccountMemory (Ptr<Object> object, MemoryAccounting &accounting);
 
   Ipv4ListRouting ();
   virtual ~Ipv4ListRouting ();
@@ -228,36 +228,41 @@ TcpHeader::CalculateHeaderChecksum (uint16_t size) const
   /* Zero                   3 bytes                                        */
   /* Next header            1 byte                                         */
 
-  uint32_t maxHdrSz = (2 * Address::MAX_SIZE) + 8;
-  Buffer buf = Buffer (maxHdrSz);
-  buf.AddAtStart (maxHdrSz);
-  Buffer::Iterator it = buf.Begin ();
-  uint32_t hdrSize = 0;
-
-  WriteTo (it, m_source);
-  WriteTo (it, m_destination);
+  uint8_t buf[(2 * Address::MAX_SIZE) + 8];
+  uint32_t hdrSize = m_source.CopyTo (buf);
+  hdrSize += m_destination.CopyTo (buf + hdrSize);
   if (Ipv4Address::IsMatchingType (m_source))
     {
-      it.WriteU8 (0); /* protocol */
-      it.WriteU8 (m_protocol); /* protocol */
-      it.WriteU8 (size >> 8); /* length */
-      it.WriteU8 (size & 0xff); /* length */
-      hdrSize = 12;
+      buf[hdrSize++] = 0; /* protocol */
+      buf[hdrSize++] = m_protocol; /* protocol */
+      buf[hdrSize++] = size >> 8; /* length */
+      buf[hdrSize++] = size & 0xff; /* length */
     }
   else
     {
-      it.WriteU16 (0);
-      it.WriteU8 (size >> 8); /* length */
-      it.WriteU8 (size & 0xff); /* length */
-      it.WriteU16 (0);
-      it.WriteU8 (0);
-      it.WriteU8 (m_protocol); /* protocol */
-      hdrSize = 40;
+      buf[hdrSize++] = 0;
+      buf[hdrSize++] = 0;
+      buf[hdrSize++] = size >> 8; /* length */
+      buf[hdrSize++] = size & 0xff; /* length */
+      buf[hdrSize++] = 0;
+      buf[hdrSize++] = 0;
+      buf[hdrSize++] = 0;
+      buf[hdrSize++] = m_protocol; /* protocol */
     }
 
-  it = buf.Begin ();
+  /* Sum the 16-bit words in the order of Buffer::Iterator::ReadU16, without
+   * going through a temporary Buffer; the pseudo-header size is even. */
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < hdrSize; i += 2)
+    {
+      sum += buf[i] | (buf[i + 1] << 8);
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
   /* we don't CompleteChecksum ( ~ ) now */
-  return ~(it.CalculateIpChecksum (hdrSize));
+  return sum;
 }
 
 bool
@@ -441,6 +446,42 @@ TcpHeader::Deserialize (Buffer::Iterator start)
   return GetSerializedSize ();
 }
 
+Header *
+TcpHeader::Copy (void) const
+{
+  return new TcpHeader (*this);
+}
+
+bool
+TcpHeader::Assign (const Header &header)
+{
+  const TcpHeader &other = static_cast<const TcpHeader &> (header);
+  if (m_calcChecksum || other.m_calcChecksum)
+    {
+      // the checksum covers the pseudo-header and the payload
+      return false;
+    }
+  m_sourcePort = other.m_sourcePort;
+  m_destinationPort = other.m_destinationPort;
+  m_sequenceNumber = other.m_sequenceNumber;
+  m_ackNumber = other.m_ackNumber;
+  m_flags = other.m_flags;
+  m_length = other.GetLength ();
+  m_windowSize = other.m_windowSize;
+  m_urgentPointer = other.m_urgentPointer;
+
+  // Deserialize reads the first padding byte as an END option and
+  // counts the rest of the padding in the options length
+  m_options = other.m_options;
+  m_optionsLen = other.m_optionsLen;
+  if (m_optionsLen % 4)
+    {
+      m_options.push_back (TcpOption::CreateOption (TcpOption::END));
+      m_optionsLen += 4 - m_optionsLen % 4;
+    }
+  return true;
+}
+
 uint8_t
 TcpHeader::CalculateHeaderLength () const
 {
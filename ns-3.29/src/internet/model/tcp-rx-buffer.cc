@@ -20,6 +20,7 @@
 
 #include "ns3/packet.h"
 #include "ns3/log.h"
+#include "ns3/memory-accounting.h"
 #include "tcp-rx-buffer.h"
 
 namespace ns3 {
@@ -27,6 +28,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("TcpRxBuffer");
 
 NS_OBJECT_ENSURE_REGISTERED (TcpRxBuffer);
+NS_MEMORY_ACCOUNTANT (TcpRxBuffer);
 
 TypeId
 TcpRxBuffer::GetTypeId (void)
@@ -43,6 +45,16 @@ TcpRxBuffer::GetTypeId (void)
   return tid;
 }
 
+void
+TcpRxBuffer::AccountMemory (Ptr<Object> object, MemoryAccounting &accounting)
+{
+  Ptr<TcpRxBuffer> buffer = DynamicCast<TcpRxBuffer> (object);
+  uint64_t items = buffer->m_data.size ();
+  accounting.Add ("TCP rx buffer data", buffer->m_size + items * (sizeof (std::pair<SequenceNumber32, Ptr<Packet> >) + sizeof (Packet)
+                                                                  + MemoryAccounting::CONTAINER_NODE_OVERHEAD),
+                  items);
+}
+
 /* A user is supposed to create a TcpSocket through a factory. In TcpSocket,
  * there are attributes SndBufSize and RcvBufSize to control the default Tx and
  * Rx window sizes respectively, with default of 128 KiByte. The attribute
@@ -30,6 +30,8 @@
 #include "ns3/tcp-option-sack.h"
 
 namespace ns3 {
+
+class MemoryAccounting;
 class Packet;
 
 /**
@@ -78,6 +80,12 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+  /**
+   * \brief Account the data held by a buffer, see MemoryAccounting
+   * \param object the buffer
+   * \param accounting the accounting to add to
+   */
+  static void AccountMemory (Ptr<Object> object, MemoryAccounting &accounting);
   /**
    * \brief Constructor
    * \param n initial Sequence number to be received
@@ -43,6 +43,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/data-rate.h"
 #include "ns3/object.h"
+#include "ns3/segment-offload-tag.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
 #include "ipv4-end-point.h"
@@ -141,6 +142,13 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("SegmentOffload",
+                   "Maximum size of the payload sent at once as a single super-segment "
+                   "standing for several segments (TSO/GRO emulation), 0 to disable. "
+                   "Only done over IPv4 and in the CA_OPEN state",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&TcpSocketBase::m_segmentOffload),
+                   MakeUintegerChecker<uint32_t> (0, 65000))
     .AddAttribute ("EcnMode", "Determines the mode of ECN",
                    EnumValue (EcnMode_t::NoEcn),
                    MakeEnumAccessor (&TcpSocketBase::m_ecnMode),
@@ -329,6 +337,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_recover (sock.m_recover),
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
+    m_segmentOffload (sock.m_segmentOffload),
     m_isFirstPartialAck (sock.m_isFirstPartialAck),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace),
@@ -692,6 +701,113 @@ TcpSocketBase::Connect (const Address & address)
   return DoConnect ();
 }
 
+int
+TcpSocketBase::ConnectEstablished (Ptr<TcpSocketBase> peer, const Address &address)
+{
+  NS_LOG_FUNCTION (this << peer << address);
+
+  if (!InetSocketAddress::IsMatchingType (address) || m_state != CLOSED || peer->m_state != CLOSED)
+    {
+      m_errno = ERROR_INVAL;
+      return -1;
+    }
+
+  // Set up our endpoint as Connect() does
+  if (m_endPoint == nullptr && Bind () == -1)
+    {
+      return -1;
+    }
+  InetSocketAddress transport = InetSocketAddress::ConvertFrom (address);
+  m_endPoint->SetPeer (transport.GetIpv4 (), transport.GetPort ());
+  SetIpTos (transport.GetTos ());
+  m_endPoint6 = nullptr;
+  if (SetupEndpoint () != 0)
+    {
+      NS_LOG_ERROR ("Route to destination does not exist ?!");
+      return -1;
+    }
+
+  // and the endpoint of the peer as CompleteFork() does
+  peer->m_endPoint = peer->m_tcp->Allocate (peer->GetBoundNetDevice (),
+                                            transport.GetIpv4 (), transport.GetPort (),
+                                            m_endPoint->GetLocalAddress (), m_endPoint->GetLocalPort ());
+  if (peer->m_endPoint == nullptr)
+    {
+      m_errno = ERROR_ADDRINUSE;
+      DeallocateEndPoint ();
+      return -1;
+    }
+  peer->m_endPoint6 = nullptr;
+  peer->m_tcp->AddSocket (peer);
+  peer->SetupCallback ();
+
+  // Negotiate the options carried by the SYN and SYN+ACK segments
+  bool winScaling = m_winScalingEnabled && peer->m_winScalingEnabled;
+  bool sack = m_sackEnabled && peer->m_sackEnabled;
+  bool timestamp = m_timestampEnabled && peer->m_timestampEnabled;
+  bool ecn = m_ecnMode == EcnMode_t::ClassicEcn && peer->m_ecnMode == EcnMode_t::ClassicEcn;
+  uint32_t now = TcpOptionTS::NowToTsValue ();
+  Ptr<TcpSocketBase> sides[2] = { this, peer };
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      Ptr<TcpSocketBase> sock = sides[i];
+      sock->m_winScalingEnabled = winScaling;
+      sock->m_sackEnabled = sack;
+      sock->m_timestampEnabled = timestamp;
+      if (winScaling)
+        {
+          sock->m_rcvWindShift = sock->CalculateWScale ();
+        }
+      if (timestamp)
+        {
+          sock->m_tcb->m_rcvTimestampValue = now;
+          sock->m_tcb->m_rcvTimestampEchoReply = now;
+          sock->m_timestampToEcho = now;
+        }
+      sock->m_tcb->m_ecnState = ecn ? TcpSocketState::ECN_IDLE : TcpSocketState::ECN_DISABLED;
+    }
+  if (winScaling)
+    {
+      m_sndWindShift = peer->m_rcvWindShift;
+      peer->m_sndWindShift = m_rcvWindShift;
+    }
+  // The window of the SYN+ACK is not scaled, that of the final ACK is
+  m_rWnd = peer->AdvertisedWindowSize (false);
+  peer->m_rWnd = static_cast<uint32_t> (AdvertisedWindowSize ()) << peer->m_sndWindShift;
+
+  // Both SYNs are acknowledged
+  SequenceNumber32 isn[2] = { m_tcb->m_nextTxSequence, peer->m_tcb->m_nextTxSequence };
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      Ptr<TcpSocketBase> sock = sides[i];
+      sock->m_rtt->Reset ();
+      // RFC 6298, clause 2.1, as set when sending the SYN
+      sock->m_rto = Max (sock->m_rtt->GetEstimate () + Max (sock->m_clockGranularity, sock->m_rtt->GetVariation () * 4),
+                         sock->m_minRto);
+      sock->m_synCount = sock->m_synRetries;
+      sock->m_dataRetrCount = sock->m_dataRetries;
+      sock->m_tcb->m_cWnd = sock->GetInitialCwnd () * sock->GetSegSize ();
+      sock->m_tcb->m_cWndInfl = sock->m_tcb->m_cWnd;
+      sock->m_tcb->m_ssThresh = sock->GetInitialSSThresh ();
+      sock->m_rxBuffer->SetNextRxSequence (isn[1 - i] + SequenceNumber32 (1));
+      sock->m_tcb->m_highTxMark = ++sock->m_tcb->m_nextTxSequence;
+      sock->m_txBuffer->SetHeadSequence (sock->m_tcb->m_nextTxSequence);
+      sock->m_highRxAckMark = sock->m_tcb->m_nextTxSequence;
+      sock->m_highTxAck = sock->m_rxBuffer->NextRxSequence ();
+      sock->m_congestionControl->CongestionStateSet (sock->m_tcb, TcpSocketState::CA_OPEN);
+      NS_LOG_DEBUG (TcpStateName[sock->m_state] << " -> ESTABLISHED");
+      sock->m_state = ESTABLISHED;
+      sock->m_connected = true;
+      // Always respond to first data packet to speed up the connection.
+      sock->m_delAckCount = sock->m_delAckMaxCount;
+    }
+
+  Simulator::ScheduleNow (&TcpSocketBase::ConnectionSucceeded, this);
+  peer->NotifyNewConnectionCreated (peer, InetSocketAddress (m_endPoint->GetLocalAddress (),
+                                                             m_endPoint->GetLocalPort ()));
+  return 0;
+}
+
 /* Inherit from Socket class: Listen on the endpoint for an incoming connection */
 int
 TcpSocketBase::Listen (void)
@@ -1873,7 +1989,7 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
       else if (ackNumber < m_recover && m_tcb->m_congState == TcpSocketState::CA_LOSS)
         {
           m_congestionControl->PktsAcked (m_tcb, segsAcked, m_tcb->m_lastRtt);
-          m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+          IncreaseWindow (segsAcked);
 
           NS_LOG_DEBUG (" Cong Control Called, cWnd=" << m_tcb->m_cWnd <<
                         " ssTh=" << m_tcb->m_ssThresh);
@@ -1966,7 +2082,7 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
             }
           else
             {
-              m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+              IncreaseWindow (segsAcked);
 
               m_tcb->m_cWndInfl = m_tcb->m_cWnd;
 
@@ -2485,7 +2601,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
 
   header.SetFlags (flags);
   header.SetSequenceNumber (s);
-  header.SetAckNumber (m_rxBuffer->NextRxSequence ());
+  header.SetAckNumber (m_rxBuffer->NextRxSequence () - m_ackHeldBack);
   if (m_endPoint != nullptr)
     {
       header.SetSourcePort (m_endPoint->GetLocalPort ());
@@ -2842,6 +2958,12 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
 
   Ptr<Packet> p = m_txBuffer->CopyFromSequence (maxSize, seq);
   uint32_t sz = p->GetSize (); // Size of packet
+  if (sz > m_tcb->m_segmentSize)
+    {
+      // A super-segment: tell the devices how many segments it stands for
+      uint32_t segments = (sz + m_tcb->m_segmentSize - 1) / m_tcb->m_segmentSize;
+      p->AddPacketTag (SegmentOffloadTag (segments, sz));
+    }
   uint8_t flags = withAck ? TcpHeader::ACK : 0;
   uint32_t remainingData = m_txBuffer->SizeFromSequence (seq + SequenceNumber32 (sz));
 
@@ -2967,6 +3089,22 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   return sz;
 }
 
+void
+TcpSocketBase::IncreaseWindow (uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << segmentsAcked);
+  if (m_segmentOffload > 0)
+    {
+      uint32_t perAck = std::max<uint32_t> (m_delAckMaxCount, 1);
+      while (segmentsAcked > perAck)
+        {
+          m_congestionControl->IncreaseWindow (m_tcb, perAck);
+          segmentsAcked -= perAck;
+        }
+    }
+  m_congestionControl->IncreaseWindow (m_tcb, segmentsAcked);
+}
+
 void
 TcpSocketBase::UpdateRttHistory (const SequenceNumber32 &seq, uint32_t sz,
                                  bool isRetransmission)
@@ -3076,6 +3214,14 @@ TcpSocketBase::SendPendingData (bool withAck)
             }
 
           uint32_t s = std::min (availableWindow, m_tcb->m_segmentSize);
+          if (m_segmentOffload > m_tcb->m_segmentSize && m_endPoint != nullptr
+              && m_tcb->m_congState == TcpSocketState::CA_OPEN && !m_tcb->m_pacing)
+            {
+              // Segmentation offload: send all the full segments the window
+              // allows, up to m_segmentOffload bytes, as one super-segment
+              uint32_t segments = std::min (availableWindow, m_segmentOffload) / m_tcb->m_segmentSize;
+              s = std::max (s, segments * m_tcb->m_segmentSize);
+            }
 
           // (C.2) If any of the data octets sent in (C.1) are below HighData,
           //       HighRxt MUST be set to the highest sequence number of the
@@ -3230,6 +3376,14 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
   NS_LOG_DEBUG ("Data segment, seq=" << tcpHeader.GetSequenceNumber () <<
                 " pkt size=" << p->GetSize () );
 
+  // A super-segment counts as the segments it stands for for delayed ACKs
+  uint32_t segments = 1;
+  SegmentOffloadTag offloadTag;
+  if (p->RemovePacketTag (offloadTag))
+    {
+      segments = offloadTag.GetSegments ();
+    }
+
   // Put into Rx buffer
   SequenceNumber32 expectedSeq = m_rxBuffer->NextRxSequence ();
   if (!m_rxBuffer->Add (p, tcpHeader))
@@ -3283,9 +3437,15 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
     }
   else
     { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+      m_delAckCount += segments;
+      if (m_delAckCount >= m_delAckMaxCount)
         {
           m_delAckEvent.Cancel ();
+          // The segments of a super-segment after the last multiple of the
+          // delayed ACK count would have waited for the delayed ACK: leave
+          // them out of this ACK and start the timer for them
+          uint32_t pending = segments > 1 ? m_delAckCount % std::max<uint32_t> (m_delAckMaxCount, 1) : 0;
+          m_ackHeldBack = pending > 0 ? p->GetSize () - (segments - pending) * m_tcb->m_segmentSize : 0;
           m_delAckCount = 0;
           m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_NON_DELAYED_ACK);
           if (m_tcb->m_ecnState == TcpSocketState::ECN_CE_RCVD || m_tcb->m_ecnState == TcpSocketState::ECN_SENDING_ECE)
@@ -3299,6 +3459,13 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
             {
               SendEmptyPacket (TcpHeader::ACK);
             }
+          if (pending > 0)
+            {
+              m_ackHeldBack = 0;
+              m_delAckCount = pending;
+              m_delAckEvent = Simulator::Schedule (m_delAckTimeout,
+                                                   &TcpSocketBase::DelAckTimeout, this);
+            }
         }
       else if (m_delAckEvent.IsExpired ())
         {
@@ -536,6 +536,28 @@ public:
    */
   void SetEcn (EcnMode_t ecnMode);
 
+  /**
+   * \brief Connect to a socket of the peer node without a handshake
+   *
+   * Puts this socket and \p peer, both new sockets, directly in the
+   * ESTABLISHED state a three way handshake would have left them in:
+   * the endpoints are registered with the demultiplexers of both nodes,
+   * the sequence numbers, windows and congestion state are initialized,
+   * and window scaling, timestamps, SACK and ECN are enabled on both
+   * sides when both of them have them enabled.  No packet is sent.
+   *
+   * This socket takes the role of the active opener, and is notified
+   * of the connection as if Connect had succeeded; \p peer takes the
+   * role of the socket a listener would have forked, and is notified
+   * as if it had accepted the connection.  As no segment has been
+   * timed, the RTT estimators start from their initial estimate.
+   *
+   * \param peer the socket on the other end
+   * \param address the address and port of \p peer
+   * \returns 0 on success, -1 on failure (errno set on this socket)
+   */
+  int ConnectEstablished (Ptr<TcpSocketBase> peer, const Address &address);
+
   // Necessary implementations of null functions from ns3::Socket
   virtual enum SocketErrno GetErrno (void) const;    // returns m_errno
   virtual enum SocketType GetSocketType (void) const; // returns socket type
@@ -1168,6 +1190,20 @@ protected:
    */
   void AddSocketTags (const Ptr<Packet> &p) const;
 
+  /**
+   * \brief Let the congestion control grow the window for newly acked segments
+   *
+   * With segmentation offload a single ACK covers a whole super-segment.
+   * It is fed to the congestion control as the delayed ACKs the receiver
+   * would have sent for the individual segments, so that the window grows
+   * as it does without offload: the congestion controls grow the window
+   * once per call, not once per segment acked.  This costs one call per
+   * DelAckCount segments, but no events; only the ACK itself is coalesced.
+   *
+   * \param segmentsAcked the number of segments acked
+   */
+  void IncreaseWindow (uint32_t segmentsAcked);
+
 protected:
   // Counters and events
   EventId           m_retxEvent     {}; //!< Retransmission event
@@ -1249,6 +1285,10 @@ protected:
   uint32_t               m_retxThresh {3};   //!< Fast Retransmit threshold
   bool                   m_limitedTx  {true}; //!< perform limited transmit
 
+  // Segmentation offload
+  uint32_t m_segmentOffload {0}; //!< Max size of the super-segments sent at once, 0 to disable
+  uint32_t m_ackHeldBack {0};    //!< Bytes of a super-segment the next empty ACK leaves to the delayed ACK
+
   // Transmission Control Block
   Ptr<TcpSocketState>    m_tcb;               //!< Congestion control information
   Ptr<TcpCongestionOps>  m_congestionControl; //!< Congestion control
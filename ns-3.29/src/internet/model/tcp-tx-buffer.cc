@@ -26,6 +26,7 @@
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/tcp-option-ts.h"
+#include "ns3/memory-accounting.h"
 
 #include "tcp-tx-buffer.h"
 
@@ -72,6 +73,7 @@ TcpTxItem::Print (std::ostream &os) const
 }
 
 NS_OBJECT_ENSURE_REGISTERED (TcpTxBuffer);
+NS_MEMORY_ACCOUNTANT (TcpTxBuffer);
 
 TypeId
 TcpTxBuffer::GetTypeId (void)
@@ -88,6 +90,16 @@ TcpTxBuffer::GetTypeId (void)
   return tid;
 }
 
+void
+TcpTxBuffer::AccountMemory (Ptr<Object> object, MemoryAccounting &accounting)
+{
+  Ptr<TcpTxBuffer> buffer = DynamicCast<TcpTxBuffer> (object);
+  uint64_t items = buffer->m_appList.size () + buffer->m_sentList.size ();
+  accounting.Add ("TCP tx buffer data", buffer->m_size + items * (sizeof (TcpTxItem) + sizeof (Packet)
+                                                                  + MemoryAccounting::CONTAINER_NODE_OVERHEAD),
+                  items);
+}
+
 /* A user is supposed to create a TcpSocket through a factory. In TcpSocket,
  * there are attributes SndBufSize and RcvBufSize to control the default Tx and
  * Rx window sizes respectively, with default of 128 KiByte. The attribute
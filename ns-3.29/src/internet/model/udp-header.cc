@@ -237,6 +237,28 @@ UdpHeader::Deserialize (Buffer::Iterator start)
   return GetSerializedSize ();
 }
 
+Header *
+UdpHeader::Copy (void) const
+{
+  return new UdpHeader (*this);
+}
+
+bool
+UdpHeader::Assign (const Header &header)
+{
+  const UdpHeader &other = static_cast<const UdpHeader &> (header);
+  if (m_calcChecksum || other.m_calcChecksum || other.m_payloadSize == 0)
+    {
+      // the checksum and the default length depend on the payload
+      return false;
+    }
+  m_sourcePort = other.m_sourcePort;
+  m_destinationPort = other.m_destinationPort;
+  m_payloadSize = other.m_payloadSize - GetSerializedSize ();
+  m_checksum = other.m_checksum;
+  return true;
+}
+
 uint16_t
 UdpHeader::GetChecksum ()
 {
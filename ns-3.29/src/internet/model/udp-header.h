@@ -124,6 +124,8 @@ public:
   virtual uint32_t GetSerializedSize (void) const;
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual Header *Copy (void) const;
+  virtual bool Assign (const Header &header);
 
   /**
    * \brief Is the UDP checksum correct ?
@@ -0,0 +1,211 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check TcpSocketBase::ConnectEstablished.
+ *
+ * Two sockets of a node are connected through the loopback without a
+ * handshake, next to a socket listening on the same port.  Both ends
+ * are notified of the connection and exchange data in both directions,
+ * and no SYN is ever sent.
+ */
+class TcpEstablishedTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param desc Test description.
+   * \param options True to keep window scaling, timestamps and SACK enabled.
+   */
+  TcpEstablishedTestCase (std::string desc, bool options);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Count the bytes received by a socket.
+   * \param socket The receiving socket.
+   */
+  void Recv (Ptr<Socket> socket);
+  /**
+   * \brief Trace the segments sent.
+   * \param packet The packet.
+   * \param header The TCP header.
+   * \param socket The sending socket.
+   */
+  void Tx (Ptr<const Packet> packet, const TcpHeader &header, Ptr<const TcpSocketBase> socket);
+  /**
+   * \brief Handle the connection of the active opener.
+   * \param socket The socket.
+   */
+  void HandleConnect (Ptr<Socket> socket);
+  /**
+   * \brief Send data.
+   * \param socket The sending socket.
+   * \param size The number of bytes.
+   */
+  void SendData (Ptr<Socket> socket, uint32_t size);
+  /**
+   * \brief Handle the connection of the passive opener.
+   * \param socket The socket.
+   * \param from The address of the peer.
+   */
+  void HandleAccept (Ptr<Socket> socket, const Address &from);
+
+  bool m_options;                          //!< Keep the TCP options enabled.
+  std::map<Ptr<Socket>, uint32_t> m_rx;    //!< Bytes received by each socket.
+  uint32_t m_syn;                          //!< SYN segments sent.
+  uint32_t m_connected;                    //!< Connection notifications.
+  uint32_t m_accepted;                     //!< Accept notifications.
+};
+
+TcpEstablishedTestCase::TcpEstablishedTestCase (std::string desc, bool options)
+  : TestCase (desc),
+    m_options (options),
+    m_syn (0),
+    m_connected (0),
+    m_accepted (0)
+{
+}
+
+void
+TcpEstablishedTestCase::Recv (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_rx[socket] += packet->GetSize ();
+    }
+}
+
+void
+TcpEstablishedTestCase::Tx (Ptr<const Packet> packet, const TcpHeader &header, Ptr<const TcpSocketBase> socket)
+{
+  if (header.GetFlags () & TcpHeader::SYN)
+    {
+      m_syn++;
+    }
+}
+
+void
+TcpEstablishedTestCase::HandleConnect (Ptr<Socket> socket)
+{
+  m_connected++;
+}
+
+void
+TcpEstablishedTestCase::SendData (Ptr<Socket> socket, uint32_t size)
+{
+  socket->Send (Create<Packet> (size));
+}
+
+void
+TcpEstablishedTestCase::HandleAccept (Ptr<Socket> socket, const Address &from)
+{
+  m_accepted++;
+}
+
+void
+TcpEstablishedTestCase::DoRun (void)
+{
+  if (!m_options)
+    {
+      Config::SetDefault ("ns3::TcpSocketBase::WindowScaling", BooleanValue (false));
+      Config::SetDefault ("ns3::TcpSocketBase::Timestamp", BooleanValue (false));
+      Config::SetDefault ("ns3::TcpSocketBase::Sack", BooleanValue (false));
+    }
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+
+  TypeId tid = TcpSocketFactory::GetTypeId ();
+  Ptr<Socket> listener = Socket::CreateSocket (node, tid);
+  listener->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  listener->Listen ();
+  listener->SetRecvCallback (MakeCallback (&TcpEstablishedTestCase::Recv, this));
+
+  Ptr<TcpSocketBase> client = DynamicCast<TcpSocketBase> (Socket::CreateSocket (node, tid));
+  Ptr<TcpSocketBase> server = DynamicCast<TcpSocketBase> (Socket::CreateSocket (node, tid));
+  client->SetConnectCallback (MakeCallback (&TcpEstablishedTestCase::HandleConnect, this),
+                              MakeNullCallback <void, Ptr<Socket> > ());
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&TcpEstablishedTestCase::HandleAccept, this));
+  client->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpEstablishedTestCase::Tx, this));
+  server->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpEstablishedTestCase::Tx, this));
+  client->SetRecvCallback (MakeCallback (&TcpEstablishedTestCase::Recv, this));
+  server->SetRecvCallback (MakeCallback (&TcpEstablishedTestCase::Recv, this));
+
+  NS_TEST_ASSERT_MSG_EQ (client->ConnectEstablished (server, InetSocketAddress (Ipv4Address::GetLoopback (), 9)), 0,
+                         "Connection failed");
+  NS_TEST_ASSERT_MSG_EQ (client->ConnectEstablished (server, InetSocketAddress (Ipv4Address::GetLoopback (), 9)), -1,
+                         "Connected twice");
+
+  Address clientName, serverPeer;
+  client->GetSockName (clientName);
+  server->GetPeerName (serverPeer);
+  NS_TEST_EXPECT_MSG_EQ (InetSocketAddress::ConvertFrom (clientName).GetPort (),
+                         InetSocketAddress::ConvertFrom (serverPeer).GetPort (), "Wrong peer of the server");
+
+  Simulator::Schedule (Seconds (1), &TcpEstablishedTestCase::Recv, this, listener);
+  uint32_t available = client->GetTxAvailable ();
+  Simulator::ScheduleWithContext (node->GetId (), Seconds (1), &TcpEstablishedTestCase::SendData, this,
+                                  client, 5000);
+  // without SACK, data crossing unacknowledged data would count as duplicate ACKs
+  Simulator::ScheduleWithContext (node->GetId (), Seconds (2), &TcpEstablishedTestCase::SendData, this,
+                                  server, 3000);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_connected, 1, "Connection not notified");
+  NS_TEST_EXPECT_MSG_EQ (m_accepted, 1, "Accept not notified");
+  NS_TEST_EXPECT_MSG_EQ (m_syn, 0, "SYN sent");
+  NS_TEST_EXPECT_MSG_EQ (m_rx[server], 5000, "Wrong data received by the server");
+  NS_TEST_EXPECT_MSG_EQ (m_rx[client], 3000, "Wrong data received by the client");
+  NS_TEST_EXPECT_MSG_EQ (m_rx[listener], 0, "Data received by the listener");
+  NS_TEST_EXPECT_MSG_EQ (client->GetTxAvailable (), available, "Data of the client not acknowledged");
+  NS_TEST_EXPECT_MSG_EQ (server->GetTxAvailable (), available, "Data of the server not acknowledged");
+
+  m_rx.clear ();
+  Simulator::Destroy ();
+  Config::Reset ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TcpSocketBase::ConnectEstablished TestSuite
+ */
+class TcpEstablishedTestSuite : public TestSuite
+{
+public:
+  TcpEstablishedTestSuite () : TestSuite ("tcp-established", UNIT)
+  {
+    AddTestCase (new TcpEstablishedTestCase ("Connection without handshake, with options", true), TestCase::QUICK);
+    AddTestCase (new TcpEstablishedTestCase ("Connection without handshake, without options", false), TestCase::QUICK);
+  }
+};
+
+static TcpEstablishedTestSuite g_tcpEstablishedTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,247 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/simple-channel.h"
+#include "ns3/node.h"
+#include "ns3/uinteger.h"
+#include "ns3/tcp-header.h"
+#include "tcp-general-test.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpSegmentOffloadTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief A bulk transfer, recorded for TcpSegmentOffloadTest
+ *
+ * The sender writes the whole transfer at once and has the SegmentOffload
+ * attribute given to the constructor.  The run records the congestion
+ * window, the ACKs the sender receives and the bytes the receiver reads,
+ * and makes no test assertion itself.
+ */
+class TcpSegmentOffloadRun : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor.
+   * \param segmentOffload SegmentOffload attribute of the sender.
+   * \param delAckCount DelAckCount attribute of both sockets.
+   */
+  TcpSegmentOffloadRun (uint32_t segmentOffload, uint32_t delAckCount);
+
+  /**
+   * \brief Run the transfer
+   */
+  void Simulate (void);
+
+  std::vector<std::pair<Time, uint32_t> > m_cWnd;          //!< Time and value of every cWnd change
+  std::vector<std::pair<Time, SequenceNumber32> > m_acks; //!< Time and number of every ACK received
+  uint32_t m_dataPackets;   //!< Data packets sent
+  uint32_t m_rxBytes;       //!< Bytes read by the receiver
+
+protected:
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual void CWndTrace (uint32_t oldValue, uint32_t newValue);
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who);
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who);
+  virtual void ReceivePacket (Ptr<Socket> socket);
+
+private:
+  uint32_t m_segmentOffload; //!< SegmentOffload attribute of the sender
+  uint32_t m_delAckCount;    //!< DelAckCount attribute of both sockets
+};
+
+TcpSegmentOffloadRun::TcpSegmentOffloadRun (uint32_t segmentOffload, uint32_t delAckCount)
+  : TcpGeneralTest ("TcpSegmentOffloadRun"),
+    m_dataPackets (0),
+    m_rxBytes (0),
+    m_segmentOffload (segmentOffload),
+    m_delAckCount (delAckCount)
+{
+}
+
+void
+TcpSegmentOffloadRun::Simulate (void)
+{
+  DoRun ();
+  DoTeardown ();
+}
+
+void
+TcpSegmentOffloadRun::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (1);
+  SetAppPktSize (50000);
+  // Super-segments are not fragmented, the device has to carry them
+  SetMTU (0xffff);
+}
+
+void
+TcpSegmentOffloadRun::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetInitialSsThresh (SENDER, 10000);
+  GetSenderSocket ()->SetAttribute ("SegmentOffload", UintegerValue (m_segmentOffload));
+  // The sender splits the ACK of a super-segment by its own DelAckCount
+  GetSenderSocket ()->SetAttribute ("DelAckCount", UintegerValue (m_delAckCount));
+  GetReceiverSocket ()->SetAttribute ("DelAckCount", UintegerValue (m_delAckCount));
+}
+
+void
+TcpSegmentOffloadRun::CWndTrace (uint32_t oldValue, uint32_t newValue)
+{
+  m_cWnd.push_back (std::make_pair (Simulator::Now (), newValue));
+}
+
+void
+TcpSegmentOffloadRun::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == SENDER && p->GetSize () > 0)
+    {
+      ++m_dataPackets;
+    }
+}
+
+void
+TcpSegmentOffloadRun::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == SENDER && (h.GetFlags () & TcpHeader::ACK))
+    {
+      m_acks.push_back (std::make_pair (Simulator::Now (), h.GetAckNumber ()));
+    }
+}
+
+void
+TcpSegmentOffloadRun::ReceivePacket (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  Address from;
+
+  while ((packet = socket->RecvFrom (from)))
+    {
+      if (packet->GetSize () == 0)
+        { //EOF
+          break;
+        }
+      m_rxBytes += packet->GetSize ();
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that segmentation offload leaves the congestion window alone
+ *
+ * The same bulk transfer runs with and without SegmentOffload, through
+ * slow start and congestion avoidance.  The channel has no data rate, so
+ * a super-segment arrives when the segments it stands for would have.
+ * The congestion window must take the same values at the same times, the
+ * same bytes must be delivered, and every ACK of the offloaded transfer
+ * must be one of the ACKs of the reference transfer, received at the
+ * same time: the super-segments only coalesce packets and ACKs.
+ */
+class TcpSegmentOffloadTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor.
+   * \param segmentOffload SegmentOffload attribute of the sender.
+   * \param delAckCount DelAckCount attribute of both sockets.
+   * \param desc Test description.
+   */
+  TcpSegmentOffloadTest (uint32_t segmentOffload, uint32_t delAckCount, const std::string &desc);
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_segmentOffload; //!< SegmentOffload attribute of the sender
+  uint32_t m_delAckCount;    //!< DelAckCount attribute of both sockets
+};
+
+TcpSegmentOffloadTest::TcpSegmentOffloadTest (uint32_t segmentOffload, uint32_t delAckCount,
+                                              const std::string &desc)
+  : TestCase (desc),
+    m_segmentOffload (segmentOffload),
+    m_delAckCount (delAckCount)
+{
+}
+
+void
+TcpSegmentOffloadTest::DoRun (void)
+{
+  TcpSegmentOffloadRun reference (0, m_delAckCount);
+  reference.Simulate ();
+  TcpSegmentOffloadRun offload (m_segmentOffload, m_delAckCount);
+  offload.Simulate ();
+
+  NS_TEST_ASSERT_MSG_EQ (reference.m_rxBytes, 50000, "Reference transfer incomplete");
+  NS_TEST_ASSERT_MSG_EQ (offload.m_rxBytes, reference.m_rxBytes, "Different bytes delivered");
+  NS_TEST_ASSERT_MSG_LT (offload.m_dataPackets, reference.m_dataPackets, "No super-segment sent");
+
+  NS_TEST_ASSERT_MSG_EQ (offload.m_cWnd.size (), reference.m_cWnd.size (), "Different cWnd traces");
+  for (uint32_t i = 0; i < reference.m_cWnd.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (offload.m_cWnd[i].first, reference.m_cWnd[i].first,
+                             "cWnd change " << i << " at a different time");
+      NS_TEST_ASSERT_MSG_EQ (offload.m_cWnd[i].second, reference.m_cWnd[i].second,
+                             "cWnd change " << i << " to a different value");
+    }
+
+  NS_TEST_ASSERT_MSG_LT (offload.m_acks.size (), reference.m_acks.size (), "ACKs not coalesced");
+  NS_TEST_ASSERT_MSG_EQ (offload.m_acks.back ().second, reference.m_acks.back ().second,
+                         "Different last ACK");
+  uint32_t j = 0;
+  for (uint32_t i = 0; i < offload.m_acks.size (); ++i)
+    {
+      while (j < reference.m_acks.size () && reference.m_acks[j] != offload.m_acks[i])
+        {
+          ++j;
+        }
+      NS_TEST_ASSERT_MSG_LT (j, reference.m_acks.size (),
+                             "ACK " << offload.m_acks[i].second << " at " <<
+                             offload.m_acks[i].first.GetSeconds () << "s not in the reference");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP segmentation offload TestSuite
+ */
+class TcpSegmentOffloadTestSuite : public TestSuite
+{
+public:
+  TcpSegmentOffloadTestSuite () : TestSuite ("tcp-segment-offload", UNIT)
+  {
+    AddTestCase (new TcpSegmentOffloadTest (4000, 1, "Segment offload, ACK every segment"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpSegmentOffloadTest (4000, 2, "Segment offload, delayed ACKs"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpSegmentOffloadTest (65000, 2, "Segment offload of a whole window"),
+                 TestCase::QUICK);
+  }
+};
+
+static TcpSegmentOffloadTestSuite g_tcpSegmentOffloadTestSuite; //!< Static variable for test initialization
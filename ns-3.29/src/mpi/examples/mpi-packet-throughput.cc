@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * Measures how fast packets cross between logical processors.
+ *
+ *                 -------   -------
+ *                  RANK 0    RANK 1
+ *                 ------- | -------
+ *                         |
+ *              n0 --------|-------- n1
+ *              n2 --------|-------- n3
+ *              ...        |        ...
+ *
+ * Each pair of nodes is joined by a point-to-point link across the two
+ * logical processors, and both ends send packets at the line rate
+ * straight through their device, without any protocol stack, so the
+ * run time is dominated by the transfer of the packets between them.
+ * The payloads are virtual: only the headers are copied.
+ *
+ * Every logical processor prints the packets it received, the wall
+ * clock time of the run and the resulting packet rate.  The
+ * "MpiBatchSize" GlobalValue sets how the packets are batched, e.g.
+ *
+ *   mpirun -np 2 mpi-packet-throughput --MpiBatchSize=0
+ *
+ * sends every packet in its own MPI message.  The example needs no MPI
+ * to run over shared memory, in processes forked on this host:
+ *
+ *   mpi-packet-throughput --SharedMemoryProcesses=2
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/point-to-point-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MpiPacketThroughput");
+
+/** Packets received by the nodes of this logical processor. */
+static uint64_t g_received = 0;
+
+/**
+ * Count a received packet.
+ * \param device The receiving device.
+ * \param packet The packet.
+ * \param protocol The protocol number.
+ * \param from The sender address.
+ * \param to The destination address.
+ * \param packetType The type of destination.
+ */
+static void
+Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+         const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  g_received++;
+}
+
+/**
+ * Send a packet and schedule the next one.
+ * \param device The sending device.
+ * \param size The size of the packets.
+ * \param interval The time between two packets.
+ */
+static void
+SendPacket (Ptr<NetDevice> device, uint32_t size, Time interval)
+{
+  // the IPv4 protocol number, which the point-to-point device can carry
+  device->Send (Create<Packet> (size), device->GetBroadcast (), 0x0800);
+  Simulator::Schedule (interval, &SendPacket, device, size, interval);
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t pairs = 4;
+  uint32_t size = 1000;
+  std::string dataRate = "1Gbps";
+  std::string delay = "1ms";
+  double duration = 1.0;
+  bool nullmsg = false;
+
+  // Parse command line
+  CommandLine cmd;
+  cmd.AddValue ("pairs", "Number of links between the logical processors", pairs);
+  cmd.AddValue ("size", "Size of the packets in bytes", size);
+  cmd.AddValue ("dataRate", "Data rate of the links", dataRate);
+  cmd.AddValue ("delay", "Delay of the links", delay);
+  cmd.AddValue ("duration", "Simulated time in seconds", duration);
+  cmd.AddValue ("nullmsg", "Enable the use of null-message synchronization", nullmsg);
+  cmd.Parse (argc, argv);
+
+  // Distributed simulation setup; by default use granted time window algorithm.
+  if (nullmsg)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType",
+                         StringValue ("ns3::NullMessageSimulatorImpl"));
+    }
+  else
+    {
+      GlobalValue::Bind ("SimulatorImplementationType",
+                         StringValue ("ns3::DistributedSimulatorImpl"));
+    }
+
+  // Enable parallel simulator with the command line arguments
+  MpiInterface::Enable (&argc, &argv);
+
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  uint32_t systemCount = MpiInterface::GetSize ();
+
+  // Must have 2 and only 2 Logical Processors (LPs)
+  if (systemCount != 2)
+    {
+      std::cout << "This simulation requires 2 and only 2 logical processors." << std::endl;
+      return 1;
+    }
+
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue (delay));
+
+  // The header of the point-to-point protocol is added to the packets
+  Time interval = DataRate (dataRate).CalculateBytesTxTime (size + 2);
+  for (uint32_t i = 0; i < pairs; ++i)
+    {
+      NodeContainer nodes;
+      nodes.Add (CreateObject<Node> (0));
+      nodes.Add (CreateObject<Node> (1));
+      NetDeviceContainer devices = pointToPoint.Install (nodes);
+
+      Ptr<Node> local = nodes.Get (systemId);
+      Ptr<NetDevice> device = devices.Get (systemId);
+      local->RegisterProtocolHandler (MakeCallback (&Receive), 0x0800, device);
+      Simulator::ScheduleWithContext (local->GetId (), Seconds (0), &SendPacket, device, size, interval);
+    }
+
+  Simulator::Stop (Seconds (duration));
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+  Simulator::Destroy ();
+
+  std::cout << "rank " << systemId << ": " << g_received << " packets received in "
+            << elapsed / 1000.0 << " s, "
+            << (elapsed > 0 ? g_received * 1000.0 / elapsed : 0.0) << " packets/s" << std::endl;
+
+  // Exit the MPI execution environment
+  MpiInterface::Disable ();
+  return 0;
+}
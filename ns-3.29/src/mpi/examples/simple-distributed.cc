@@ -63,8 +63,6 @@ NS_LOG_COMPONENT_DEFINE ("SimpleDistributed");
 int
 main (int argc, char *argv[])
 {
-#ifdef NS3_MPI
-
   bool nix = true;
   bool nullmsg = false;
   bool tracing = false;
@@ -271,7 +269,4 @@ main (int argc, char *argv[])
   // Exit the MPI execution environment
   MpiInterface::Disable ();
   return 0;
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
 }
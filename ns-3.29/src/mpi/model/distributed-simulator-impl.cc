@@ -19,6 +19,7 @@
 
 #include "distributed-simulator-impl.h"
 #include "granted-time-window-mpi-interface.h"
+#include "shared-memory-interface.h"
 #include "mpi-interface.h"
 
 #include "ns3/simulator.h"
@@ -30,8 +31,14 @@
 #include "ns3/pointer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <iostream>
+#include <sstream>
+#include <vector>
 
 #ifdef NS3_MPI
 #include <mpi.h>
@@ -76,6 +83,102 @@ LbtsMessage::IsFinished ()
   return m_isFinished;
 }
 
+void
+LbtsMessage::Reduce (const LbtsMessage &other)
+{
+  if (other.m_smallestTime < m_smallestTime)
+    {
+      m_smallestTime = other.m_smallestTime;
+    }
+  m_rxCount += other.m_rxCount;
+  m_txCount += other.m_txCount;
+  m_isFinished = m_isFinished && other.m_isFinished;
+}
+
+#ifdef NS3_MPI
+/** The LBTS message as an MPI datatype, created at the first LBTS computation. */
+static MPI_Datatype g_lbtsType = MPI_DATATYPE_NULL;
+/** The MPI reduction of the LBTS messages. */
+static MPI_Op g_lbtsOp = MPI_OP_NULL;
+
+/**
+ * The MPI reduction function of the LBTS messages.
+ * \param [in] in The messages to combine.
+ * \param [in,out] inout The messages to combine with, and the result.
+ * \param [in] len The number of messages.
+ */
+static void
+ReduceLbtsMessages (void *in, void *inout, int *len, MPI_Datatype *)
+{
+  LbtsMessage *pIn = static_cast<LbtsMessage *> (in);
+  LbtsMessage *pInOut = static_cast<LbtsMessage *> (inout);
+  for (int i = 0; i < *len; ++i)
+    {
+      pInOut[i].Reduce (pIn[i]);
+    }
+}
+#endif
+
+/**
+ * \name Communication of the tasks
+ * Over shared memory or MPI, whichever the simulation runs on.
+ * @{
+ */
+/** Send the packets batched during the time window. */
+static void
+FlushSendBatches (void)
+{
+  if (!SharedMemoryInterface::IsActive ())
+    {
+      GrantedTimeWindowMpiInterface::FlushSendBatches ();
+    }
+}
+
+/** Check for received messages. */
+static void
+ReceiveMessages (void)
+{
+  if (SharedMemoryInterface::IsActive ())
+    {
+      SharedMemoryInterface::ReceiveMessages ();
+    }
+  else
+    {
+      GrantedTimeWindowMpiInterface::ReceiveMessages ();
+    }
+}
+
+/** Check for completed sends. */
+static void
+TestSendComplete (void)
+{
+  if (SharedMemoryInterface::IsActive ())
+    {
+      SharedMemoryInterface::TestSendComplete ();
+    }
+  else
+    {
+      GrantedTimeWindowMpiInterface::TestSendComplete ();
+    }
+}
+
+/** \return The number of packets received. */
+static uint32_t
+GetRxCount (void)
+{
+  return SharedMemoryInterface::IsActive () ? SharedMemoryInterface::GetRxCount ()
+         : GrantedTimeWindowMpiInterface::GetRxCount ();
+}
+
+/** \return The number of packets sent. */
+static uint32_t
+GetTxCount (void)
+{
+  return SharedMemoryInterface::IsActive () ? SharedMemoryInterface::GetTxCount ()
+         : GrantedTimeWindowMpiInterface::GetTxCount ();
+}
+/**@}*/
+
 Time DistributedSimulatorImpl::m_lookAhead = Seconds (-1);
 
 TypeId
@@ -85,6 +188,19 @@ DistributedSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Mpi")
     .AddConstructor<DistributedSimulatorImpl> ()
+    .AddAttribute ("AsynchronousLbts",
+                   "Compute the LBTS with a non-blocking all-reduce, unpacking the "
+                   "messages received while it completes, rather than with a "
+                   "blocking all-gather.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&DistributedSimulatorImpl::m_asyncLbts),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ReportLbtsWait",
+                   "Print at Destroy the number of LBTS computations of this rank "
+                   "and the wall clock time spent waiting for them.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DistributedSimulatorImpl::m_reportLbtsWait),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -93,17 +209,12 @@ DistributedSimulatorImpl::DistributedSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
 
-#ifdef NS3_MPI
   m_myId = MpiInterface::GetSystemId ();
   m_systemCount = MpiInterface::GetSize ();
 
   // Allocate the LBTS message buffer
   m_pLBTS = new LbtsMessage[m_systemCount];
   m_grantedTime = Seconds (0);
-#else
-  NS_UNUSED (m_systemCount);
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
 
   m_stop = false;
   m_globalFinished = false;
@@ -116,8 +227,15 @@ DistributedSimulatorImpl::DistributedSimulatorImpl ()
   m_currentUid = 0;
   m_currentTs = 0;
   m_currentContext = Simulator::NO_CONTEXT;
+  m_eventCount = 0;
   m_unscheduledEvents = 0;
   m_events = 0;
+  m_asyncLbts = true;
+  m_reportLbtsWait = false;
+  m_lbtsWindows = 0;
+  m_lbtsStalled = 0;
+  m_lbtsWait = 0;
+  m_lbtsMaxWait = 0;
 }
 
 DistributedSimulatorImpl::~DistributedSimulatorImpl ()
@@ -137,6 +255,17 @@ DistributedSimulatorImpl::DoDispose (void)
     }
   m_events = 0;
   delete [] m_pLBTS;
+#ifdef NS3_MPI
+  int finalized = 0;
+  MPI_Finalized (&finalized);
+  if (g_lbtsOp != MPI_OP_NULL && !finalized)
+    {
+      MPI_Op_free (&g_lbtsOp);
+      MPI_Type_free (&g_lbtsType);
+    }
+  g_lbtsOp = MPI_OP_NULL;
+  g_lbtsType = MPI_DATATYPE_NULL;
+#endif
   SimulatorImpl::DoDispose ();
 }
 
@@ -156,16 +285,95 @@ DistributedSimulatorImpl::Destroy ()
         }
     }
 
+  if (m_reportLbtsWait)
+    {
+      // one write, the ranks share the standard error
+      std::ostringstream oss;
+      oss << "LBTS rank " << m_myId << ": " << m_lbtsWindows << " computations, "
+          << m_lbtsStalled << " stalled by transient messages, "
+          << m_lbtsWait << " s waiting (mean "
+          << (m_lbtsWindows ? m_lbtsWait * 1000 / m_lbtsWindows : 0) << " ms, max "
+          << m_lbtsMaxWait * 1000 << " ms)" << std::endl;
+      std::cerr << oss.str () << std::flush;
+    }
+
   MpiInterface::Destroy ();
 }
 
 
+LbtsMessage
+DistributedSimulatorImpl::ReduceLbts (LbtsMessage lMsg)
+{
+  NS_LOG_FUNCTION (this);
+
+  LbtsMessage lbts = lMsg;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  if (SharedMemoryInterface::IsActive ())
+    {
+      // The messages which arrive meanwhile are unpacked
+      SharedMemoryInterface::AllGather (&lMsg, m_pLBTS, sizeof (LbtsMessage));
+      lbts = m_pLBTS[0];
+      for (uint32_t i = 1; i < m_systemCount; ++i)
+        {
+          lbts.Reduce (m_pLBTS[i]);
+        }
+    }
+#ifdef NS3_MPI
+  else if (m_asyncLbts)
+    {
+      if (g_lbtsOp == MPI_OP_NULL)
+        {
+          MPI_Type_contiguous (sizeof (LbtsMessage), MPI_BYTE, &g_lbtsType);
+          MPI_Type_commit (&g_lbtsType);
+          MPI_Op_create (&ReduceLbtsMessages, 1, &g_lbtsOp);
+        }
+#if MPI_VERSION >= 3
+      // No event can be processed before the reduction completes: a
+      // message sent in the last window may still carry any time up to
+      // the granted time plus the lookahead.  Unpack the messages which
+      // arrive meanwhile, the next window starts with them in the queue.
+      MPI_Request request;
+      MPI_Iallreduce (&lMsg, &lbts, 1, g_lbtsType, g_lbtsOp, MPI_COMM_WORLD, &request);
+      int done = 0;
+      MPI_Test (&request, &done, MPI_STATUS_IGNORE);
+      while (!done)
+        {
+          ReceiveMessages ();
+          TestSendComplete ();
+          MPI_Test (&request, &done, MPI_STATUS_IGNORE);
+        }
+#else
+      MPI_Allreduce (&lMsg, &lbts, 1, g_lbtsType, g_lbtsOp, MPI_COMM_WORLD);
+#endif
+    }
+  else
+    {
+      m_pLBTS[m_myId] = lMsg;
+      MPI_Allgather (&lMsg, sizeof (LbtsMessage), MPI_BYTE, m_pLBTS,
+                     sizeof (LbtsMessage), MPI_BYTE, MPI_COMM_WORLD);
+      lbts = m_pLBTS[0];
+      for (uint32_t i = 1; i < m_systemCount; ++i)
+        {
+          lbts.Reduce (m_pLBTS[i]);
+        }
+    }
+#endif
+  double wait = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  m_lbtsWindows++;
+  m_lbtsWait += wait;
+  if (wait > m_lbtsMaxWait)
+    {
+      m_lbtsMaxWait = wait;
+    }
+  NS_LOG_LOGIC ("LBTS " << lbts.GetSmallestTime () << " after " << wait * 1000 << " ms");
+  return lbts;
+}
+
 void
 DistributedSimulatorImpl::CalculateLookAhead (void)
 {
   NS_LOG_FUNCTION (this);
 
-#ifdef NS3_MPI
   if (MpiInterface::GetSize () <= 1)
     {
       m_lookAhead = Seconds (0);
@@ -262,7 +470,20 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
       sendbuf  = m_lookAhead.GetInteger ();
     }
 
-  MPI_Allreduce (&sendbuf, &recvbuf, 1, MPI_LONG, MPI_MAX, MPI_COMM_WORLD);
+  if (SharedMemoryInterface::IsActive ())
+    {
+      std::vector<long> sendbufs (m_systemCount);
+      SharedMemoryInterface::AllGather (&sendbuf, &sendbufs[0], sizeof (sendbuf));
+      recvbuf = *std::max_element (sendbufs.begin (), sendbufs.end ());
+    }
+  else
+    {
+#ifdef NS3_MPI
+      MPI_Allreduce (&sendbuf, &recvbuf, 1, MPI_LONG, MPI_MAX, MPI_COMM_WORLD);
+#else
+      NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+    }
 
   /* For nodes that did not compute a lookahead use max from ranks
    * that did compute a value.  An edge case occurs if all nodes have
@@ -275,10 +496,6 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
       m_lookAhead = Time (recvbuf);
       m_grantedTime = m_lookAhead;
     }
-
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
 }
 
 void
@@ -326,6 +543,7 @@ DistributedSimulatorImpl::ProcessOneEvent (void)
   NS_LOG_LOGIC ("handle " << next.key.m_ts);
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
+  m_eventCount++;
   m_currentUid = next.key.m_uid;
   next.impl->Invoke ();
   next.impl->Unref ();
@@ -370,7 +588,6 @@ DistributedSimulatorImpl::Run (void)
 {
   NS_LOG_FUNCTION (this);
 
-#ifdef NS3_MPI
   CalculateLookAhead ();
   m_stop = false;
   m_globalFinished = false;
@@ -386,37 +603,25 @@ DistributedSimulatorImpl::Run (void)
       if (nextTime > m_grantedTime || IsLocalFinished () )
         {
           // Can't process next event, calculate a new LBTS
+          // Send the packets batched during the window, they are
+          // counted as sent and must arrive before the next one
+          FlushSendBatches ();
           // First receive any pending messages
-          GrantedTimeWindowMpiInterface::ReceiveMessages ();
+          ReceiveMessages ();
           // reset next time
           nextTime = Next ();
           // And check for send completes
-          GrantedTimeWindowMpiInterface::TestSendComplete ();
+          TestSendComplete ();
           // Finally calculate the lbts
-          LbtsMessage lMsg (GrantedTimeWindowMpiInterface::GetRxCount (), GrantedTimeWindowMpiInterface::GetTxCount (), 
+          LbtsMessage lMsg (GetRxCount (), GetTxCount (), 
                             m_myId, IsLocalFinished (), nextTime);
-          m_pLBTS[m_myId] = lMsg;
-          MPI_Allgather (&lMsg, sizeof (LbtsMessage), MPI_BYTE, m_pLBTS,
-                         sizeof (LbtsMessage), MPI_BYTE, MPI_COMM_WORLD);
-          Time smallestTime = m_pLBTS[0].GetSmallestTime ();
+          LbtsMessage lbts = ReduceLbts (lMsg);
+          Time smallestTime = lbts.GetSmallestTime ();
+          m_globalFinished = lbts.IsFinished ();
           // The totRx and totTx counts insure there are no transient
           // messages;  If totRx != totTx, there are transients,
           // so we don't update the granted time.
-          uint32_t totRx = m_pLBTS[0].GetRxCount ();
-          uint32_t totTx = m_pLBTS[0].GetTxCount ();
-          m_globalFinished = m_pLBTS[0].IsFinished ();
-
-          for (uint32_t i = 1; i < m_systemCount; ++i)
-            {
-              if (m_pLBTS[i].GetSmallestTime () < smallestTime)
-                {
-                  smallestTime = m_pLBTS[i].GetSmallestTime ();
-                }
-              totRx += m_pLBTS[i].GetRxCount ();
-              totTx += m_pLBTS[i].GetTxCount ();
-              m_globalFinished &= m_pLBTS[i].IsFinished ();
-            }
-          if (totRx == totTx)
+          if (lbts.GetRxCount () == lbts.GetTxCount ())
             {
               // If lookahead is infinite then granted time should be as well.
               // Covers the edge case if all the tasks have no inter tasks
@@ -431,6 +636,10 @@ DistributedSimulatorImpl::Run (void)
                   m_grantedTime = smallestTime + m_lookAhead;
                 }
             }
+          else
+            {
+              m_lbtsStalled++;
+            }
         }
 
       // Execute next event if it is within the current time window.
@@ -444,9 +653,6 @@ DistributedSimulatorImpl::Run (void)
   // If the simulator stopped naturally by lack of events, make a
   // consistency test to check that we didn't lose any events along the way.
   NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == 0);
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
 }
 
 uint32_t DistributedSimulatorImpl::GetSystemId () const
@@ -644,4 +850,16 @@ DistributedSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint64_t
+DistributedSimulatorImpl::GetEventCount (void) const
+{
+  return m_eventCount;
+}
+
+uint64_t
+DistributedSimulatorImpl::GetPendingEventCount (void) const
+{
+  return m_unscheduledEvents;
+}
+
 } // namespace ns3
@@ -83,6 +83,12 @@ public:
    * \return true if system is finished
    */
   bool IsFinished ();
+  /**
+   * Combine with the message of another system: keep the smallest
+   * time, add the counts and check that both systems are finished.
+   * \param other The message of the other system.
+   */
+  void Reduce (const LbtsMessage &other);
 
 private:
   uint32_t m_txCount;
@@ -126,12 +132,21 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const;
   virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+  virtual uint64_t GetPendingEventCount (void) const;
 
 private:
   virtual void DoDispose (void);
   void CalculateLookAhead (void);
   bool IsLocalFinished (void) const;
 
+  /**
+   * Combine the LBTS messages of all the systems, see LbtsMessage::Reduce.
+   * \param lMsg The message of this system.
+   * \return The combined message.
+   */
+  LbtsMessage ReduceLbts (LbtsMessage lMsg);
+
   void ProcessOneEvent (void);
   uint64_t NextTs (void) const;
   Time Next (void) const;
@@ -145,6 +160,7 @@ private:
   uint32_t m_currentUid;
   uint64_t m_currentTs;
   uint32_t m_currentContext;
+  uint64_t m_eventCount;
   // number of events that have been inserted but not yet scheduled,
   // not counting the "destroy" events; this is used for validation
   int m_unscheduledEvents;
@@ -155,6 +171,13 @@ private:
   Time         m_grantedTime; // Last LBTS
   static Time  m_lookAhead;   // Lookahead value
 
+  bool         m_asyncLbts;       // Reduce the LBTS with a non-blocking collective
+  bool         m_reportLbtsWait;  // Print the LBTS statistics at Destroy
+  uint64_t     m_lbtsWindows;     // LBTS computations
+  uint64_t     m_lbtsStalled;     // LBTS computations which could not grant time because of transient messages
+  double       m_lbtsWait;        // Wall clock seconds spent in the LBTS computations
+  double       m_lbtsMaxWait;     // Wall clock seconds of the longest LBTS computation
+
 };
 
 } // namespace ns3
@@ -20,6 +20,7 @@
 // This object contains static methods that provide an easy interface
 // to the necessary MPI information.
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <list>
@@ -35,6 +36,9 @@
 #include "ns3/simulator-impl.h"
 #include "ns3/nstime.h"
 #include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/abort.h"
 
 #ifdef NS3_MPI
 #include <mpi.h>
@@ -44,6 +48,17 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GrantedTimeWindowMpiInterface");
 
+/**
+ * \ingroup mpi
+ * The size of the MPI messages carrying the packets sent to a task.
+ */
+static GlobalValue g_mpiBatchSize = GlobalValue ("MpiBatchSize",
+                                                 "The size in bytes of the MPI messages which batch "
+                                                 "the packets sent to a task within a time window, "
+                                                 "0 to send every packet in its own message",
+                                                 UintegerValue (65536),
+                                                 MakeUintegerChecker<uint32_t> ());
+
 SentBuffer::SentBuffer ()
 {
   m_buffer = 0;
@@ -82,10 +97,17 @@ bool                  GrantedTimeWindowMpiInterface::m_enabled = false;
 uint32_t              GrantedTimeWindowMpiInterface::m_rxCount = 0;
 uint32_t              GrantedTimeWindowMpiInterface::m_txCount = 0;
 std::list<SentBuffer> GrantedTimeWindowMpiInterface::m_pendingTx;
+uint32_t              GrantedTimeWindowMpiInterface::m_bufferSize = MAX_MPI_MSG_SIZE;
+uint32_t              GrantedTimeWindowMpiInterface::m_batchSize = 0;
+std::vector<uint8_t*> GrantedTimeWindowMpiInterface::m_batches;
+std::vector<uint32_t> GrantedTimeWindowMpiInterface::m_batchBytes;
+std::vector<uint8_t*> GrantedTimeWindowMpiInterface::m_freeBuffers;
 
 #ifdef NS3_MPI
 MPI_Request* GrantedTimeWindowMpiInterface::m_requests;
 char**       GrantedTimeWindowMpiInterface::m_pRxBuffers;
+int*         GrantedTimeWindowMpiInterface::m_rxIndices;
+MPI_Status*  GrantedTimeWindowMpiInterface::m_rxStatuses;
 #endif
 
 TypeId 
@@ -110,8 +132,21 @@ GrantedTimeWindowMpiInterface::Destroy ()
     }
   delete [] m_pRxBuffers;
   delete [] m_requests;
+  delete [] m_rxIndices;
+  delete [] m_rxStatuses;
 
   m_pendingTx.clear ();
+  for (uint32_t i = 0; i < m_batches.size (); ++i)
+    {
+      delete [] m_batches[i];
+    }
+  m_batches.clear ();
+  m_batchBytes.clear ();
+  for (uint32_t i = 0; i < m_freeBuffers.size (); ++i)
+    {
+      delete [] m_freeBuffers[i];
+    }
+  m_freeBuffers.clear ();
 #endif
 }
 
@@ -173,13 +208,21 @@ GrantedTimeWindowMpiInterface::Enable (int* pargc, char*** pargv)
   MPI_Comm_size (MPI_COMM_WORLD, reinterpret_cast <int *> (&m_size));
   m_enabled = true;
   m_initialized = true;
+  UintegerValue batchSize;
+  g_mpiBatchSize.GetValue (batchSize);
+  m_batchSize = batchSize.Get ();
+  m_bufferSize = std::max (MAX_MPI_MSG_SIZE, m_batchSize);
+  m_batches.assign (m_size, 0);
+  m_batchBytes.assign (m_size, 0);
   // Post a non-blocking receive for all peers
   m_pRxBuffers = new char*[m_size];
   m_requests = new MPI_Request[m_size];
+  m_rxIndices = new int[m_size];
+  m_rxStatuses = new MPI_Status[m_size];
   for (uint32_t i = 0; i < GetSize (); ++i)
     {
-      m_pRxBuffers[i] = new char[MAX_MPI_MSG_SIZE];
-      MPI_Irecv (m_pRxBuffers[i], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
+      m_pRxBuffers[i] = new char[m_bufferSize];
+      MPI_Irecv (m_pRxBuffers[i], m_bufferSize, MPI_CHAR, MPI_ANY_SOURCE, 0,
                  MPI_COMM_WORLD, &m_requests[i]);
     }
 #else
@@ -193,35 +236,93 @@ GrantedTimeWindowMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, ui
   NS_LOG_FUNCTION (this << p << rxTime.GetTimeStep () << node << dev);
 
 #ifdef NS3_MPI
-  SentBuffer sendBuf;
-  m_pendingTx.push_back (sendBuf);
-  std::list<SentBuffer>::reverse_iterator i = m_pendingTx.rbegin (); // Points to the last element
-
   uint32_t serializedSize = p->GetSerializedSize ();
-  uint8_t* buffer =  new uint8_t[serializedSize + 16];
-  i->SetBuffer (buffer);
-  // Add the time, dest node and dest device
+  // Keep the header of the next packet aligned
+  uint32_t recordSize = MPI_PACKET_HEADER_SIZE + ((serializedSize + 7) & ~7U);
+  NS_ABORT_MSG_IF (recordSize > m_bufferSize,
+                   "Packet of " << serializedSize << " bytes larger than the MPI messages");
+
+  // Find the system id for the destination node
+  Ptr<Node> destNode = NodeList::GetNode (node);
+  uint32_t nodeSysId = destNode->GetSystemId ();
+
+  if (m_batches[nodeSysId] != 0 && m_batchBytes[nodeSysId] + recordSize > m_bufferSize)
+    {
+      FlushSendBatch (nodeSysId);
+    }
+  if (m_batches[nodeSysId] == 0)
+    {
+      m_batches[nodeSysId] = AllocateBuffer ();
+    }
+  uint8_t* buffer = m_batches[nodeSysId] + m_batchBytes[nodeSysId];
+  // Add the time, dest node, dest device and packet size
   uint64_t t = rxTime.GetInteger ();
   uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
   *pTime++ = t;
   uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
   *pData++ = node;
   *pData++ = dev;
+  *pData++ = serializedSize;
+  *pData++ = 0;
   // Serialize the packet
   p->Serialize (reinterpret_cast<uint8_t *> (pData), serializedSize);
+  m_batchBytes[nodeSysId] += recordSize;
+  m_txCount++;
 
-  // Find the system id for the destination node
-  Ptr<Node> destNode = NodeList::GetNode (node);
-  uint32_t nodeSysId = destNode->GetSystemId ();
+  if (m_batchSize == 0)
+    {
+      FlushSendBatch (nodeSysId);
+    }
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
+
+uint8_t*
+GrantedTimeWindowMpiInterface::AllocateBuffer ()
+{
+  if (m_freeBuffers.empty ())
+    {
+      return new uint8_t[m_bufferSize];
+    }
+  uint8_t* buffer = m_freeBuffers.back ();
+  m_freeBuffers.pop_back ();
+  return buffer;
+}
+
+void
+GrantedTimeWindowMpiInterface::FlushSendBatch (uint32_t rank)
+{
+  NS_LOG_FUNCTION (rank);
 
-  MPI_Isend (reinterpret_cast<void *> (i->GetBuffer ()), serializedSize + 16, MPI_CHAR, nodeSysId,
+#ifdef NS3_MPI
+  if (m_batches[rank] == 0)
+    {
+      return;
+    }
+  m_pendingTx.push_back (SentBuffer ());
+  std::list<SentBuffer>::reverse_iterator i = m_pendingTx.rbegin (); // Points to the last element
+  i->SetBuffer (m_batches[rank]);
+  MPI_Isend (reinterpret_cast<void *> (i->GetBuffer ()), m_batchBytes[rank], MPI_CHAR, rank,
              0, MPI_COMM_WORLD, (i->GetRequest ()));
-  m_txCount++;
+  m_batches[rank] = 0;
+  m_batchBytes[rank] = 0;
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
 #endif
 }
 
+void
+GrantedTimeWindowMpiInterface::FlushSendBatches ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  for (uint32_t i = 0; i < m_batches.size (); ++i)
+    {
+      FlushSendBatch (i);
+    }
+}
+
 void
 GrantedTimeWindowMpiInterface::ReceiveMessages ()
 { 
@@ -231,55 +332,63 @@ GrantedTimeWindowMpiInterface::ReceiveMessages ()
   // Poll the non-block reads to see if data arrived
   while (true)
     {
-      int flag = 0;
-      int index = 0;
-      MPI_Status status;
-
-      MPI_Testany (MpiInterface::GetSize (), m_requests, &index, &flag, &status);
-      if (!flag)
+      int completed = 0;
+      MPI_Testsome (MpiInterface::GetSize (), m_requests, &completed, m_rxIndices, m_rxStatuses);
+      if (completed == 0 || completed == MPI_UNDEFINED)
         {
           break;        // No more messages
         }
-      int count;
-      MPI_Get_count (&status, MPI_CHAR, &count);
-      m_rxCount++; // Count this receive
-
-      // Get the meta data first
-      uint64_t* pTime = reinterpret_cast<uint64_t *> (m_pRxBuffers[index]);
-      uint64_t time = *pTime++;
-      uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-      uint32_t node = *pData++;
-      uint32_t dev  = *pData++;
-
-      Time rxTime (time);
-
-      count -= sizeof (time) + sizeof (node) + sizeof (dev);
-
-      Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (pData), count, true);
-
-      // Find the correct node/device to schedule receive event
-      Ptr<Node> pNode = NodeList::GetNode (node);
-      Ptr<MpiReceiver> pMpiRec = 0;
-      uint32_t nDevices = pNode->GetNDevices ();
-      for (uint32_t i = 0; i < nDevices; ++i)
+      for (int k = 0; k < completed; ++k)
         {
-          Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
-          if (pThisDev->GetIfIndex () == dev)
+          int index = m_rxIndices[k];
+          int count;
+          MPI_Get_count (&m_rxStatuses[k], MPI_CHAR, &count);
+
+          uint8_t* buffer = reinterpret_cast<uint8_t *> (m_pRxBuffers[index]);
+          uint8_t* end = buffer + count;
+          while (buffer < end)
             {
-              pMpiRec = pThisDev->GetObject<MpiReceiver> ();
-              break;
+              m_rxCount++; // Count this receive
+
+              // Get the meta data first
+              uint64_t* pTime = reinterpret_cast<uint64_t *> (buffer);
+              uint64_t time = *pTime++;
+              uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
+              uint32_t node = *pData++;
+              uint32_t dev  = *pData++;
+              uint32_t size = *pData++;
+              pData++;
+
+              Time rxTime (time);
+
+              Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (pData), size, true);
+              buffer += MPI_PACKET_HEADER_SIZE + ((size + 7) & ~7U);
+
+              // Find the correct node/device to schedule receive event
+              Ptr<Node> pNode = NodeList::GetNode (node);
+              Ptr<MpiReceiver> pMpiRec = 0;
+              uint32_t nDevices = pNode->GetNDevices ();
+              for (uint32_t i = 0; i < nDevices; ++i)
+                {
+                  Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
+                  if (pThisDev->GetIfIndex () == dev)
+                    {
+                      pMpiRec = pThisDev->GetObject<MpiReceiver> ();
+                      break;
+                    }
+                }
+
+              NS_ASSERT (pNode && pMpiRec);
+
+              // Schedule the rx event
+              Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
+                                              &MpiReceiver::Receive, pMpiRec, p);
             }
-        }
 
-      NS_ASSERT (pNode && pMpiRec);
-
-      // Schedule the rx event
-      Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
-                                      &MpiReceiver::Receive, pMpiRec, p);
-
-      // Re-queue the next read
-      MPI_Irecv (m_pRxBuffers[index], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
-                 MPI_COMM_WORLD, &m_requests[index]);
+          // Re-queue the next read
+          MPI_Irecv (m_pRxBuffers[index], m_bufferSize, MPI_CHAR, MPI_ANY_SOURCE, 0,
+                     MPI_COMM_WORLD, &m_requests[index]);
+        }
     }
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
@@ -301,7 +410,9 @@ GrantedTimeWindowMpiInterface::TestSendComplete ()
       std::list<SentBuffer>::iterator current = i; // Save current for erasing
       i++;                                    // Advance to next
       if (flag)
-        { // This message is complete
+        { // This message is complete, keep its buffer for the next ones
+          m_freeBuffers.push_back (current->GetBuffer ());
+          current->SetBuffer (0);
           m_pendingTx.erase (current);
         }
     }
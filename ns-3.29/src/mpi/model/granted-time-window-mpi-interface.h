@@ -25,6 +25,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
 
 #include "ns3/nstime.h"
 #include "ns3/buffer.h"
@@ -45,6 +46,13 @@ namespace ns3 {
  */
 const uint32_t MAX_MPI_MSG_SIZE = 2000;
 
+/**
+ * size of the header of a packet in an MPI message: receive time,
+ * destination node, destination device and packet size, padded to
+ * keep the next header aligned
+ */
+const uint32_t MPI_PACKET_HEADER_SIZE = 24;
+
 /**
  * \ingroup mpi
  *
@@ -87,6 +95,13 @@ class Packet;
  * Implements the interface used by the singleton parallel controller
  * to interface between NS3 and the communications layer being
  * used for inter-task packet transfers.
+ *
+ * The packets sent to a task are serialized one after the other in a
+ * single MPI message, which is sent when it is full or at the end of
+ * the granted time window (FlushSendBatches).  The "MpiBatchSize"
+ * GlobalValue sets the size of the messages; with 0 every packet is
+ * sent on its own, as soon as it is handed over.  The message buffers
+ * are reused once their send completes.
  */
 class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Object
 {
@@ -131,6 +146,10 @@ public:
    * Serialize and send a packet to the specified node and net device
    */
   virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+  /**
+   * Send the packets waiting in the batches of all the tasks
+   */
+  static void FlushSendBatches ();
   /**
    * Check for received messages complete
    */
@@ -149,6 +168,17 @@ public:
   static uint32_t GetTxCount ();
 
 private:
+  /**
+   * \param rank the destination task
+   *
+   * Send the packets waiting in the batch of a task, if any
+   */
+  static void FlushSendBatch (uint32_t rank);
+  /**
+   * \return a message buffer of m_bufferSize bytes, reused if possible
+   */
+  static uint8_t* AllocateBuffer ();
+
   static uint32_t m_sid;
   static uint32_t m_size;
 
@@ -168,6 +198,27 @@ private:
 
   // List of pending non-blocking sends
   static std::list<SentBuffer> m_pendingTx;
+
+  // Size of the send and receive buffers
+  static uint32_t m_bufferSize;
+
+  // Largest batch of packets, 0 to send them one by one
+  static uint32_t m_batchSize;
+
+  // Buffer of the batch being filled for each task, 0 if none
+  static std::vector<uint8_t*> m_batches;
+
+  // Bytes in the batch of each task
+  static std::vector<uint32_t> m_batchBytes;
+
+  // Buffers of the completed sends
+  static std::vector<uint8_t*> m_freeBuffers;
+
+#ifdef NS3_MPI
+  // Indices and statuses of the receives completed by MPI_Testsome
+  static int* m_rxIndices;
+  static MPI_Status* m_rxStatuses;
+#endif
 };
 
 } // namespace ns3
@@ -23,10 +23,12 @@
 
 #include <ns3/global-value.h>
 #include <ns3/string.h>
+#include <ns3/uinteger.h>
 #include <ns3/log.h>
 
 #include "null-message-mpi-interface.h"
 #include "granted-time-window-mpi-interface.h"
+#include "shared-memory-interface.h"
 
 namespace ns3 {
 
@@ -77,6 +79,7 @@ MpiInterface::Enable (int* pargc, char*** pargv)
 {
   StringValue simulationTypeValue;
   bool useDefault = true;
+  bool nullMessage = false;
 
   if (GlobalValue::GetValueByNameFailSafe ("SimulatorImplementationType", simulationTypeValue))
     {
@@ -86,12 +89,11 @@ MpiInterface::Enable (int* pargc, char*** pargv)
       // Defaults to synchronous.
       if (simulationType.compare ("ns3::NullMessageSimulatorImpl") == 0)
         {
-          g_parallelCommunicationInterface = new NullMessageMpiInterface ();
+          nullMessage = true;
           useDefault = false;
         }
       else if (simulationType.compare ("ns3::DistributedSimulatorImpl") == 0)
         {
-          g_parallelCommunicationInterface = new GrantedTimeWindowMpiInterface ();
           useDefault = false;
         }
     }
@@ -99,12 +101,27 @@ MpiInterface::Enable (int* pargc, char*** pargv)
   // User did not specify a valid parallel simulator; use the default.
   if (useDefault)
     {
-      g_parallelCommunicationInterface = new GrantedTimeWindowMpiInterface ();
       GlobalValue::Bind ("SimulatorImplementationType",
                          StringValue ("ns3::DistributedSimulatorImpl"));
       NS_LOG_WARN ("SimulatorImplementationType was set to non-parallel simulator; setting type to ns3::DistributedSimulatorImp");
     }
 
+  // Processes forked on this host communicate through shared memory
+  UintegerValue processes;
+  GlobalValue::GetValueByName ("SharedMemoryProcesses", processes);
+  if (processes.Get () > 0)
+    {
+      g_parallelCommunicationInterface = new SharedMemoryInterface (nullMessage);
+    }
+  else if (nullMessage)
+    {
+      g_parallelCommunicationInterface = new NullMessageMpiInterface ();
+    }
+  else
+    {
+      g_parallelCommunicationInterface = new GrantedTimeWindowMpiInterface ();
+    }
+
   g_parallelCommunicationInterface->Enable (pargc, pargv);
 }
 
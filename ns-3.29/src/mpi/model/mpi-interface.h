@@ -45,7 +45,10 @@ class ParallelCommunicationInterface;
  * that interface.  This singleton is responsible for instantiating an
  * instance of the communication interface based on
  * SimulatorImplementationType attribute in ns3::GlobalValues.  The
- * attribute must be set before Enable is invoked.
+ * attribute must be set before Enable is invoked.  When the
+ * SharedMemoryProcesses GlobalValue is not 0, Enable forks the
+ * processes of the simulation on this host, which communicate through
+ * shared memory instead of MPI.
  */
 class MpiInterface
 {
@@ -32,6 +32,7 @@
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 
 #ifdef NS3_MPI
 #include <mpi.h>
@@ -88,6 +89,7 @@ uint32_t              NullMessageMpiInterface::g_numNeighbors = 0;
 bool                  NullMessageMpiInterface::g_initialized = false;
 bool                  NullMessageMpiInterface::g_enabled = false;
 std::list<NullMessageSentBuffer> NullMessageMpiInterface::g_pendingTx;
+std::vector<uint8_t*> NullMessageMpiInterface::g_freeBuffers;
 
 MPI_Request* NullMessageMpiInterface::g_requests;
 char**       NullMessageMpiInterface::g_pRxBuffers;
@@ -214,16 +216,22 @@ NullMessageMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t
   std::list<NullMessageSentBuffer>::reverse_iterator iter = g_pendingTx.rbegin (); // Points to the last element
 
   uint32_t serializedSize = p->GetSerializedSize ();
-  uint32_t bufferSize = serializedSize + ( 2 * sizeof (uint64_t) ) + ( 2 * sizeof (uint32_t) );
-  uint8_t* buffer =  new uint8_t[bufferSize];
+  uint32_t bufferSize = serializedSize + ( 4 * sizeof (uint64_t) ) + ( 2 * sizeof (uint32_t) );
+  NS_ABORT_MSG_IF (bufferSize > NULL_MESSAGE_MAX_MPI_MSG_SIZE,
+                   "Packet of " << serializedSize << " bytes larger than the MPI messages");
+  uint8_t* buffer = AllocateBuffer ();
   iter->SetBuffer (buffer);
   // Add the time, dest node and dest device
   uint64_t t = rxTime.GetInteger ();
   uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
   *pTime++ = t;
 
-  Time guarantee_update = NullMessageSimulatorImpl::GetInstance ()->CalculateGuaranteeTime (nodeSysId);
+  Time guarantee_update;
+  Time idle;
+  NullMessageSimulatorImpl::GetInstance ()->NotifyPacketSent (nodeSysId, rxTime, guarantee_update, idle);
   *pTime++ = guarantee_update.GetTimeStep ();
+  *pTime++ = idle.GetTimeStep ();
+  *pTime++ = NullMessageSimulatorImpl::GetInstance ()->GetSafeTime ().GetTimeStep ();
 
   uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
   *pData++ = node;
@@ -234,15 +242,14 @@ NullMessageMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t
   MPI_Isend (reinterpret_cast<void *> (iter->GetBuffer ()), bufferSize, MPI_CHAR, nodeSysId,
              0, MPI_COMM_WORLD, (iter->GetRequest ()));
 
-  NullMessageSimulatorImpl::GetInstance ()->RescheduleNullMessageEvent (nodeSysId);
-
 #endif
 }
 
 void
-NullMessageMpiInterface::SendNullMessage (const Time& guarantee_update, Ptr<RemoteChannelBundle> bundle)
+NullMessageMpiInterface::SendNullMessage (const Time& guarantee_update, const Time& idle, const Time& safeTime,
+                                          Ptr<RemoteChannelBundle> bundle)
 {
-  NS_LOG_FUNCTION (guarantee_update.GetTimeStep () << bundle);
+  NS_LOG_FUNCTION (guarantee_update.GetTimeStep () << idle.GetTimeStep () << safeTime.GetTimeStep () << bundle);
 
   NS_ASSERT (g_enabled);
 
@@ -252,13 +259,15 @@ NullMessageMpiInterface::SendNullMessage (const Time& guarantee_update, Ptr<Remo
   g_pendingTx.push_back (sendBuf);
   std::list<NullMessageSentBuffer>::reverse_iterator iter = g_pendingTx.rbegin (); // Points to the last element
 
-  uint32_t bufferSize = 2 * sizeof (uint64_t) + 2 * sizeof (uint32_t);
-  uint8_t* buffer =  new uint8_t[bufferSize];
+  uint32_t bufferSize = 4 * sizeof (uint64_t) + 2 * sizeof (uint32_t);
+  uint8_t* buffer = AllocateBuffer ();
   iter->SetBuffer (buffer);
   // Add the time, dest node and dest device
   uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
   *pTime++ = 0;
   *pTime++ = guarantee_update.GetInteger ();
+  *pTime++ = idle.GetInteger ();
+  *pTime++ = safeTime.GetInteger ();
   uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
   *pData++ = 0;
   *pData++ = 0;
@@ -271,6 +280,22 @@ NullMessageMpiInterface::SendNullMessage (const Time& guarantee_update, Ptr<Remo
 #endif
 }
 
+uint8_t*
+NullMessageMpiInterface::AllocateBuffer (void)
+{
+#ifdef NS3_MPI
+  if (g_freeBuffers.empty ())
+    {
+      return new uint8_t[NULL_MESSAGE_MAX_MPI_MSG_SIZE];
+    }
+  uint8_t* buffer = g_freeBuffers.back ();
+  g_freeBuffers.pop_back ();
+  return buffer;
+#else
+  return 0;
+#endif
+}
+
 void
 NullMessageMpiInterface::ReceiveMessagesBlocking ()
 {
@@ -334,6 +359,8 @@ NullMessageMpiInterface::ReceiveMessages (bool blocking)
           uint64_t* pTime = reinterpret_cast<uint64_t *> (g_pRxBuffers[index]);
           uint64_t time = *pTime++;
           uint64_t guaranteeUpdate = *pTime++;
+          uint64_t idle = *pTime++;
+          uint64_t safeTime = *pTime++;
 
           uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
           uint32_t node = *pData++;
@@ -344,7 +371,8 @@ NullMessageMpiInterface::ReceiveMessages (bool blocking)
           // rxtime == 0 means this is a Null Message
           if (rxTime > Time (0))
             {
-              count -= sizeof (time) + sizeof (guaranteeUpdate) + sizeof (node) + sizeof (dev);
+              count -= sizeof (time) + sizeof (guaranteeUpdate) + sizeof (idle) + sizeof (safeTime)
+                + sizeof (node) + sizeof (dev);
 
               Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (pData), count, true);
 
@@ -374,6 +402,15 @@ NullMessageMpiInterface::ReceiveMessages (bool blocking)
           NS_ASSERT (bundle);
 
           bundle->SetGuaranteeTime (Time (guaranteeUpdate));
+          bundle->SetIdleTime (Time (idle), Time (safeTime));
+          if (rxTime > Time (0))
+            {
+              bundle->NotifyPacketReceived ();
+            }
+          else
+            {
+              bundle->NotifyNullMessageReceived ();
+            }
 
           // Re-queue the next read
           MPI_Irecv (g_pRxBuffers[index], NULL_MESSAGE_MAX_MPI_MSG_SIZE, MPI_CHAR, status.MPI_SOURCE, 0,
@@ -407,7 +444,9 @@ NullMessageMpiInterface::TestSendComplete ()
       std::list<NullMessageSentBuffer>::iterator current = iter; // Save current for erasing
       ++iter; // Advance to next
       if (flag)
-        { // This message is complete
+        { // This message is complete, keep its buffer for the next ones
+          g_freeBuffers.push_back (current->GetBuffer ());
+          current->SetBuffer (0);
           g_pendingTx.erase (current);
         }
     }
@@ -449,6 +488,11 @@ NullMessageMpiInterface::Disable ()
       delete [] g_requests;
 
       g_pendingTx.clear ();
+      for (uint32_t i = 0; i < g_freeBuffers.size (); ++i)
+        {
+          delete [] g_freeBuffers[i];
+        }
+      g_freeBuffers.clear ();
 
       g_enabled = false;
       g_initialized = false;
@@ -34,6 +34,7 @@ typedef void* MPI_Request;
 #endif
 
 #include <list>
+#include <vector>
 
 namespace ns3 {
 
@@ -135,6 +136,8 @@ public:
    *
    * uint64_t time the packed should be delivered
    * uint64_t guarantee time for the Null Message algorithm.
+   * uint64_t idle time for the Null Message algorithm.
+   * uint64_t safe time of the sender.
    * uint32_t node id of destination
    * unit32_t dev id on destination
    * uint8_t[] serialized packet
@@ -142,6 +145,8 @@ public:
   virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
   /**
    * \param guaranteeUpdate guarantee update time for the Null Message
+   * \param idle idle time for the Null Message
+   * \param safeTime safe time of this task
    * \bundle the destination bundle for the Null Message.
    *
    * \brief Send a Null Message to across the specified bundle.  
@@ -161,10 +166,13 @@ public:
    *
    * uint64_t 0 must be zero for Null Message
    * uint64_t guarantee time
+   * uint64_t idle time
+   * uint64_t safe time
    * uint32_t 0 must be zero for Null Message
    * uint32_t 0 must be zero for Null Message
    */
-  static void SendNullMessage (const Time& guaranteeUpdate, Ptr<RemoteChannelBundle> bundle);
+  static void SendNullMessage (const Time& guaranteeUpdate, const Time& idle, const Time& safeTime,
+                               Ptr<RemoteChannelBundle> bundle);
   /**
    * Non-blocking check for received messages complete.  Will
    * receive all messages that are queued up locally.
@@ -199,6 +207,12 @@ private:
    */
   static void ReceiveMessages (bool blocking = false);
 
+  /**
+   * \return a send buffer of NULL_MESSAGE_MAX_MPI_MSG_SIZE bytes,
+   * reused from a completed send if possible
+   */
+  static uint8_t* AllocateBuffer (void);
+
   // System ID (rank) for this task
   static uint32_t g_sid;
 
@@ -219,6 +233,9 @@ private:
 
   // List of pending non-blocking sends
   static std::list<NullMessageSentBuffer> g_pendingTx;
+
+  // Buffers of the completed sends
+  static std::vector<uint8_t*> g_freeBuffers;
 };
 
 } // namespace ns3
@@ -22,6 +22,7 @@
 #include "null-message-simulator-impl.h"
 
 #include "null-message-mpi-interface.h"
+#include "shared-memory-interface.h"
 #include "remote-channel-bundle-manager.h"
 #include "remote-channel-bundle.h"
 #include "mpi-interface.h"
@@ -32,6 +33,7 @@
 #include <ns3/channel.h>
 #include <ns3/node-container.h>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
 #include <ns3/ptr.h>
 #include <ns3/pointer.h>
 #include <ns3/assert.h>
@@ -41,6 +43,7 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <sstream>
 
 namespace ns3 {
 
@@ -61,13 +64,18 @@ NullMessageSimulatorImpl::GetTypeId (void)
                    DoubleValue (1.0),
                    MakeDoubleAccessor (&NullMessageSimulatorImpl::m_schedulerTune),
                    MakeDoubleChecker<double> (0.01,1.0))
+    .AddAttribute ("ReportNullMessages",
+                   "Print at Destroy the number of Null Messages this task sent, "
+                   "suppressed and received on every remote channel bundle.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NullMessageSimulatorImpl::m_reportNullMessages),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 NullMessageSimulatorImpl::NullMessageSimulatorImpl ()
 {
-#ifdef NS3_MPI
   NS_LOG_FUNCTION (this);
 
   m_myId = MpiInterface::GetSystemId ();
@@ -83,17 +91,17 @@ NullMessageSimulatorImpl::NullMessageSimulatorImpl ()
   m_currentUid = 0;
   m_currentTs = 0;
   m_currentContext = Simulator::NO_CONTEXT;
+  m_eventCount = 0;
   m_unscheduledEvents = 0;
   m_events = 0;
 
   m_safeTime = Seconds (0);
+  m_nextNullMessage = 0;
+  m_parkedNullMessages = 0;
+  m_reportNullMessages = false;
 
   NS_ASSERT (g_instance == 0);
   g_instance = this;
-
-#else
-  NS_FATAL_ERROR ("Can't use Null Message simulator without MPI compiled in");
-#endif
 }
 
 NullMessageSimulatorImpl::~NullMessageSimulatorImpl ()
@@ -131,6 +139,15 @@ NullMessageSimulatorImpl::Destroy ()
         }
     }
 
+  if (m_reportNullMessages)
+    {
+      // one write, the tasks share the standard error
+      std::ostringstream oss;
+      RemoteChannelBundleManager::PrintStatistics (m_myId, oss);
+      std::cerr << oss.str () << std::flush;
+    }
+
+  m_nextNullMessage = 0;
   RemoteChannelBundleManager::Destroy();
   MpiInterface::Destroy ();
 }
@@ -202,7 +219,10 @@ NullMessageSimulatorImpl::CalculateLookAhead (void)
     }
 
   // Completed setup of remote channel bundles.  Setup send and receive buffers.
-  NullMessageMpiInterface::InitializeSendReceiveBuffers ();
+  if (!SharedMemoryInterface::IsActive ())
+    {
+      NullMessageMpiInterface::InitializeSendReceiveBuffers ();
+    }
 
   // Initialized to 0 as we don't have a simulation start time.
   m_safeTime = Time (0);
@@ -239,6 +259,7 @@ NullMessageSimulatorImpl::ProcessOneEvent (void)
   NS_LOG_LOGIC ("handle " << next.key.m_ts);
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
+  m_eventCount++;
   m_currentUid = next.key.m_uid;
   next.impl->Invoke ();
   next.impl->Unref ();
@@ -247,7 +268,8 @@ NullMessageSimulatorImpl::ProcessOneEvent (void)
 bool
 NullMessageSimulatorImpl::IsFinished (void) const
 {
-  return m_events->IsEmpty () || m_stop;
+  // Packets may still come from the neighbors
+  return (m_events->IsEmpty () && !m_nextNullMessage) || m_stop;
 }
 
 Time
@@ -255,7 +277,10 @@ NullMessageSimulatorImpl::Next (void) const
 {
   NS_LOG_FUNCTION (this);
 
-  NS_ASSERT (!m_events->IsEmpty ());
+  if (m_events->IsEmpty ())
+    {
+      return GetMaximumSimulationTime ();
+    }
 
   Scheduler::Event ev = m_events->PeekNext ();
   return TimeStep (ev.key.m_ts);
@@ -268,32 +293,41 @@ NullMessageSimulatorImpl::ScheduleNullMessageEvent (Ptr<RemoteChannelBundle> bun
 
   Time delay (m_schedulerTune * bundle->GetDelay ().GetTimeStep ());
 
-  bundle->SetEventId (Simulator::Schedule (delay, &NullMessageSimulatorImpl::NullMessageEventHandler, 
-                                           this, PeekPointer(bundle)));
+  SetNullMessageTime (bundle, Now () + delay);
 }
 
 void
-NullMessageSimulatorImpl::RescheduleNullMessageEvent (Ptr<RemoteChannelBundle> bundle)
+NullMessageSimulatorImpl::SetNullMessageTime (Ptr<RemoteChannelBundle> bundle, Time time)
 {
-  NS_LOG_FUNCTION (this << bundle);
-
-  Simulator::Cancel (bundle->GetEventId ());
+  NS_LOG_FUNCTION (this << bundle << time);
 
-  Time delay (m_schedulerTune * bundle->GetDelay ().GetTimeStep ());
+  Time previous = bundle->GetNullMessageTime ();
+  bundle->SetNullMessageTime (time);
 
-  bundle->SetEventId (Simulator::Schedule (delay, &NullMessageSimulatorImpl::NullMessageEventHandler, 
-                                           this, PeekPointer(bundle)));
+  if (!m_nextNullMessage || time < m_nextNullMessage->GetNullMessageTime ())
+    {
+      m_nextNullMessage = bundle;
+    }
+  else if (bundle == m_nextNullMessage && time > previous)
+    {
+      m_nextNullMessage = RemoteChannelBundleManager::GetNextNullMessage ();
+    }
 }
 
 void
-NullMessageSimulatorImpl::RescheduleNullMessageEvent (uint32_t nodeSysId)
+NullMessageSimulatorImpl::NotifyPacketSent (uint32_t nodeSysId, const Time &rxTime, Time &guarantee, Time &idle)
 {
-  NS_LOG_FUNCTION (this << nodeSysId);
+  NS_LOG_FUNCTION (this << nodeSysId << rxTime);
 
   Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (nodeSysId);
   NS_ASSERT (bundle);
 
-  RescheduleNullMessageEvent (bundle);
+  // The current event may send other packets at this time
+  guarantee = Now () + bundle->GetDelay ();
+  idle = guarantee;
+  bundle->NotifyPacketSent (rxTime, guarantee, idle);
+
+  ScheduleNullMessageEvent (bundle);
 }
 
 void
@@ -310,9 +344,24 @@ NullMessageSimulatorImpl::Run (void)
   while (!IsFinished ())
     {
       Time nextTime = Next ();
+      Time nullMessageTime = m_nextNullMessage ? m_nextNullMessage->GetNullMessageTime ()
+        : GetMaximumSimulationTime ();
 
-      if ( nextTime <= GetSafeTime () )
+      // The events at the time of a Null Message event come first, as
+      // they change the next event time
+      if (nullMessageTime < nextTime && nullMessageTime <= GetSafeTime ())
+        {
+          m_currentTs = nullMessageTime.GetTimeStep ();
+          NullMessageEventHandler (m_nextNullMessage);
+          HandleArrivingMessagesNonBlocking ();
+        }
+      else if (!m_events->IsEmpty () && nextTime <= GetSafeTime ())
         {
+          if (m_parkedNullMessages > 0)
+            {
+              RemoteChannelBundleManager::WakeNullMessageEvents ();
+              m_parkedNullMessages = 0;
+            }
           ProcessOneEvent ();
           HandleArrivingMessagesNonBlocking ();
         }
@@ -329,12 +378,26 @@ NullMessageSimulatorImpl::HandleArrivingMessagesNonBlocking (void)
 {
   NS_LOG_FUNCTION (this);
 
-  NullMessageMpiInterface::ReceiveMessagesNonBlocking ();
+  if (SharedMemoryInterface::IsActive ())
+    {
+      SharedMemoryInterface::ReceiveMessages (false);
+    }
+  else
+    {
+      NullMessageMpiInterface::ReceiveMessagesNonBlocking ();
+    }
 
   CalculateSafeTime ();
 
   // Check for send completes
-  NullMessageMpiInterface::TestSendComplete ();
+  if (SharedMemoryInterface::IsActive ())
+    {
+      SharedMemoryInterface::TestSendComplete ();
+    }
+  else
+    {
+      NullMessageMpiInterface::TestSendComplete ();
+    }
 }
 
 void
@@ -342,12 +405,26 @@ NullMessageSimulatorImpl::HandleArrivingMessagesBlocking (void)
 {
   NS_LOG_FUNCTION (this);
 
-  NullMessageMpiInterface::ReceiveMessagesBlocking ();
+  if (SharedMemoryInterface::IsActive ())
+    {
+      SharedMemoryInterface::ReceiveMessages (true);
+    }
+  else
+    {
+      NullMessageMpiInterface::ReceiveMessagesBlocking ();
+    }
 
   CalculateSafeTime ();
 
   // Check for send completes
-  NullMessageMpiInterface::TestSendComplete ();
+  if (SharedMemoryInterface::IsActive ())
+    {
+      SharedMemoryInterface::TestSendComplete ();
+    }
+  else
+    {
+      NullMessageMpiInterface::TestSendComplete ();
+    }
 }
 
 void
@@ -355,6 +432,13 @@ NullMessageSimulatorImpl::CalculateSafeTime ()
 {
   NS_LOG_FUNCTION (this);
 
+  // The bundles waiting for new times get them
+  if (RemoteChannelBundleManager::UpdateArrivalTimes (Next ()) && m_parkedNullMessages > 0)
+    {
+      RemoteChannelBundleManager::WakeNullMessageEvents ();
+      m_parkedNullMessages = 0;
+    }
+
   m_safeTime = RemoteChannelBundleManager::GetSafeTime ();
   NS_ASSERT (m_safeTime >= Time (m_currentTs));
 }
@@ -575,25 +659,48 @@ NullMessageSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
-Time NullMessageSimulatorImpl::CalculateGuaranteeTime (uint32_t nodeSysId)
+uint64_t
+NullMessageSimulatorImpl::GetEventCount (void) const
 {
-  Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (nodeSysId);
-  NS_ASSERT (bundle);
+  return m_eventCount;
+}
 
-  return Min (NullMessageSimulatorImpl::GetInstance ()->Next (), GetSafeTime ()) + bundle->GetDelay ();
+uint64_t
+NullMessageSimulatorImpl::GetPendingEventCount (void) const
+{
+  return m_unscheduledEvents;
 }
 
-void NullMessageSimulatorImpl::NullMessageEventHandler(RemoteChannelBundle* bundle)
+void
+NullMessageSimulatorImpl::NullMessageEventHandler (Ptr<RemoteChannelBundle> bundle)
 {
   NS_LOG_FUNCTION (this << bundle);
 
-  Time time = Min (Next (), GetSafeTime ()) + bundle->GetDelay ();
-  NullMessageMpiInterface::SendNullMessage (time, bundle);
+  // No packet leaves before the next event or the arrival of one; the
+  // idle time leaves out the packets which the receiver may prompt
+  Time next = Next ();
+  Time guarantee = RemoteChannelBundle::AddDelay (Min (next, GetSafeTime ()), bundle->GetDelay ());
+  Time idle = RemoteChannelBundle::AddDelay (Min (next, RemoteChannelBundleManager::GetArrivalTime (bundle)),
+                                             bundle->GetDelay ());
 
-  ScheduleNullMessageEvent (bundle);
+  if (bundle->Send (guarantee, idle, GetSafeTime ()))
+    {
+      ScheduleNullMessageEvent (bundle);
+    }
+  else if (next > GetSafeTime ())
+    {
+      // Nothing changes until new times arrive
+      SetNullMessageTime (bundle, GetMaximumSimulationTime ());
+      m_parkedNullMessages++;
+    }
+  else
+    {
+      // Nothing changes before the next event
+      Time delay (m_schedulerTune * bundle->GetDelay ().GetTimeStep ());
+      SetNullMessageTime (bundle, Max (Now () + delay, next));
+    }
 }
 
-
 NullMessageSimulatorImpl*
 NullMessageSimulatorImpl::GetInstance (void)
 {
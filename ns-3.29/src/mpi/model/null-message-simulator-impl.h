@@ -71,6 +71,8 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const;
   virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+  virtual uint64_t GetPendingEventCount (void) const;
 
   /**
    * \return singleton instance
@@ -82,6 +84,7 @@ public:
 private:
   friend class NullMessageEvent;
   friend class NullMessageMpiInterface;
+  friend class SharedMemoryInterface;
   friend class RemoteChannelBundleManager;
 
   /**
@@ -108,7 +111,8 @@ private:
   void ProcessOneEvent (void);
 
   /**
-   * \return next local event time.
+   * \return next local event time, or the maximum simulation time if
+   * there is none.
    */
   Time Next (void) const;
 
@@ -132,40 +136,36 @@ private:
   void ScheduleNullMessageEvent (Ptr<RemoteChannelBundle> bundle);
 
   /**
-   * \param bundle Bundle to reschedule Null Message event for
-   *
-   * Reschedule Null Message event for the specified
-   * RemoteChannelBundel.  Existing event will be canceled.
-   */
-  void RescheduleNullMessageEvent (Ptr<RemoteChannelBundle> bundle);
-
-  /**
-   * \param nodeSysId SystemID to reschedule null event for
+   * \param bundle Bundle to schedule Null Message event for
+   * \param time Time of the event, the maximum simulation time for none
    *
-   * Reschedule Null Message event for the RemoteChannelBundel to the
-   * task nodeSysId.  Existing event will be canceled.
+   * Set the time of the Null Message event of the specified
+   * RemoteChannelBundle.  The events are kept out of the event queue,
+   * so that the next event is the next one of the simulation.
    */
-  void RescheduleNullMessageEvent (uint32_t nodeSysId);
+  void SetNullMessageTime (Ptr<RemoteChannelBundle> bundle, Time time);
 
   /**
-   * \param systemId SystemID to compute guarantee time for
-   *
-   * \return Guarantee time
+   * \param nodeSysId SystemID the packet is sent to
+   * \param rxTime Time the packet is received
+   * \param guarantee Returns the guarantee time to send with the packet
+   * \param idle Returns the idle time to send with the packet
    *
-   * Calculate the guarantee time for incoming RemoteChannelBundel
-   * from task nodeSysId.  No message should arrive from task
-   * nodeSysId with a receive time less than the guarantee time.
+   * Record a packet sent to the task nodeSysId, whose times stand for
+   * a Null Message: the Null Message event of the
+   * RemoteChannelBundle to the task is rescheduled.
    */
-  Time CalculateGuaranteeTime (uint32_t systemId);
+  void NotifyPacketSent (uint32_t nodeSysId, const Time &rxTime, Time &guarantee, Time &idle);
 
   /**
-   * \param bundle remote channel bundle to schedule an event for.
+   * \param bundle remote channel bundle to send a Null Message to.
    *
-   * Null message event handler.   Scheduled to send a null message
-   * for the specified bundle at regular intervals.   Will canceled
-   * and rescheduled when packets are sent.
+   * Null message event handler.  Sends a null message for the
+   * specified bundle at regular intervals, unless the bundle already
+   * has its times.  A task which waits for its neighbors then sends
+   * the null messages of the bundle only when it receives new times.
    */
-  void NullMessageEventHandler(RemoteChannelBundle* bundle);
+  void NullMessageEventHandler (Ptr<RemoteChannelBundle> bundle);
 
   typedef std::list<EventId> DestroyEvents;
 
@@ -176,6 +176,8 @@ private:
   uint32_t m_currentUid;
   uint64_t m_currentTs;
   uint32_t m_currentContext;
+  /** The event count. */
+  uint64_t m_eventCount;
   // number of events that have been inserted but not yet scheduled,
   // not counting the "destroy" events; this is used for validation
   int m_unscheduledEvents;
@@ -201,6 +203,21 @@ private:
    */
   double m_schedulerTune;
 
+  /*
+   * The bundle with the earliest Null Message event.
+   */
+  Ptr<RemoteChannelBundle> m_nextNullMessage;
+
+  /*
+   * Number of bundles whose Null Message event waits for new times.
+   */
+  uint32_t m_parkedNullMessages;
+
+  /*
+   * Print the Null Message statistics at Destroy.
+   */
+  bool m_reportNullMessages;
+
   /*
    * Singleton instance.
    */
@@ -74,15 +74,47 @@ RemoteChannelBundleManager::InitializeNullMessageEvents (void)
         iter != g_remoteChannelBundles.end ();
         ++iter )
     {
-      Ptr<RemoteChannelBundle> bundle = iter->second;
-      bundle->Send (bundle->GetDelay ());
-
-      NullMessageSimulatorImpl::GetInstance ()->ScheduleNullMessageEvent (bundle);
+      // The first Null Messages are sent when the simulation starts
+      NullMessageSimulatorImpl::GetInstance ()->SetNullMessageTime (iter->second, Simulator::Now ());
     }
 
   g_initialized = true;
 }
 
+bool
+RemoteChannelBundleManager::UpdateArrivalTimes (Time next)
+{
+  NS_ASSERT (g_initialized);
+
+  // Earliest time this task may send a packet
+  Time send = next;
+  for (RemoteChannelMap::const_iterator kv = g_remoteChannelBundles.begin ();
+       kv != g_remoteChannelBundles.end ();
+       ++kv)
+    {
+      Ptr<RemoteChannelBundle> bundle = kv->second;
+      Time unprompted = Min (bundle->GetIdleTime (), bundle->GetEchoTime ());
+      send = Min (send, Max (bundle->GetGuaranteeTime (), unprompted));
+    }
+
+  bool increased = false;
+  for (RemoteChannelMap::const_iterator kv = g_remoteChannelBundles.begin ();
+       kv != g_remoteChannelBundles.end ();
+       ++kv)
+    {
+      Ptr<RemoteChannelBundle> bundle = kv->second;
+      Time delay = bundle->GetDelay ();
+      Time reply = RemoteChannelBundle::AddDelay (RemoteChannelBundle::AddDelay (send, delay), delay);
+      Time unprompted = Min (bundle->GetIdleTime (), bundle->GetEchoTime ());
+      if (bundle->SetArrivalTime (Max (bundle->GetGuaranteeTime (), Min (unprompted, reply))))
+        {
+          increased = true;
+        }
+    }
+
+  return increased;
+}
+
 Time
 RemoteChannelBundleManager::GetSafeTime (void)
 {
@@ -94,12 +126,81 @@ RemoteChannelBundleManager::GetSafeTime (void)
        kv != g_remoteChannelBundles.end ();
        ++kv)
     {
-      safeTime = Min (safeTime, kv->second->GetGuaranteeTime ());
+      safeTime = Min (safeTime, kv->second->GetArrivalTime ());
     }
 
   return safeTime;
 }
 
+Time
+RemoteChannelBundleManager::GetArrivalTime (Ptr<RemoteChannelBundle> bundle)
+{
+  NS_ASSERT (g_initialized);
+
+  Time arrivalTime = Simulator::GetMaximumSimulationTime ();
+
+  for (RemoteChannelMap::const_iterator kv = g_remoteChannelBundles.begin ();
+       kv != g_remoteChannelBundles.end ();
+       ++kv)
+    {
+      if (kv->second != bundle)
+        {
+          arrivalTime = Min (arrivalTime, kv->second->GetArrivalTime ());
+        }
+    }
+
+  return arrivalTime;
+}
+
+Ptr<RemoteChannelBundle>
+RemoteChannelBundleManager::GetNextNullMessage (void)
+{
+  Ptr<RemoteChannelBundle> next = 0;
+
+  for (RemoteChannelMap::const_iterator kv = g_remoteChannelBundles.begin ();
+       kv != g_remoteChannelBundles.end ();
+       ++kv)
+    {
+      if (!next || kv->second->GetNullMessageTime () < next->GetNullMessageTime ())
+        {
+          next = kv->second;
+        }
+    }
+
+  return next;
+}
+
+void
+RemoteChannelBundleManager::WakeNullMessageEvents (void)
+{
+  for (RemoteChannelMap::const_iterator kv = g_remoteChannelBundles.begin ();
+       kv != g_remoteChannelBundles.end ();
+       ++kv)
+    {
+      if (kv->second->GetNullMessageTime () == Simulator::GetMaximumSimulationTime ())
+        {
+          NullMessageSimulatorImpl::GetInstance ()->SetNullMessageTime (kv->second, Simulator::Now ());
+        }
+    }
+}
+
+void
+RemoteChannelBundleManager::PrintStatistics (uint32_t systemId, std::ostream &os)
+{
+  for (RemoteChannelMap::const_iterator kv = g_remoteChannelBundles.begin ();
+       kv != g_remoteChannelBundles.end ();
+       ++kv)
+    {
+      Ptr<RemoteChannelBundle> bundle = kv->second;
+      os << "Null messages rank " << systemId << " to " << kv->first << ": "
+         << bundle->GetNullMessagesSent () << " sent, "
+         << bundle->GetNullMessagesSuppressed () << " suppressed, "
+         << bundle->GetNullMessagesReceived () << " received, with "
+         << bundle->GetPacketsSent () << " packets sent and "
+         << bundle->GetPacketsReceived () << " received" << std::endl;
+    }
+}
+
 void
 RemoteChannelBundleManager::Destroy (void)
 {
@@ -25,6 +25,7 @@
 #include <ns3/nstime.h>
 #include <ns3/ptr.h>
 #include <map>
+#include <ostream>
 
 namespace ns3 {
 
@@ -64,11 +65,53 @@ public:
    */
   static void InitializeNullMessageEvents (void);
 
+  /**
+   * \param next time of the next local event
+   *
+   * \return true if the arrival time of a bundle increased
+   *
+   * Compute the earliest receive time of the packets still to come on
+   * every bundle.  This task sends no packet before its next event or
+   * the arrival of a packet, and a remote task sends none before its
+   * idle time unless this task sends it one first.  So a bundle is
+   * bounded by the idle time of the remote task, the replies to the
+   * packets it has not received yet, and the replies to the packets
+   * this task is still to send, besides its guarantee time.
+   */
+  static bool UpdateArrivalTimes (Time next);
+
   /**
    * \return safe time across all remote channels.
    */
   static Time GetSafeTime (void);
 
+  /**
+   * \param bundle the bundle to leave out
+   *
+   * \return earliest arrival time of the other bundles
+   */
+  static Time GetArrivalTime (Ptr<RemoteChannelBundle> bundle);
+
+  /**
+   * \return the bundle with the earliest Null Message send event, 0
+   * if there is no bundle
+   */
+  static Ptr<RemoteChannelBundle> GetNextNullMessage (void);
+
+  /**
+   * Schedule now the Null Message events of the bundles which wait
+   * for new times.
+   */
+  static void WakeNullMessageEvents (void);
+
+  /**
+   * \param systemId SystemID of this task
+   * \param os output stream
+   *
+   * Print the Null Message and packet counts of every bundle.
+   */
+  static void PrintStatistics (uint32_t systemId, std::ostream &os);
+
   /**
    * Destroy the singleton.
    */
@@ -22,6 +22,7 @@
 #include "remote-channel-bundle.h"
 
 #include "null-message-mpi-interface.h"
+#include "shared-memory-interface.h"
 #include "null-message-simulator-impl.h"
 
 #include <ns3/simulator.h>
@@ -42,14 +43,34 @@ TypeId RemoteChannelBundle::GetTypeId (void)
 RemoteChannelBundle::RemoteChannelBundle ()
   : m_remoteSystemId (UINT32_MAX),
     m_guaranteeTime (0),
-    m_delay (NS_TIME_INFINITY)
+    m_idleTime (0),
+    m_arrivalTime (0),
+    m_delay (NS_TIME_INFINITY),
+    m_nullMessageTime (NS_TIME_INFINITY),
+    m_sentGuaranteeTime (0),
+    m_sentIdleTime (0),
+    m_nullMessagesSent (0),
+    m_nullMessagesSuppressed (0),
+    m_nullMessagesReceived (0),
+    m_packetsSent (0),
+    m_packetsReceived (0)
 {
 }
 
 RemoteChannelBundle::RemoteChannelBundle (const uint32_t remoteSystemId)
   : m_remoteSystemId (remoteSystemId),
     m_guaranteeTime (0),
-    m_delay (NS_TIME_INFINITY)
+    m_idleTime (0),
+    m_arrivalTime (0),
+    m_delay (NS_TIME_INFINITY),
+    m_nullMessageTime (NS_TIME_INFINITY),
+    m_sentGuaranteeTime (0),
+    m_sentIdleTime (0),
+    m_nullMessagesSent (0),
+    m_nullMessagesSuppressed (0),
+    m_nullMessagesReceived (0),
+    m_packetsSent (0),
+    m_packetsReceived (0)
 {
 }
 
@@ -75,9 +96,56 @@ RemoteChannelBundle::GetGuaranteeTime (void) const
 void
 RemoteChannelBundle::SetGuaranteeTime (Time time)
 {
-  NS_ASSERT (time >= Simulator::Now ());
+  // A packet carries the guarantee time of its send, which may be
+  // lower than the one of an earlier Null Message: that one still holds
+  m_guaranteeTime = Max (m_guaranteeTime, time);
+}
+
+Time
+RemoteChannelBundle::GetIdleTime (void) const
+{
+  return m_idleTime;
+}
 
-  m_guaranteeTime = time;
+void
+RemoteChannelBundle::SetIdleTime (Time idle, Time safeTime)
+{
+  // The remote task computed the idle time with the packets it
+  // received before its safe time, so their replies are bounded by it.
+  // An earlier, later idle time does not cover them.
+  m_idleTime = idle;
+  while (!m_packetsInFlight.empty () && m_packetsInFlight.front ().second < safeTime)
+    {
+      m_packetsInFlight.pop_front ();
+    }
+}
+
+Time
+RemoteChannelBundle::GetEchoTime (void) const
+{
+  if (m_packetsInFlight.empty ())
+    {
+      return NS_TIME_INFINITY;
+    }
+  // A reply crosses the bundle twice after the earliest send
+  return m_packetsInFlight.front ().first + m_delay + m_delay;
+}
+
+Time
+RemoteChannelBundle::GetArrivalTime (void) const
+{
+  return m_arrivalTime;
+}
+
+bool
+RemoteChannelBundle::SetArrivalTime (Time time)
+{
+  if (time > m_arrivalTime)
+    {
+      m_arrivalTime = time;
+      return true;
+    }
+  return false;
 }
 
 Time
@@ -87,15 +155,15 @@ RemoteChannelBundle::GetDelay (void) const
 }
 
 void
-RemoteChannelBundle::SetEventId (EventId id)
+RemoteChannelBundle::SetNullMessageTime (Time time)
 {
-  m_nullEventId = id;
+  m_nullMessageTime = time;
 }
 
-EventId
-RemoteChannelBundle::GetEventId (void) const
+Time
+RemoteChannelBundle::GetNullMessageTime (void) const
 {
-  return m_nullEventId;
+  return m_nullMessageTime;
 }
 
 std::size_t
@@ -104,16 +172,95 @@ RemoteChannelBundle::GetSize (void) const
   return m_channels.size ();
 }
 
-void 
-RemoteChannelBundle::Send(Time time)
+bool
+RemoteChannelBundle::Send (Time guarantee, Time idle, Time safeTime)
 {
-  NullMessageMpiInterface::SendNullMessage (time, this);  
+  if (guarantee <= m_sentGuaranteeTime && idle <= m_sentIdleTime)
+    {
+      m_nullMessagesSuppressed++;
+      return false;
+    }
+  m_sentGuaranteeTime = Max (m_sentGuaranteeTime, guarantee);
+  m_sentIdleTime = Max (m_sentIdleTime, idle);
+  m_nullMessagesSent++;
+
+  if (SharedMemoryInterface::IsActive ())
+    {
+      SharedMemoryInterface::SendNullMessage (guarantee, idle, safeTime, this);
+    }
+  else
+    {
+      NullMessageMpiInterface::SendNullMessage (guarantee, idle, safeTime, this);
+    }
+  return true;
+}
+
+void
+RemoteChannelBundle::NotifyPacketSent (Time rxTime, Time guarantee, Time idle)
+{
+  m_packetsInFlight.push_back (std::make_pair (Simulator::Now (), rxTime));
+  m_sentGuaranteeTime = Max (m_sentGuaranteeTime, guarantee);
+  m_sentIdleTime = Max (m_sentIdleTime, idle);
+  m_packetsSent++;
+}
+
+void
+RemoteChannelBundle::NotifyNullMessageReceived (void)
+{
+  m_nullMessagesReceived++;
+}
+
+void
+RemoteChannelBundle::NotifyPacketReceived (void)
+{
+  m_packetsReceived++;
+}
+
+uint64_t
+RemoteChannelBundle::GetNullMessagesSent (void) const
+{
+  return m_nullMessagesSent;
+}
+
+uint64_t
+RemoteChannelBundle::GetNullMessagesSuppressed (void) const
+{
+  return m_nullMessagesSuppressed;
+}
+
+uint64_t
+RemoteChannelBundle::GetNullMessagesReceived (void) const
+{
+  return m_nullMessagesReceived;
+}
+
+uint64_t
+RemoteChannelBundle::GetPacketsSent (void) const
+{
+  return m_packetsSent;
+}
+
+uint64_t
+RemoteChannelBundle::GetPacketsReceived (void) const
+{
+  return m_packetsReceived;
+}
+
+Time
+RemoteChannelBundle::AddDelay (Time time, Time delay)
+{
+  if (time == NS_TIME_INFINITY)
+    {
+      return time;
+    }
+  return time + delay;
 }
 
 std::ostream& operator<< (std::ostream& out, ns3::RemoteChannelBundle& bundle )
 {
   out << "RemoteChannelBundle Rank = " << bundle.m_remoteSystemId
       << ", GuaranteeTime = "  << bundle.m_guaranteeTime
+      << ", IdleTime = "  << bundle.m_idleTime
       << ", Delay = " << bundle.m_delay << std::endl;
   
   for (std::map < uint32_t, Ptr < Channel > > ::const_iterator pair = bundle.m_channels.begin ();
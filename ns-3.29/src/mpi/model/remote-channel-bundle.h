@@ -28,7 +28,9 @@
 #include <ns3/ptr.h>
 #include <ns3/pointer.h>
 
+#include <deque>
 #include <map>
+#include <utility>
 
 namespace ns3 {
 
@@ -41,6 +43,13 @@ namespace ns3 {
  * in communication with.  These are created and managed by the
  * RemoteChannelBundleManager class.  Stores time information for each
  * bundle.
+ *
+ * Besides the guarantee time, every packet and Null Message from the
+ * remote task carries an idle time, which bounds the packets that the
+ * remote task sends without being prompted by a packet of this task,
+ * and the safe time of the remote task, up to which it has received
+ * the packets of this task.  The bundle keeps the packets sent since,
+ * whose replies may arrive before the idle time.
  */
 class RemoteChannelBundle : public Object
 {
@@ -75,25 +84,65 @@ public:
    * \param guarantee time
    *
    * Set the guarantee time for the bundle.  This should be called
-   * after a packet or Null Message received.
+   * after a packet or Null Message received.  The guarantee time
+   * never decreases.
    */
   void SetGuaranteeTime (Time time);
 
+  /**
+   * \return idle time
+   */
+  Time GetIdleTime (void) const;
+
+  /**
+   * \param idle idle time of the remote task
+   * \param safeTime safe time of the remote task
+   *
+   * Set the idle time for the bundle and forget the packets which the
+   * remote task received before its safe time.  This should be called
+   * after a packet or Null Message received.
+   */
+  void SetIdleTime (Time idle, Time safeTime);
+
+  /**
+   * \return the earliest receive time of a packet the remote task may
+   * send in reply to a packet it has not yet received, or the maximum
+   * simulation time if there is none
+   */
+  Time GetEchoTime (void) const;
+
+  /**
+   * \return the earliest receive time of the packets still to come
+   * from the remote task, computed by RemoteChannelBundleManager
+   */
+  Time GetArrivalTime (void) const;
+
+  /**
+   * \param time earliest receive time of the packets still to come
+   *
+   * The arrival time only increases, as each bound stays true.
+   *
+   * \return true if the arrival time increased
+   */
+  bool SetArrivalTime (Time time);
+
   /**
    * \return the minimum delay along any channel in this bundle
    */
   Time GetDelay (void) const;
 
   /**
-   * Set the event ID of the Null Message send event current scheduled
-   * for this channel.
+   * \param time the time of the Null Message send event
+   *
+   * Set the time of the Null Message send event for this bundle, the
+   * maximum simulation time if none is scheduled.
    */
-  void SetEventId (EventId id);
+  void SetNullMessageTime (Time time);
 
   /**
-   * \return the event ID of the Null Message send event for this bundle
+   * \return the time of the Null Message send event for this bundle
    */
-  EventId GetEventId (void) const;
+  Time GetNullMessageTime (void) const;
 
   /**
    * \return number of NS3 channels in this bundle
@@ -101,13 +150,70 @@ public:
   std::size_t GetSize (void) const;
 
   /**
-   * \param time 
+   * \param guarantee the guarantee time for the remote task
+   * \param idle the idle time for the remote task
+   * \param safeTime the safe time of this task
+   *
+   * Send Null Message to the remote task associated with this bundle,
+   * unless it has already received these times in an earlier packet or
+   * Null Message.
+   *
+   * \return true if the Null Message was sent, false if suppressed
+   */
+  bool Send (Time guarantee, Time idle, Time safeTime);
+
+  /**
+   * \param rxTime the receive time of the packet
+   * \param guarantee the guarantee time sent with the packet
+   * \param idle the idle time sent with the packet
    *
-   * Send Null Message to the remote task associated with this bundle.
-   * Message will be delivered at current simulation time + the time
-   * passed in.
+   * Record a packet sent to the remote task.
+   */
+  void NotifyPacketSent (Time rxTime, Time guarantee, Time idle);
+
+  /**
+   * Count a Null Message received from the remote task.
+   */
+  void NotifyNullMessageReceived (void);
+
+  /**
+   * Count a packet received from the remote task.
    */
-  void Send(Time time);
+  void NotifyPacketReceived (void);
+
+  /**
+   * \return number of Null Messages sent to the remote task
+   */
+  uint64_t GetNullMessagesSent (void) const;
+
+  /**
+   * \return number of Null Messages not sent because the remote task
+   * already had their times
+   */
+  uint64_t GetNullMessagesSuppressed (void) const;
+
+  /**
+   * \return number of Null Messages received from the remote task
+   */
+  uint64_t GetNullMessagesReceived (void) const;
+
+  /**
+   * \return number of packets sent to the remote task
+   */
+  uint64_t GetPacketsSent (void) const;
+
+  /**
+   * \return number of packets received from the remote task
+   */
+  uint64_t GetPacketsReceived (void) const;
+
+  /**
+   * \param time a time
+   * \param delay a delay
+   * \return the time plus the delay, or the maximum simulation time
+   * if the time is the maximum simulation time
+   */
+  static Time AddDelay (Time time, Time delay);
 
   /**
    * Output for debugging purposes.
@@ -134,15 +240,49 @@ private:
    */
   Time m_guaranteeTime;
 
+  /*
+   * Idle time of MPI task remote_rank.  No PacketMessage will arrive
+   * with a ReceiveTime less than this, except the replies to the
+   * packets sent to remote_rank.
+   */
+  Time m_idleTime;
+
+  /*
+   * Earliest receive time of the packets still to come, from the
+   * guarantee time, the idle time and the packets sent.
+   */
+  Time m_arrivalTime;
+
+  /*
+   * Send and receive times of the packets sent to remote_rank which
+   * it may not have received yet, in the order they were sent.
+   */
+  std::deque<std::pair<Time, Time> > m_packetsInFlight;
+
   /*
    * Delay for this Channel bundle.   min link delay over all incoming channels;
    */
   Time m_delay;
 
   /*
-   * Event scheduled to send Null Message for this bundle.
+   * Time of the Null Message send event for this bundle.
+   */
+  Time m_nullMessageTime;
+
+  /*
+   * Last guarantee and idle times sent to remote_rank.
+   */
+  Time m_sentGuaranteeTime;
+  Time m_sentIdleTime;
+
+  /*
+   * Null Message and packet statistics.
    */
-  EventId m_nullEventId;
+  uint64_t m_nullMessagesSent;
+  uint64_t m_nullMessagesSuppressed;
+  uint64_t m_nullMessagesReceived;
+  uint64_t m_packetsSent;
+  uint64_t m_packetsReceived;
 
 };
 
@@ -0,0 +1,622 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "shared-memory-interface.h"
+#include "mpi-receiver.h"
+#include "null-message-simulator-impl.h"
+#include "remote-channel-bundle.h"
+#include "remote-channel-bundle-manager.h"
+
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SharedMemoryInterface");
+
+/**
+ * \ingroup mpi
+ * The number of processes of a parallel simulation over shared memory.
+ */
+static GlobalValue g_sharedMemoryProcesses = GlobalValue ("SharedMemoryProcesses",
+                                                          "The number of processes which MpiInterface::Enable "
+                                                          "forks to run the parallel simulation over shared "
+                                                          "memory, 0 to run it over MPI",
+                                                          UintegerValue (0),
+                                                          MakeUintegerChecker<uint32_t> ());
+
+/**
+ * \ingroup mpi
+ * The size of the ring buffers between the processes.
+ */
+static GlobalValue g_sharedMemoryRingSize = GlobalValue ("SharedMemoryRingSize",
+                                                         "The size in bytes of the ring buffer which carries "
+                                                         "the messages from a process to another",
+                                                         UintegerValue (1 << 20),
+                                                         MakeUintegerChecker<uint32_t> (1 << 14));
+
+namespace {
+
+/** Size of the record header of a message in a ring: length and type. */
+const uint32_t RECORD_HEADER_SIZE = 8;
+/** Size of the times of a Null Message: guarantee, idle and safe time. */
+const uint32_t NULL_MESSAGE_SIZE = 24;
+/** Size of the header of a packet: receive time, Null Message times, node and device. */
+const uint32_t PACKET_HEADER_SIZE = 8 + NULL_MESSAGE_SIZE + 8;
+/** Largest contribution to an AllGather. */
+const uint32_t GATHER_DATA_SIZE = 48;
+
+/** Type of the messages in the rings. */
+enum MessageType
+{
+  PACKET = 0,        //!< A packet, with the Null Message times in null message mode.
+  NULL_MESSAGE = 1,  //!< The guarantee, idle and safe times.
+  WRAP = 2           //!< Skip to the start of the ring.
+};
+
+/** Read and write positions of a ring, in separate cache lines. */
+struct RingHeader
+{
+  std::atomic<uint64_t> head;  //!< Bytes read by the consumer.
+  uint8_t pad1[56];            //!< Padding.
+  std::atomic<uint64_t> tail;  //!< Bytes written by the producer.
+  uint8_t pad2[56];            //!< Padding.
+};
+
+/** The contribution of a task to an AllGather. */
+struct GatherSlot
+{
+  std::atomic<uint64_t> round;        //!< Number of the AllGather.
+  uint8_t data[GATHER_DATA_SIZE];     //!< Contribution.
+  uint8_t pad[8];                     //!< Padding.
+};
+
+/** The state shared by all the tasks. */
+struct Control
+{
+  std::atomic<uint32_t> failed;  //!< Set by the task 0 when a task failed.
+  uint8_t pad[60];               //!< Padding.
+};
+
+/**
+ * \param size a size in bytes
+ * \return the size rounded up to 8 bytes
+ */
+inline uint64_t
+Align (uint64_t size)
+{
+  return (size + 7) & ~uint64_t (7);
+}
+
+} // unnamed namespace
+
+uint32_t              SharedMemoryInterface::m_sid = 0;
+uint32_t              SharedMemoryInterface::m_size = 1;
+bool                  SharedMemoryInterface::m_enabled = false;
+bool                  SharedMemoryInterface::m_nullMessage = false;
+uint32_t              SharedMemoryInterface::m_rxCount = 0;
+uint32_t              SharedMemoryInterface::m_txCount = 0;
+uint8_t*              SharedMemoryInterface::m_memory = 0;
+uint64_t              SharedMemoryInterface::m_memorySize = 0;
+uint64_t              SharedMemoryInterface::m_ringSize = 0;
+uint64_t              SharedMemoryInterface::m_round = 0;
+std::vector<int>      SharedMemoryInterface::m_pids;
+int                   SharedMemoryInterface::m_parentPid = 0;
+std::vector<std::deque<std::vector<uint8_t> > > SharedMemoryInterface::m_pendingTx;
+
+/**
+ * \return the control block of the shared memory
+ * \param memory the shared memory
+ */
+static Control*
+GetControl (uint8_t* memory)
+{
+  return reinterpret_cast<Control *> (memory);
+}
+
+/**
+ * \return the slots of an AllGather
+ * \param memory the shared memory
+ * \param size the number of tasks
+ * \param round the number of the AllGather
+ */
+static GatherSlot*
+GetSlots (uint8_t* memory, uint32_t size, uint64_t round)
+{
+  return reinterpret_cast<GatherSlot *> (memory + sizeof (Control)) + (round % 2) * size;
+}
+
+/**
+ * \return the header of the ring from a task to another
+ * \param memory the shared memory
+ * \param size the number of tasks
+ * \param from the producer
+ * \param to the consumer
+ */
+static RingHeader*
+GetRing (uint8_t* memory, uint32_t size, uint32_t from, uint32_t to)
+{
+  uint8_t* rings = memory + sizeof (Control) + 2 * size * sizeof (GatherSlot);
+  return reinterpret_cast<RingHeader *> (rings) + from * size + to;
+}
+
+/**
+ * \return the data of the ring from a task to another
+ * \param memory the shared memory
+ * \param size the number of tasks
+ * \param ringSize the size of the data of a ring
+ * \param from the producer
+ * \param to the consumer
+ */
+static uint8_t*
+GetRingData (uint8_t* memory, uint32_t size, uint64_t ringSize, uint32_t from, uint32_t to)
+{
+  uint8_t* data = reinterpret_cast<uint8_t *> (GetRing (memory, size, size, 0));
+  return data + (from * size + to) * ringSize;
+}
+
+SharedMemoryInterface::SharedMemoryInterface (bool nullMessage)
+{
+  NS_LOG_FUNCTION (this << nullMessage);
+  m_nullMessage = nullMessage;
+}
+
+void
+SharedMemoryInterface::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  m_pendingTx.assign (m_size, std::deque<std::vector<uint8_t> > ());
+}
+
+uint32_t
+SharedMemoryInterface::GetSystemId ()
+{
+  return m_sid;
+}
+
+uint32_t
+SharedMemoryInterface::GetSize ()
+{
+  return m_size;
+}
+
+bool
+SharedMemoryInterface::IsEnabled ()
+{
+  return m_enabled;
+}
+
+bool
+SharedMemoryInterface::IsActive ()
+{
+  return m_enabled;
+}
+
+uint32_t
+SharedMemoryInterface::GetRxCount ()
+{
+  return m_rxCount;
+}
+
+uint32_t
+SharedMemoryInterface::GetTxCount ()
+{
+  return m_txCount;
+}
+
+void
+SharedMemoryInterface::Enable (int* pargc, char*** pargv)
+{
+  NS_LOG_FUNCTION (this << pargc << pargv);
+
+  UintegerValue processes;
+  g_sharedMemoryProcesses.GetValue (processes);
+  UintegerValue ringSize;
+  g_sharedMemoryRingSize.GetValue (ringSize);
+  m_size = std::max<uint32_t> (processes.Get (), 1);
+  m_ringSize = Align (ringSize.Get ());
+
+  // The control block, two rounds of AllGather slots, the ring
+  // headers and the ring data; the rings to self are left unused
+  m_memorySize = sizeof (Control) + 2 * m_size * sizeof (GatherSlot)
+    + uint64_t (m_size) * m_size * (sizeof (RingHeader) + m_ringSize);
+  void* memory = mmap (0, m_memorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  NS_ABORT_MSG_IF (memory == MAP_FAILED, "Cannot map " << m_memorySize << " bytes of shared memory");
+  m_memory = static_cast<uint8_t *> (memory);
+  new (&GetControl (m_memory)->failed) std::atomic<uint32_t> (0);
+  for (uint32_t i = 0; i < 2 * m_size; ++i)
+    {
+      new (&GetSlots (m_memory, m_size, 0)[i].round) std::atomic<uint64_t> (0);
+    }
+  for (uint32_t from = 0; from < m_size; ++from)
+    {
+      for (uint32_t to = 0; to < m_size; ++to)
+        {
+          RingHeader* ring = GetRing (m_memory, m_size, from, to);
+          new (&ring->head) std::atomic<uint64_t> (0);
+          new (&ring->tail) std::atomic<uint64_t> (0);
+        }
+    }
+  m_pendingTx.assign (m_size, std::deque<std::vector<uint8_t> > ());
+  m_round = 0;
+  m_rxCount = 0;
+  m_txCount = 0;
+
+  // Whatever is buffered would be printed by every task
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+  m_sid = 0;
+  m_parentPid = getpid ();
+  m_pids.assign (m_size, 0);
+  for (uint32_t rank = 1; rank < m_size; ++rank)
+    {
+      pid_t pid = fork ();
+      NS_ABORT_MSG_IF (pid < 0, "Cannot fork task " << rank);
+      if (pid == 0)
+        {
+          m_sid = rank;
+          m_pids.clear ();
+          break;
+        }
+      m_pids[rank] = pid;
+    }
+  m_enabled = true;
+}
+
+void
+SharedMemoryInterface::Disable ()
+{
+  NS_LOG_FUNCTION (this);
+
+  bool failed = false;
+  for (uint32_t rank = 1; rank < m_pids.size (); ++rank)
+    {
+      if (m_pids[rank] == 0)
+        {
+          continue;
+        }
+      int status = 0;
+      waitpid (m_pids[rank], &status, 0);
+      if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          std::cerr << "Task " << rank << " failed" << std::endl;
+          failed = true;
+        }
+    }
+  m_pids.clear ();
+  m_pendingTx.clear ();
+  munmap (m_memory, m_memorySize);
+  m_memory = 0;
+  m_enabled = false;
+  NS_ABORT_MSG_IF (failed, "The parallel simulation failed");
+}
+
+void
+SharedMemoryInterface::CheckTasks ()
+{
+  if (m_sid != 0)
+    {
+      NS_ABORT_MSG_IF (GetControl (m_memory)->failed.load (std::memory_order_relaxed) != 0
+                       || getppid () != m_parentPid,
+                       "Task " << m_sid << ": another task failed");
+      return;
+    }
+  for (uint32_t rank = 1; rank < m_pids.size (); ++rank)
+    {
+      int status = 0;
+      if (m_pids[rank] == 0 || waitpid (m_pids[rank], &status, WNOHANG) != m_pids[rank])
+        {
+          continue;
+        }
+      // A task may be done before the task 0
+      m_pids[rank] = 0;
+      if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          GetControl (m_memory)->failed.store (1, std::memory_order_relaxed);
+          NS_FATAL_ERROR ("Task " << rank << " failed");
+        }
+    }
+}
+
+uint8_t*
+SharedMemoryInterface::Reserve (uint32_t rank, uint64_t recordSize)
+{
+  RingHeader* ring = GetRing (m_memory, m_size, m_sid, rank);
+  uint8_t* data = GetRingData (m_memory, m_size, m_ringSize, m_sid, rank);
+  uint64_t tail = ring->tail.load (std::memory_order_relaxed);
+  uint64_t head = ring->head.load (std::memory_order_acquire);
+  uint64_t position = tail % m_ringSize;
+  // A message is never split across the end of the ring
+  uint64_t skip = m_ringSize - position < recordSize ? m_ringSize - position : 0;
+  if (tail + skip + recordSize - head > m_ringSize)
+    {
+      return 0;
+    }
+  if (skip)
+    {
+      uint32_t* record = reinterpret_cast<uint32_t *> (data + position);
+      record[0] = 0;
+      record[1] = WRAP;
+      ring->tail.store (tail + skip, std::memory_order_release);
+      position = 0;
+    }
+  return data + position;
+}
+
+void
+SharedMemoryInterface::Commit (uint32_t rank, uint64_t recordSize)
+{
+  RingHeader* ring = GetRing (m_memory, m_size, m_sid, rank);
+  ring->tail.store (ring->tail.load (std::memory_order_relaxed) + recordSize, std::memory_order_release);
+}
+
+void
+SharedMemoryInterface::Send (uint32_t rank, uint32_t type, const uint8_t* header, uint32_t headerSize, Ptr<Packet> p)
+{
+  uint32_t packetSize = p ? p->GetSerializedSize () : 0;
+  uint32_t length = headerSize + packetSize;
+  uint64_t recordSize = RECORD_HEADER_SIZE + Align (length);
+  NS_ABORT_MSG_IF (recordSize > m_ringSize / 2,
+                   "Message of " << length << " bytes too large for the shared memory rings");
+
+  uint8_t* record = 0;
+  std::vector<uint8_t> message;
+  // Keep the order of the messages waiting for room
+  if (m_pendingTx[rank].empty ())
+    {
+      record = Reserve (rank, recordSize);
+    }
+  if (record == 0)
+    {
+      message.resize (recordSize);
+      record = &message[0];
+    }
+  uint32_t* pRecord = reinterpret_cast<uint32_t *> (record);
+  pRecord[0] = length;
+  pRecord[1] = type;
+  std::memcpy (record + RECORD_HEADER_SIZE, header, headerSize);
+  if (p)
+    {
+      p->Serialize (record + RECORD_HEADER_SIZE + headerSize, packetSize);
+    }
+  if (message.empty ())
+    {
+      Commit (rank, recordSize);
+    }
+  else
+    {
+      m_pendingTx[rank].push_back (message);
+    }
+}
+
+void
+SharedMemoryInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev)
+{
+  NS_LOG_FUNCTION (this << p << rxTime.GetTimeStep () << node << dev);
+  NS_ASSERT (m_enabled);
+
+  // Find the system id for the destination node
+  uint32_t nodeSysId = NodeList::GetNode (node)->GetSystemId ();
+
+  uint8_t header[PACKET_HEADER_SIZE];
+  uint64_t* pTime = reinterpret_cast<uint64_t *> (header);
+  *pTime++ = rxTime.GetInteger ();
+  Time guarantee;
+  Time idle;
+  Time safeTime;
+  if (m_nullMessage)
+    {
+      NullMessageSimulatorImpl* impl = NullMessageSimulatorImpl::GetInstance ();
+      impl->NotifyPacketSent (nodeSysId, rxTime, guarantee, idle);
+      safeTime = impl->GetSafeTime ();
+    }
+  *pTime++ = guarantee.GetInteger ();
+  *pTime++ = idle.GetInteger ();
+  *pTime++ = safeTime.GetInteger ();
+  uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
+  *pData++ = node;
+  *pData++ = dev;
+  Send (nodeSysId, PACKET, header, PACKET_HEADER_SIZE, p);
+  m_txCount++;
+}
+
+void
+SharedMemoryInterface::SendNullMessage (const Time& guaranteeUpdate, const Time& idle, const Time& safeTime,
+                                        Ptr<RemoteChannelBundle> bundle)
+{
+  NS_LOG_FUNCTION (guaranteeUpdate.GetTimeStep () << idle.GetTimeStep () << safeTime.GetTimeStep () << bundle);
+  NS_ASSERT (m_enabled);
+
+  uint64_t times[3] = { static_cast<uint64_t> (guaranteeUpdate.GetInteger ()),
+                        static_cast<uint64_t> (idle.GetInteger ()),
+                        static_cast<uint64_t> (safeTime.GetInteger ()) };
+  Send (bundle->GetSystemId (), NULL_MESSAGE, reinterpret_cast<uint8_t *> (times), NULL_MESSAGE_SIZE, 0);
+}
+
+uint32_t
+SharedMemoryInterface::Pop (uint32_t rank)
+{
+  RingHeader* ring = GetRing (m_memory, m_size, rank, m_sid);
+  uint8_t* data = GetRingData (m_memory, m_size, m_ringSize, rank, m_sid);
+  uint64_t head = ring->head.load (std::memory_order_relaxed);
+  uint64_t tail = ring->tail.load (std::memory_order_acquire);
+  uint32_t messages = 0;
+  while (head != tail)
+    {
+      uint64_t position = head % m_ringSize;
+      uint32_t* record = reinterpret_cast<uint32_t *> (data + position);
+      uint32_t length = record[0];
+      uint32_t type = record[1];
+      if (type == WRAP)
+        {
+          head += m_ringSize - position;
+          continue;
+        }
+      uint8_t* message = data + position + RECORD_HEADER_SIZE;
+      head += RECORD_HEADER_SIZE + Align (length);
+      messages++;
+
+      uint64_t* pTime = reinterpret_cast<uint64_t *> (message);
+      if (type == NULL_MESSAGE)
+        {
+          Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (rank);
+          NS_ASSERT (bundle);
+          bundle->SetGuaranteeTime (Time (pTime[0]));
+          bundle->SetIdleTime (Time (pTime[1]), Time (pTime[2]));
+          bundle->NotifyNullMessageReceived ();
+          continue;
+        }
+
+      m_rxCount++;
+      Time rxTime (*pTime++);
+      uint64_t guaranteeUpdate = *pTime++;
+      uint64_t idle = *pTime++;
+      uint64_t safeTime = *pTime++;
+      uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
+      uint32_t node = *pData++;
+      uint32_t dev  = *pData++;
+
+      Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (pData), length - PACKET_HEADER_SIZE, true);
+
+      // Find the correct node/device to schedule receive event
+      Ptr<Node> pNode = NodeList::GetNode (node);
+      Ptr<MpiReceiver> pMpiRec = 0;
+      uint32_t nDevices = pNode->GetNDevices ();
+      for (uint32_t i = 0; i < nDevices; ++i)
+        {
+          Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
+          if (pThisDev->GetIfIndex () == dev)
+            {
+              pMpiRec = pThisDev->GetObject<MpiReceiver> ();
+              break;
+            }
+        }
+      NS_ASSERT (pNode && pMpiRec);
+
+      // Schedule the rx event
+      Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
+                                      &MpiReceiver::Receive, pMpiRec, p);
+
+      if (m_nullMessage)
+        {
+          Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (rank);
+          NS_ASSERT (bundle);
+          bundle->SetGuaranteeTime (Time (guaranteeUpdate));
+          bundle->SetIdleTime (Time (idle), Time (safeTime));
+          bundle->NotifyPacketReceived ();
+        }
+    }
+  ring->head.store (head, std::memory_order_release);
+  return messages;
+}
+
+void
+SharedMemoryInterface::ReceiveMessages (bool blocking)
+{
+  NS_LOG_FUNCTION (blocking);
+  NS_ASSERT (m_enabled);
+
+  while (true)
+    {
+      uint32_t messages = 0;
+      for (uint32_t rank = 0; rank < m_size; ++rank)
+        {
+          if (rank != m_sid)
+            {
+              messages += Pop (rank);
+            }
+        }
+      if (messages || !blocking)
+        {
+          break;
+        }
+      TestSendComplete ();
+      CheckTasks ();
+      sched_yield ();
+    }
+}
+
+void
+SharedMemoryInterface::TestSendComplete ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  for (uint32_t rank = 0; rank < m_pendingTx.size (); ++rank)
+    {
+      std::deque<std::vector<uint8_t> > &pending = m_pendingTx[rank];
+      while (!pending.empty ())
+        {
+          const std::vector<uint8_t> &message = pending.front ();
+          uint8_t* record = Reserve (rank, message.size ());
+          if (record == 0)
+            {
+              break;
+            }
+          std::memcpy (record, &message[0], message.size ());
+          Commit (rank, message.size ());
+          pending.pop_front ();
+        }
+    }
+}
+
+void
+SharedMemoryInterface::AllGather (const void* data, void* result, uint32_t size)
+{
+  NS_LOG_FUNCTION (data << result << size);
+  NS_ASSERT (m_enabled);
+  NS_ASSERT (size <= GATHER_DATA_SIZE);
+
+  // The slots alternate between two rounds: no task can write the
+  // next round but one before every task read this one
+  uint64_t round = ++m_round;
+  GatherSlot* slots = GetSlots (m_memory, m_size, round);
+  std::memcpy (slots[m_sid].data, data, size);
+  slots[m_sid].round.store (round, std::memory_order_release);
+  for (uint32_t rank = 0; rank < m_size; ++rank)
+    {
+      while (slots[rank].round.load (std::memory_order_acquire) < round)
+        {
+          ReceiveMessages ();
+          TestSendComplete ();
+          CheckTasks ();
+          sched_yield ();
+        }
+      std::memcpy (static_cast<uint8_t *> (result) + rank * size, slots[rank].data, size);
+    }
+}
+
+} // namespace ns3
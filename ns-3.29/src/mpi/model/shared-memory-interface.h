@@ -0,0 +1,211 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_SHARED_MEMORY_INTERFACE_H
+#define NS3_SHARED_MEMORY_INTERFACE_H
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include "parallel-communication-interface.h"
+
+namespace ns3 {
+
+class RemoteChannelBundle;
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Interface between ns-3 and processes of the same host,
+ * without MPI
+ *
+ * Enable forks the processes of the parallel simulation, as many as
+ * the "SharedMemoryProcesses" GlobalValue, which then run the rest of
+ * the program like MPI tasks.  The calling process is the task 0.
+ * Every ordered pair of tasks has a single producer, single consumer
+ * ring buffer in memory shared before the fork, which carries the
+ * packets and null messages from one task to the other.  A message
+ * which does not fit in a full ring is queued by the sender until the
+ * receiver makes room.
+ *
+ * The interface serves both the DistributedSimulatorImpl, whose LBTS
+ * is computed with AllGather, and the NullMessageSimulatorImpl.
+ * Disable waits, in the task 0, for the end of the other tasks, and
+ * the task 0 aborts the simulation if another task fails.
+ */
+class SharedMemoryInterface : public ParallelCommunicationInterface
+{
+public:
+  /**
+   * \param nullMessage true if the tasks synchronize with null messages
+   */
+  SharedMemoryInterface (bool nullMessage);
+
+  /**
+   * Delete the messages waiting for room
+   */
+  virtual void Destroy ();
+  /**
+   * \return task number
+   */
+  virtual uint32_t GetSystemId ();
+  /**
+   * \return number of tasks
+   */
+  virtual uint32_t GetSize ();
+  /**
+   * \return true if the tasks are running
+   */
+  virtual bool IsEnabled ();
+  /**
+   * \param pargc number of command line arguments
+   * \param pargv command line arguments
+   *
+   * Maps the ring buffers and forks the tasks
+   */
+  virtual void Enable (int* pargc, char*** pargv);
+  /**
+   * Waits, in the task 0, for the end of the other tasks and unmaps
+   * the ring buffers
+   */
+  virtual void Disable ();
+  /**
+   * \param p packet to send
+   * \param rxTime received time at destination node
+   * \param node destination node
+   * \param dev destination device
+   *
+   * Serialize and send a packet to the specified node and net device
+   */
+  virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+
+  /**
+   * \return true if the parallel simulation runs on this interface
+   */
+  static bool IsActive ();
+  /**
+   * \param guaranteeUpdate guarantee update time for the receiver
+   * \param idle idle time for the receiver
+   * \param safeTime safe time of this task
+   * \param bundle the bundle of channels to the receiver
+   *
+   * Send a null message to the task of a bundle
+   */
+  static void SendNullMessage (const Time& guaranteeUpdate, const Time& idle, const Time& safeTime,
+                               Ptr<RemoteChannelBundle> bundle);
+  /**
+   * \param blocking wait for a message if none has arrived
+   *
+   * Schedule the reception of the packets which arrived and apply the
+   * guarantee updates
+   */
+  static void ReceiveMessages (bool blocking = false);
+  /**
+   * Move the messages waiting for room to the ring buffers
+   */
+  static void TestSendComplete ();
+  /**
+   * \return received count in packets
+   */
+  static uint32_t GetRxCount ();
+  /**
+   * \return transmitted count in packets
+   */
+  static uint32_t GetTxCount ();
+  /**
+   * \param data the contribution of this task
+   * \param result the contributions of all the tasks, by task number
+   * \param size the size of a contribution, at most 48 bytes
+   *
+   * Gather the contributions of all the tasks in all of them.  The
+   * messages which arrive meanwhile are received.
+   */
+  static void AllGather (const void* data, void* result, uint32_t size);
+
+private:
+  /**
+   * \param rank the destination task
+   * \param type the type of message
+   * \param header the header of the message
+   * \param headerSize the size of the header
+   * \param p the packet of the message, may be null
+   *
+   * Write a message to the ring buffer to a task, or queue it if the
+   * ring is full
+   */
+  static void Send (uint32_t rank, uint32_t type, const uint8_t* header, uint32_t headerSize, Ptr<Packet> p);
+  /**
+   * \param rank the destination task
+   * \param recordSize the size of the message in the ring
+   * \return where to write the message in the ring to the task, or 0
+   * if the ring is full
+   */
+  static uint8_t* Reserve (uint32_t rank, uint64_t recordSize);
+  /**
+   * \param rank the destination task
+   * \param recordSize the size of the message written at Reserve
+   *
+   * Make the message visible to the task
+   */
+  static void Commit (uint32_t rank, uint64_t recordSize);
+  /**
+   * \param rank the source task
+   * \return the number of messages read from the ring of the task
+   */
+  static uint32_t Pop (uint32_t rank);
+  /**
+   * Abort if a task failed
+   */
+  static void CheckTasks ();
+
+  static uint32_t m_sid;
+  static uint32_t m_size;
+  static bool     m_enabled;
+  static bool     m_nullMessage;
+
+  // Total packets received
+  static uint32_t m_rxCount;
+
+  // Total packets sent
+  static uint32_t m_txCount;
+
+  // The shared memory and its size
+  static uint8_t* m_memory;
+  static uint64_t m_memorySize;
+
+  // Size of the data of a ring buffer
+  static uint64_t m_ringSize;
+
+  // Number of the last AllGather
+  static uint64_t m_round;
+
+  // Process ids of the tasks, in the task 0
+  static std::vector<int> m_pids;
+
+  // Process id of the task 0
+  static int m_parentPid;
+
+  // Messages waiting for room in the ring to each task
+  static std::vector<std::deque<std::vector<uint8_t> > > m_pendingTx;
+};
+
+} // namespace ns3
+
+#endif /* NS3_SHARED_MEMORY_INTERFACE_H */
@@ -21,6 +21,14 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
+#include <algorithm>
+
+#if defined (__AVX2__)
+#include <immintrin.h>
+#elif defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
                 ", zero end="<<m_zeroAreaEnd<<", count="<<m_data->m_count<<", size="<<m_data->m_size<<   \
@@ -43,6 +51,110 @@ static struct Zeroes
   const uint32_t size;  //!< buffer size
 } g_zeroes; //!< Zero-filled buffer
 
+/**
+ * \ingroup packet
+ * Fold a sum of 16-bit words into 16 bits, one's complement style.
+ * \param [in] sum The sum.
+ * \returns The folded sum.
+ */
+inline uint32_t
+ChecksumFold (uint64_t sum)
+{
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return sum;
+}
+
+/**
+ * \ingroup packet
+ * Add up the 16-bit words of a contiguous memory area, in the
+ * little endian order of Buffer::Iterator::ReadU16.
+ *
+ * A trailing odd byte counts as the low order byte of a last word.
+ * The wide loops rely on the byte order independence of the one's
+ * complement sum (RFC 1071): the words are summed in any order and in
+ * any lane width, and the result is folded at the end.
+ *
+ * \param [in] data The start of the area.
+ * \param [in] size The size of the area, in bytes.
+ * \returns The folded sum.
+ */
+uint32_t
+ChecksumAdd (const uint8_t *data, uint32_t size)
+{
+  uint64_t sum = 0;
+
+#if defined (__AVX2__) || defined (__SSE2__)
+  // Widen the 16-bit words into 32-bit lanes.  A lane gains at most
+  // 2 * 0xffff per block, so it cannot overflow within MAX_BLOCKS blocks.
+  const uint32_t MAX_BLOCKS = 16384;
+#if defined (__AVX2__)
+  const uint32_t BLOCK = 32;
+  const __m256i zero = _mm256_setzero_si256 ();
+#else
+  const uint32_t BLOCK = 16;
+  const __m128i zero = _mm_setzero_si128 ();
+#endif
+  while (size >= BLOCK)
+    {
+      uint32_t blocks = std::min (size / BLOCK, MAX_BLOCKS);
+      uint32_t lanes[BLOCK / 4];
+#if defined (__AVX2__)
+      __m256i acc = _mm256_setzero_si256 ();
+      for (uint32_t b = 0; b < blocks; b++, data += BLOCK)
+        {
+          __m256i v = _mm256_loadu_si256 ((const __m256i *) data);
+          acc = _mm256_add_epi32 (acc, _mm256_unpacklo_epi16 (v, zero));
+          acc = _mm256_add_epi32 (acc, _mm256_unpackhi_epi16 (v, zero));
+        }
+      _mm256_storeu_si256 ((__m256i *) lanes, acc);
+#else
+      __m128i acc = _mm_setzero_si128 ();
+      for (uint32_t b = 0; b < blocks; b++, data += BLOCK)
+        {
+          __m128i v = _mm_loadu_si128 ((const __m128i *) data);
+          acc = _mm_add_epi32 (acc, _mm_unpacklo_epi16 (v, zero));
+          acc = _mm_add_epi32 (acc, _mm_unpackhi_epi16 (v, zero));
+        }
+      _mm_storeu_si128 ((__m128i *) lanes, acc);
+#endif
+      for (uint32_t l = 0; l < BLOCK / 4; l++)
+        {
+          sum += lanes[l];
+        }
+      size -= blocks * BLOCK;
+    }
+#endif
+
+  // Scalar fallback, and the tail of the vector loop: native 32-bit words.
+  uint64_t native = 0;
+  for (; size >= 4; size -= 4, data += 4)
+    {
+      uint32_t word;
+      std::memcpy (&word, data, 4);
+      native += word;
+    }
+  native = ChecksumFold (native);
+#if defined (__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  native = ((native & 0xff) << 8) | (native >> 8);
+#endif
+  sum += native;
+
+  if (size >= 2)
+    {
+      sum += data[0] | (data[1] << 8);
+      data += 2;
+      size -= 2;
+    }
+  if (size == 1)
+    {
+      sum += data[0];
+    }
+  return ChecksumFold (sum);
+}
+
 }
 
 namespace ns3 {
@@ -1140,18 +1252,36 @@ uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
-  /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
-
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
-
-  if (size & 1)
-    sum += ReadU8 ();
+  NS_ASSERT_MSG (m_current >= m_dataStart &&
+                 m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
+  /* see RFC 1071 to understand this code.  The bytes before and after
+   * the zero area are summed as two contiguous areas; the zero area adds
+   * nothing, but its size decides whether the words of the second area
+   * start at an odd offset, in which case the bytes of its sum are swapped.
+   */
+  uint64_t sum = initialChecksum;
+  uint32_t start = m_current;
+  uint32_t end = m_current + size;
+
+  if (start < m_zeroStart)
+    {
+      sum += ChecksumAdd (&m_data[start], std::min (end, m_zeroStart) - start);
+    }
+  if (end > m_zeroEnd)
+    {
+      uint32_t areaStart = std::max (start, m_zeroEnd);
+      uint32_t areaSum = ChecksumAdd (&m_data[areaStart - (m_zeroEnd - m_zeroStart)],
+                                      end - areaStart);
+      if ((areaStart - start) & 1)
+        {
+          areaSum = ((areaSum & 0xff) << 8) | (areaSum >> 8);
+        }
+      sum += areaSum;
+    }
+  m_current = end;
 
-  while (sum >> 16)
-    sum = (sum & 0xffff) + (sum >> 16);
-  return ~sum;
+  return ~ChecksumFold (sum);
 }
 
 uint32_t 
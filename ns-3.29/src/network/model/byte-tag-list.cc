@@ -159,6 +159,10 @@ ByteTagList::ByteTagList (const ByteTagList &o)
     {
       m_data->count++;
     }
+  else
+    {
+      std::memcpy (m_inline, o.m_inline, m_used);
+    }
 }
 ByteTagList &
 ByteTagList::operator = (const ByteTagList &o)
@@ -178,6 +182,10 @@ ByteTagList::operator = (const ByteTagList &o)
     {
       m_data->count++;
     }
+  else
+    {
+      std::memcpy (m_inline, o.m_inline, m_used);
+    }
   return *this;
 }
 ByteTagList::~ByteTagList ()
@@ -194,10 +202,15 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
   NS_LOG_FUNCTION (this << tid << bufferSize << start << end);
   uint32_t spaceNeeded = m_used + bufferSize + 4 + 4 + 4 + 4;
   NS_ASSERT (m_used <= spaceNeeded);
-  if (m_data == 0)
+  uint8_t *data = m_inline;
+  if (m_data == 0 && spaceNeeded <= INLINE_SIZE)
+    {
+      // still fits in the list itself
+    }
+  else if (m_data == 0)
     {
       m_data = Allocate (spaceNeeded);
-      m_used = 0;
+      std::memcpy (&m_data->data, m_inline, m_used);
     } 
   else if (m_data->size < spaceNeeded ||
            (m_data->count != 1 && m_data->dirty != m_used))
@@ -207,8 +220,12 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
       Deallocate (m_data);
       m_data = newData;
     }
-  TagBuffer tag = TagBuffer (&m_data->data[m_used], 
-                             &m_data->data[spaceNeeded]);
+  if (m_data != 0)
+    {
+      data = m_data->data;
+    }
+  TagBuffer tag = TagBuffer (&data[m_used], 
+                             &data[spaceNeeded]);
   tag.WriteU32 (tid.GetUid ());
   tag.WriteU32 (bufferSize);
   tag.WriteU32 (start - m_adjustment);
@@ -222,7 +239,10 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
       m_maxEnd = end - m_adjustment;
     }
   m_used = spaceNeeded;
-  m_data->dirty = m_used;
+  if (m_data != 0)
+    {
+      m_data->dirty = m_used;
+    }
   return tag;
 }
 
@@ -264,14 +284,12 @@ ByteTagList::Iterator
 ByteTagList::Begin (int32_t offsetStart, int32_t offsetEnd) const
 {
   NS_LOG_FUNCTION (this << offsetStart << offsetEnd);
-  if (m_data == 0)
+  if (m_data == 0 && m_used == 0)
     {
       return Iterator (0, 0, offsetStart, offsetEnd, 0);
     }
-  else
-    {
-      return Iterator (m_data->data, &m_data->data[m_used], offsetStart, offsetEnd, m_adjustment);
-    }
+  uint8_t *data = m_data != 0 ? m_data->data : const_cast<uint8_t *> (m_inline);
+  return Iterator (data, &data[m_used], offsetStart, offsetEnd, m_adjustment);
 }
 
 void 
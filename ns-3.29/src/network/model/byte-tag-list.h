@@ -48,6 +48,9 @@ struct ByteTagListData;
  *   - The struct ByteTagListData structure which contains the tag byte buffer
  *     is shared and, thus, reference-counted. This data structure is unshared
  *     as-needed to emulate COW semantics.
+ *   - As long as the tags fit in #INLINE_SIZE bytes, the byte buffer is
+ *     stored in the ByteTagList itself and no ByteTagListData is allocated.
+ *     Such a small buffer is copied along with the list rather than shared.
  *
  *   - Each tag tags a unique set of bytes identified by the pair of offsets
  *     (start,end). These offsets are relative to the start of the packet
@@ -231,6 +234,9 @@ private:
    */
   void AddAtStart (int32_t prependOffset);
 
+  /** Size of the tag byte buffer stored in the list itself, in bytes. */
+  static const uint32_t INLINE_SIZE = 48;
+
 private:
   /**
    * \brief Returns an iterator pointing to the very first tag in this list.
@@ -257,6 +263,7 @@ private:
   int32_t m_adjustment; //!< adjustment to byte tag offsets
   uint32_t m_used; //!< the number of used bytes in the buffer
   struct ByteTagListData *m_data; //!< the ByteTagListData structure
+  uint8_t m_inline[INLINE_SIZE]; //!< the tag byte buffer, while m_data is 0
 };
 
 void
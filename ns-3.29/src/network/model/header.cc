@@ -42,6 +42,20 @@ Header::GetTypeId (void)
   return tid;
 }
 
+Header *
+Header::Copy (void) const
+{
+  return 0;
+}
+
+bool
+Header::Assign (const Header &header)
+{
+  NS_FATAL_ERROR ("Header " << GetInstanceTypeId ().GetName ()
+                  << " does not support Assign");
+  return false;
+}
+
 std::ostream & operator << (std::ostream &os, const Header &header)
 {
   header.Print (os);
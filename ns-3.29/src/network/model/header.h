@@ -101,6 +101,31 @@ public:
    * i.e.: (field1 val1 field2 val2 field3 val3) field4 val4 field5 val5
    */
   virtual void Print (std::ostream &os) const = 0;
+  /**
+   * \returns a copy of this header allocated with new, or 0.
+   *
+   * When Packet::EnableLazyHeaders has been called, Packet::AddHeader
+   * keeps such a copy on the packet instead of serializing the header
+   * into the byte buffer, and a matching Packet::RemoveHeader or
+   * Packet::PeekHeader hands its fields back through Assign.
+   * Headers which return 0, the default, are always serialized.
+   */
+  virtual Header *Copy (void) const;
+  /**
+   * \param header a header of the same dynamic type as this one,
+   *        obtained from Copy.
+   *
+   * \returns true if the fields were copied, false if this header must
+   *          be deserialized from the bytes instead.
+   *
+   * Copy the wire fields of the input header into this header, as if this
+   * header had deserialized the bytes the input header serializes to.
+   * Headers whose deserialization depends on more than those bytes, for
+   * instance to verify a checksum over the payload, return false and the
+   * packet serializes its pending headers and deserializes this one.
+   * Headers which override Copy must override this method too.
+   */
+  virtual bool Assign (const Header &header);
 };
 
 
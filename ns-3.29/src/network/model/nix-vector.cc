@@ -160,6 +160,13 @@ uint32_t
 NixVector::ExtractNeighborIndex (uint32_t numberOfBits)
 {
   NS_LOG_FUNCTION (this << numberOfBits);
+  return ExtractNeighborIndex (numberOfBits, m_used);
+}
+
+uint32_t
+NixVector::ExtractNeighborIndex (uint32_t numberOfBits, uint32_t &usedBits) const
+{
+  NS_LOG_FUNCTION (this << numberOfBits << usedBits);
 
   if (numberOfBits > 32)
     {
@@ -168,7 +175,7 @@ NixVector::ExtractNeighborIndex (uint32_t numberOfBits)
 
   uint32_t vectorIndex = 0;
   uint32_t extractedBits = 0;
-  uint32_t totalRemainingBits = GetRemainingBits ();
+  uint32_t totalRemainingBits = GetRemainingBits (usedBits);
 
   if (numberOfBits > totalRemainingBits)
     {
@@ -198,7 +205,7 @@ NixVector::ExtractNeighborIndex (uint32_t numberOfBits)
                                             - (numberOfBits - (totalRemainingBits % 32)));
           extractedBits |= (m_nixVector.at (vectorIndex-1) 
                             >> (32 - (numberOfBits - (totalRemainingBits % 32))));
-          m_used += numberOfBits;
+          usedBits += numberOfBits;
           return extractedBits;
         }
     }
@@ -206,7 +213,7 @@ NixVector::ExtractNeighborIndex (uint32_t numberOfBits)
   // we don't span more than one
   extractedBits = m_nixVector.at (vectorIndex) << (32 - (totalRemainingBits % 32));
   extractedBits = extractedBits >> (32 - (numberOfBits));
-  m_used += numberOfBits;
+  usedBits += numberOfBits;
   return extractedBits;
 }
 
@@ -225,6 +232,13 @@ uint32_t
 NixVector::Serialize (uint32_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << buffer << maxSize);
+  return Serialize (buffer, maxSize, m_used);
+}
+
+uint32_t
+NixVector::Serialize (uint32_t* buffer, uint32_t maxSize, uint32_t usedBits) const
+{
+  NS_LOG_FUNCTION (this << buffer << maxSize << usedBits);
   uint32_t* p = buffer;
   uint32_t size = 0;
 
@@ -232,7 +246,7 @@ NixVector::Serialize (uint32_t* buffer, uint32_t maxSize) const
     {
       size += 4;
       // grab number of used bits
-      *p++ = m_used;
+      *p++ = usedBits;
     }
   else
     {
@@ -354,11 +368,25 @@ NixVector::DumpNixVector (std::ostream &os) const
 }
 
 uint32_t 
-NixVector::GetRemainingBits (void)
+NixVector::GetRemainingBits (void) const
 {
   NS_LOG_FUNCTION (this);
 
-  return (m_totalBitSize - m_used);
+  return GetRemainingBits (m_used);
+}
+
+uint32_t 
+NixVector::GetRemainingBits (uint32_t usedBits) const
+{
+  NS_LOG_FUNCTION (this << usedBits);
+
+  return (m_totalBitSize - usedBits);
+}
+
+uint32_t 
+NixVector::GetUsedBits (void) const
+{
+  return m_used;
 }
 
 uint32_t
@@ -58,6 +58,12 @@ namespace ns3 {
  * to use.  The number of bits used would then be 
  * incremented accordingly, and the packet would be 
  * routed.
+ *
+ * A nix-vector built by the routing protocol is shared, unchanged,
+ * by all the packets following its path: each Packet keeps its own
+ * count of the bits used and extracts the neighbor-indexes through
+ * the const ExtractNeighborIndex, so that routing a packet allocates
+ * nothing.
  */
 
 class NixVector : public SimpleRefCount<NixVector>
@@ -108,11 +114,34 @@ public:
    * bits gives you 2^32 possible neighbors.
    */
   uint32_t ExtractNeighborIndex (uint32_t numberOfBits);
+  /**
+   * \return the neighbor index
+   *
+   * \param numberOfBits the number of bits to extract from the vector
+   * \param usedBits the number of bits already used, incremented by
+   *        numberOfBits
+   *
+   * Extracts the neighbor index at the position usedBits rather
+   * than at the position of this nix-vector, which is unchanged and
+   * may be shared by several packets.
+   */
+  uint32_t ExtractNeighborIndex (uint32_t numberOfBits, uint32_t &usedBits) const;
   /**
    * \return number of bits remaining in the
    *         nix-vector (ie m_total - m_used)
    */
-  uint32_t GetRemainingBits (void);
+  uint32_t GetRemainingBits (void) const;
+  /**
+   * \return number of bits remaining in the
+   *         nix-vector after usedBits bits
+   *
+   * \param usedBits the number of bits already used
+   */
+  uint32_t GetRemainingBits (uint32_t usedBits) const;
+  /**
+   * \return number of bits already used (ie m_used)
+   */
+  uint32_t GetUsedBits (void) const;
   /**
    * \return the number of bytes required for serialization
    */
@@ -128,6 +157,15 @@ public:
    * buffer parameter.
    */
   uint32_t Serialize (uint32_t* buffer, uint32_t maxSize) const;
+  /**
+   * \return zero if buffer not large enough
+   *
+   * \param buffer points to serialization buffer
+   * \param maxSize max number of bytes to write
+   * \param usedBits the number of used bits to write in place of
+   *        those of this nix-vector
+   */
+  uint32_t Serialize (uint32_t* buffer, uint32_t maxSize, uint32_t usedBits) const;
   /**
    * \return zero if a complete nix-vector is not deserialized
    *
@@ -51,6 +51,79 @@ PacketTagList::CreateTagData (size_t dataSize)
   return tag;
 }
 
+PacketTagList::TagData *
+PacketTagList::CreateInlineTagData (size_t dataSize)
+{
+  if (dataSize > INLINE_TAG_SIZE || m_inlineUsed == (1U << INLINE_TAGS) - 1)
+    {
+      return 0;
+    }
+  uint32_t slot = 0;
+  while (m_inlineUsed & (1U << slot))
+    {
+      slot++;
+    }
+  m_inlineUsed |= 1U << slot;
+  // The matching destruction is in DeleteTagData
+
+  TagData * tag = new (m_slots[slot]) TagData;
+  tag->size = dataSize;
+  return tag;
+}
+
+void
+PacketTagList::CopyInline (PacketTagList const &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  NS_ASSERT (m_next == 0 && m_inlineUsed == 0);
+
+  struct TagData ** prevNext = &m_next;
+  struct TagData  * cur      =  o.m_next;
+  while (cur != 0 && o.IsInline (cur))
+    {
+      // use the same slot as the original
+      uint32_t slot = (reinterpret_cast<uint64_t *> (cur) - o.m_slots[0]) / SLOT_WORDS;
+      m_inlineUsed |= 1U << slot;
+      struct TagData * copy = new (m_slots[slot]) TagData;
+      copy->tid = cur->tid;
+      copy->count = 1;
+      copy->size = cur->size;
+      memcpy (copy->data, cur->data, copy->size);
+      *prevNext = copy;
+      prevNext = &copy->next;
+      cur = cur->next;
+    }
+  // share the rest
+  *prevNext = cur;
+  if (cur != 0)
+    {
+      cur->count++;
+    }
+}
+
+void
+PacketTagList::SpillInline (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  struct TagData ** prevNext = &m_next;
+  struct TagData  * cur      =  m_next;
+  while (m_inlineUsed != 0)
+    {
+      NS_ASSERT (IsInline (cur));
+      struct TagData * copy = CreateTagData (cur->size);
+      copy->tid = cur->tid;
+      copy->count = 1;
+      copy->size = cur->size;
+      memcpy (copy->data, cur->data, copy->size);
+      copy->next = cur->next;
+      *prevNext = copy;
+      prevNext = &copy->next;
+      DeleteTagData (cur);
+      cur = copy->next;
+    }
+}
+
 bool
 PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 {
@@ -194,8 +267,7 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
   if (preMerge)
     {
       // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
+      DeleteTagData (cur);
     }
   else
     {
@@ -266,14 +338,22 @@ PacketTagList::Add (const Tag &tag) const
       NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (),
                      "Error: cannot add the same kind of tag twice.");
     }
-  struct TagData * head = CreateTagData (tag.GetSerializedSize ());
+  PacketTagList * list = const_cast<PacketTagList *> (this);
+  uint32_t size = tag.GetSerializedSize ();
+  struct TagData * head = list->CreateInlineTagData (size);
+  if (head == 0)
+    {
+      // keep the inline tags at the head of the list
+      list->SpillInline ();
+      head = CreateTagData (size);
+    }
   head->count = 1;
   head->next = 0;
   head->tid = tag.GetInstanceTypeId ();
   head->next = m_next;
   tag.Serialize (TagBuffer (head->data, head->data + head->size));
 
-  const_cast<PacketTagList *> (this)->m_next = head;
+  list->m_next = head;
 }
 
 bool
@@ -119,6 +119,18 @@ class Tag;
  *       The portion of the list between the first branch and the target is
  *       shared. This portion is copied before the #Remove or #Replace is
  *       performed.
+ *
+ * \par <b> Inline tags </b>
+ *   - The first #INLINE_TAGS tags of at most #INLINE_TAG_SIZE bytes are
+ *     not allocated: their TagData live in slots of the PacketTagList
+ *     itself.  Packets usually carry a few small tags, which are then
+ *     added and removed without touching the heap.
+ *   - Inline TagData are never shared.  They always form the head of
+ *     the list, with \c count = 1, before any heap allocated TagData.
+ *     Copy and assignment copy them into the slots of the new list and
+ *     share the heap allocated rest of the list as described above.
+ *   - A tag which does not fit in a free slot first moves the inline
+ *     TagData to the heap, so that inline TagData remain at the head.
  */
 class PacketTagList 
 {
@@ -177,6 +189,11 @@ public:
    */
   inline ~PacketTagList ();
 
+  /** Number of tags a PacketTagList stores without allocation. */
+  static const uint32_t INLINE_TAGS = 4;
+  /** Largest serialized size of a tag stored without allocation. */
+  static const uint32_t INLINE_TAG_SIZE = 20;
+
   /**
    * Add a tag to the head of this branch.
    *
@@ -228,6 +245,33 @@ private:
    */
   static
   TagData * CreateTagData (size_t dataSize);
+  /**
+   * Construct a TagData in a free slot of this list.
+   * \param [in] dataSize The serialized size of the Tag.
+   * \returns The newly constructed TagData object, or 0 if no slot is
+   *          free or the Tag is too large.
+   */
+  TagData * CreateInlineTagData (size_t dataSize);
+  /**
+   * Destroy a TagData, releasing its slot or its memory.
+   * \param [in] tag The TagData.
+   */
+  inline void DeleteTagData (TagData *tag);
+  /**
+   * \param [in] tag A TagData.
+   * \returns True if \pname{tag} lives in a slot of this list.
+   */
+  inline bool IsInline (const TagData *tag) const;
+  /**
+   * Copy the list, copying the inline TagData into the slots of this
+   * list and sharing the rest.  This list must be empty.
+   * \param [in] o The PacketTagList to copy.
+   */
+  void CopyInline (PacketTagList const &o);
+  /**
+   * Move the inline TagData to the heap.
+   */
+  void SpillInline (void);
   
   /**
    * Typedef of method function pointer for copy-on-write operations
@@ -282,6 +326,12 @@ private:
    * Pointer to first \ref TagData on the list
    */
   struct TagData *m_next;
+  /** Bitmap of the slots in use. */
+  uint32_t m_inlineUsed;
+  /** Size of a slot in 64 bit words: a TagData with INLINE_TAG_SIZE bytes of data. */
+  static const uint32_t SLOT_WORDS = (sizeof (TagData) - 1 + INLINE_TAG_SIZE + 7) / 8;
+  /** Storage of the inline TagData. */
+  uint64_t m_slots[INLINE_TAGS][SLOT_WORDS];
 };
 
 } // namespace ns3
@@ -293,14 +343,21 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_next (),
+    m_inlineUsed (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_next (o.m_next),
+    m_inlineUsed (0)
 {
-  if (m_next != 0)
+  if (o.m_inlineUsed != 0)
+    {
+      m_next = 0;
+      CopyInline (o);
+    }
+  else if (m_next != 0)
     {
       m_next->count++;
     }
@@ -315,6 +372,11 @@ PacketTagList::operator = (PacketTagList const &o)
       return *this;
     }
   RemoveAll ();
+  if (o.m_inlineUsed != 0)
+    {
+      CopyInline (o);
+      return *this;
+    }
   m_next = o.m_next;
   if (m_next != 0) 
     {
@@ -328,11 +390,41 @@ PacketTagList::~PacketTagList ()
   RemoveAll ();
 }
 
+bool
+PacketTagList::IsInline (const TagData *tag) const
+{
+  const uint64_t *p = reinterpret_cast<const uint64_t *> (tag);
+  return p >= m_slots[0] && p < m_slots[INLINE_TAGS];
+}
+
+void
+PacketTagList::DeleteTagData (TagData *tag)
+{
+  if (IsInline (tag))
+    {
+      m_inlineUsed &= ~(1U << ((reinterpret_cast<uint64_t *> (tag) - m_slots[0]) / SLOT_WORDS));
+      tag->~TagData ();
+    }
+  else
+    {
+      tag->~TagData ();
+      std::free (tag);
+    }
+}
+
 void
 PacketTagList::RemoveAll (void)
 {
+  struct TagData *cur = m_next;
+  // the inline tags come first, and are not shared
+  while (m_inlineUsed != 0)
+    {
+      struct TagData *next = cur->next;
+      DeleteTagData (cur);
+      cur = next;
+    }
   struct TagData *prev = 0;
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+  for (; cur != 0; cur = cur->next)
     {
       cur->count--;
       if (cur->count > 0) 
@@ -23,12 +23,14 @@
 #include "ns3/simulator.h"
 #include <string>
 #include <cstdarg>
+#include <typeinfo>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
 uint32_t Packet::m_globalUid = 0;
+bool Packet::m_lazyHeaders = false;
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -137,19 +139,21 @@ Packet::Packet ()
      * global UID
      */
     m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
-    m_nixVector (0)
+    m_nixVector (0),
+    m_nixUsedBits (0)
 {
   m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
   : m_buffer (o.m_buffer),
+    m_pending (o.m_pending),
     m_byteTagList (o.m_byteTagList),
     m_packetTagList (o.m_packetTagList),
-    m_metadata (o.m_metadata)
+    m_metadata (o.m_metadata),
+    m_nixVector (o.m_nixVector),
+    m_nixUsedBits (o.m_nixUsedBits)
 {
-  o.m_nixVector ? m_nixVector = o.m_nixVector->Copy ()
-    : m_nixVector = 0;
 }
 
 Packet &
@@ -160,11 +164,12 @@ Packet::operator = (const Packet &o)
       return *this;
     }
   m_buffer = o.m_buffer;
+  m_pending = o.m_pending;
   m_byteTagList = o.m_byteTagList;
   m_packetTagList = o.m_packetTagList;
   m_metadata = o.m_metadata;
-  o.m_nixVector ? m_nixVector = o.m_nixVector->Copy () 
-    : m_nixVector = 0;
+  m_nixVector = o.m_nixVector;
+  m_nixUsedBits = o.m_nixUsedBits;
   return *this;
 }
 
@@ -179,7 +184,8 @@ Packet::Packet (uint32_t size)
      * global UID
      */
     m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
-    m_nixVector (0)
+    m_nixVector (0),
+    m_nixUsedBits (0)
 {
   m_globalUid++;
 }
@@ -188,7 +194,8 @@ Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
     m_byteTagList (),
     m_packetTagList (),
     m_metadata (0,0),
-    m_nixVector (0)
+    m_nixVector (0),
+    m_nixUsedBits (0)
 {
   NS_ASSERT (magic);
   Deserialize (buffer, size);
@@ -205,7 +212,8 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * global UID
      */
     m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
-    m_nixVector (0)
+    m_nixVector (0),
+    m_nixUsedBits (0)
 {
   m_globalUid++;
   m_buffer.AddAtStart (size);
@@ -219,7 +227,8 @@ Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList,
     m_byteTagList (byteTagList),
     m_packetTagList (packetTagList),
     m_metadata (metadata),
-    m_nixVector (0)
+    m_nixVector (0),
+    m_nixUsedBits (0)
 {
 }
 
@@ -227,6 +236,7 @@ Ptr<Packet>
 Packet::CreateFragment (uint32_t start, uint32_t length) const
 {
   NS_LOG_FUNCTION (this << start << length);
+  Flush ();
   Buffer buffer = m_buffer.CreateFragment (start, length);
   ByteTagList byteTagList = m_byteTagList;
   byteTagList.Adjust (-start);
@@ -236,42 +246,84 @@ Packet::CreateFragment (uint32_t start, uint32_t length) const
   // again, call the constructor directly rather than
   // through Create because it is private.
   Ptr<Packet> ret = Ptr<Packet> (new Packet (buffer, byteTagList, m_packetTagList, metadata), false);
-  ret->SetNixVector (GetNixVector ());
+  ret->SetNixVector (m_nixVector, m_nixUsedBits);
   return ret;
 }
 
 void
-Packet::SetNixVector (Ptr<NixVector> nixVector)
+Packet::SetNixVector (Ptr<const NixVector> nixVector)
+{
+  SetNixVector (nixVector, nixVector ? nixVector->GetUsedBits () : 0);
+}
+
+void
+Packet::SetNixVector (Ptr<const NixVector> nixVector, uint32_t usedBits)
 {
   m_nixVector = nixVector;
+  m_nixUsedBits = usedBits;
 }
 
-Ptr<NixVector>
+Ptr<const NixVector>
 Packet::GetNixVector (void) const
 {
   return m_nixVector;
-} 
+}
+
+uint32_t
+Packet::GetNixVectorUsedBits (void) const
+{
+  return m_nixUsedBits;
+}
+
+uint32_t
+Packet::ExtractNixNeighborIndex (uint32_t numberOfBits) const
+{
+  NS_ASSERT (m_nixVector);
+  return m_nixVector->ExtractNeighborIndex (numberOfBits, m_nixUsedBits);
+}
 
 void
 Packet::AddHeader (const Header &header)
 {
   uint32_t size = header.GetSerializedSize ();
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << size);
-  m_buffer.AddAtStart (size);
+  Header *copy = m_lazyHeaders ? header.Copy () : 0;
+  if (copy != 0 && typeid (*copy) == typeid (header))
+    {
+      m_pending = Create<PendingHeader> (copy, size, m_pending);
+    }
+  else
+    {
+      // a subclass which does not override Copy gets sliced: serialize it
+      delete copy;
+      Flush ();
+      m_buffer.AddAtStart (size);
+      header.Serialize (m_buffer.Begin ());
+    }
   m_byteTagList.Adjust (size);
   m_byteTagList.AddAtStart (size);
-  header.Serialize (m_buffer.Begin ());
   m_metadata.AddHeader (header, size);
 }
 uint32_t
 Packet::RemoveHeader (Header &header, uint32_t size)
 {
-  Buffer::Iterator end;
-  end = m_buffer.Begin ();
-  end.Next (size);
-  uint32_t deserialized = header.Deserialize (m_buffer.Begin (), end);
+  uint32_t deserialized;
+  if (IsPendingTop (header) && m_pending->m_size == size
+      && header.Assign (*m_pending->m_header))
+    {
+      deserialized = m_pending->m_size;
+      m_pending = m_pending->m_next;
+    }
+  else
+    {
+      Flush ();
+      Buffer::Iterator end;
+      end = m_buffer.Begin ();
+      end.Next (size);
+      deserialized = header.Deserialize (m_buffer.Begin (), end);
+      m_buffer.RemoveAtStart (deserialized);
+    }
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
-  m_buffer.RemoveAtStart (deserialized);
   m_byteTagList.Adjust (-deserialized);
   m_metadata.RemoveHeader (header, deserialized);
   return deserialized;
@@ -279,9 +331,19 @@ Packet::RemoveHeader (Header &header, uint32_t size)
 uint32_t
 Packet::RemoveHeader (Header &header)
 {
-  uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
+  uint32_t deserialized;
+  if (IsPendingTop (header) && header.Assign (*m_pending->m_header))
+    {
+      deserialized = m_pending->m_size;
+      m_pending = m_pending->m_next;
+    }
+  else
+    {
+      Flush ();
+      deserialized = header.Deserialize (m_buffer.Begin ());
+      m_buffer.RemoveAtStart (deserialized);
+    }
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
-  m_buffer.RemoveAtStart (deserialized);
   m_byteTagList.Adjust (-deserialized);
   m_metadata.RemoveHeader (header, deserialized);
   return deserialized;
@@ -289,25 +351,81 @@ Packet::RemoveHeader (Header &header)
 uint32_t
 Packet::PeekHeader (Header &header) const
 {
-  uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
+  uint32_t deserialized;
+  if (IsPendingTop (header) && header.Assign (*m_pending->m_header))
+    {
+      deserialized = m_pending->m_size;
+    }
+  else
+    {
+      Flush ();
+      deserialized = header.Deserialize (m_buffer.Begin ());
+    }
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
   return deserialized;
 }
 uint32_t
 Packet::PeekHeader (Header &header, uint32_t size) const
 {
-  Buffer::Iterator end;
-  end = m_buffer.Begin ();
-  end.Next (size);
-  uint32_t deserialized = header.Deserialize (m_buffer.Begin (), end);
+  uint32_t deserialized;
+  if (IsPendingTop (header) && m_pending->m_size == size
+      && header.Assign (*m_pending->m_header))
+    {
+      deserialized = m_pending->m_size;
+    }
+  else
+    {
+      Flush ();
+      Buffer::Iterator end;
+      end = m_buffer.Begin ();
+      end.Next (size);
+      deserialized = header.Deserialize (m_buffer.Begin (), end);
+    }
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
   return deserialized;
 }
+Packet::PendingHeader::PendingHeader (Header *header, uint32_t size, Ptr<PendingHeader> next)
+  : m_header (header),
+    m_size (size),
+    m_totalSize (next ? size + next->m_totalSize : size),
+    m_next (next)
+{
+}
+Packet::PendingHeader::~PendingHeader ()
+{
+  delete m_header;
+}
+bool
+Packet::IsPendingTop (const Header &header) const
+{
+  return m_pending && typeid (*m_pending->m_header) == typeid (header);
+}
+void
+Packet::Flush (void) const
+{
+  if (m_pending)
+    {
+      NS_LOG_FUNCTION (this);
+      Flush (PeekPointer (m_pending));
+      m_pending = 0;
+    }
+}
+void
+Packet::Flush (const PendingHeader *pending) const
+{
+  if (pending->m_next)
+    {
+      Flush (PeekPointer (pending->m_next));
+    }
+  m_buffer.AddAtStart (pending->m_size);
+  pending->m_header->Serialize (m_buffer.Begin ());
+}
 void
 Packet::AddTrailer (const Trailer &trailer)
 {
   uint32_t size = trailer.GetSerializedSize ();
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << size);
+  Flush ();
   m_byteTagList.AddAtEnd (GetSize ());
   m_buffer.AddAtEnd (size);
   Buffer::Iterator end = m_buffer.End ();
@@ -317,6 +435,7 @@ Packet::AddTrailer (const Trailer &trailer)
 uint32_t
 Packet::RemoveTrailer (Trailer &trailer)
 {
+  Flush ();
   uint32_t deserialized = trailer.Deserialize (m_buffer.End ());
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtEnd (deserialized);
@@ -326,6 +445,7 @@ Packet::RemoveTrailer (Trailer &trailer)
 uint32_t
 Packet::PeekTrailer (Trailer &trailer)
 {
+  Flush ();
   uint32_t deserialized = trailer.Deserialize (m_buffer.End ());
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << deserialized);
   return deserialized;
@@ -335,6 +455,8 @@ void
 Packet::AddAtEnd (Ptr<const Packet> packet)
 {
   NS_LOG_FUNCTION (this << packet << packet->GetSize ());
+  Flush ();
+  packet->Flush ();
   m_byteTagList.AddAtEnd (GetSize ());
   ByteTagList copy = packet->m_byteTagList;
   copy.AddAtStart (0);
@@ -355,6 +477,7 @@ void
 Packet::RemoveAtEnd (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
+  Flush ();
   m_buffer.RemoveAtEnd (size);
   m_metadata.RemoveAtEnd (size);
 }
@@ -362,6 +485,7 @@ void
 Packet::RemoveAtStart (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
+  Flush ();
   m_buffer.RemoveAtStart (size);
   m_byteTagList.Adjust (-size);
   m_metadata.RemoveAtStart (size);
@@ -377,12 +501,14 @@ Packet::RemoveAllByteTags (void)
 uint32_t 
 Packet::CopyData (uint8_t *buffer, uint32_t size) const
 {
+  Flush ();
   return m_buffer.CopyData (buffer, size);
 }
 
 void
 Packet::CopyData (std::ostream *os, uint32_t size) const
 {
+  Flush ();
   return m_buffer.CopyData (os, size);
 }
 
@@ -433,6 +559,7 @@ Packet::ToString() const
 void 
 Packet::Print (std::ostream &os) const
 {
+  Flush ();
   PacketMetadata::ItemIterator i = m_metadata.BeginItem (m_buffer);
   while (i.HasNext ())
     {
@@ -565,6 +692,7 @@ Packet::Print (std::ostream &os) const
 PacketMetadata::ItemIterator 
 Packet::BeginItem (void) const
 {
+  Flush ();
   return m_metadata.BeginItem (m_buffer);
 }
 
@@ -575,6 +703,20 @@ Packet::EnablePrinting (void)
   PacketMetadata::Enable ();
 }
 
+void
+Packet::EnableLazyHeaders (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_lazyHeaders = true;
+}
+
+void
+Packet::DisableLazyHeaders (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_lazyHeaders = false;
+}
+
 void
 Packet::EnableChecking (void)
 {
@@ -584,6 +726,7 @@ Packet::EnableChecking (void)
 
 uint32_t Packet::GetSerializedSize (void) const
 {
+  Flush ();
   uint32_t size = 0;
 
   if (m_nixVector)
@@ -627,6 +770,7 @@ uint32_t Packet::GetSerializedSize (void) const
 uint32_t 
 Packet::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
+  Flush ();
   uint32_t* p = reinterpret_cast<uint32_t *> (buffer);
   uint32_t size = 0;
 
@@ -644,7 +788,7 @@ Packet::Serialize (uint8_t* buffer, uint32_t maxSize) const
 
           // serialize the nix-vector
           uint32_t serialized = 
-            m_nixVector->Serialize (p, nixSize);
+            m_nixVector->Serialize (p, nixSize, m_nixUsedBits);
           if (serialized)
             {
               // increment p by nixSize bytes
@@ -761,6 +905,7 @@ Packet::Deserialize (const uint8_t* buffer, uint32_t size)
           return 0;
         }
       m_nixVector = nix;
+      m_nixUsedBits = nix->GetUsedBits ();
       // increment p by nixSize ensuring
       // 4-byte boundary
       p += ((((nixSize - 4) + 3) & (~3)) / 4);
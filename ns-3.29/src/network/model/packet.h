@@ -217,6 +217,16 @@ private:
  * qos class id set by an application and processed by a lower-level MAC 
  * layer.
  *
+ * - Headers which implement Header::Copy and Header::Assign can be
+ * carried unserialized once Packet::EnableLazyHeaders has been called:
+ * AddHeader then pushes a copy of the header object on the packet, and
+ * a RemoveHeader or PeekHeader of the same header type takes it back
+ * without going through the byte buffer. The pending headers are
+ * serialized into the buffer as soon as anything needs the actual
+ * bytes of the packet (CopyData, Print, fragmentation, trailers,
+ * serialization, or a header of another type), so the packet content
+ * seen by traces is unchanged.
+ *
  * Implementing a new type of Header or Trailer for a new protocol is 
  * pretty easy and is a matter of creating a subclass of the ns3::Header 
  * or of the ns3::Trailer base class, and implementing the methods
@@ -530,6 +540,23 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Carry headers as objects rather than bytes.
+   *
+   * Once enabled, AddHeader keeps a copy of the headers which implement
+   * Header::Copy instead of serializing them, and serializes them into
+   * the byte buffer only when the bytes are needed. This avoids the
+   * Serialize/Deserialize pair of every header at every hop when
+   * neither end looks at the bytes. It can be enabled and disabled at
+   * any time: packets created before keep working.
+   */
+  static void EnableLazyHeaders (void);
+  /**
+   * \brief Serialize headers in AddHeader again.
+   *
+   * Headers already pending on existing packets are not affected.
+   */
+  static void DisableLazyHeaders (void);
 
   /**
    * \brief Returns number of bytes required for packet
@@ -673,17 +700,49 @@ public:
    * should _not_ be followed, and is only here as an 
    * impetus to fix this general issue.
    *
+   * The nix-vector is shared rather than copied: the packet, and
+   * its copies, only keep their own count of the bits used, which
+   * starts at the bits used by nixVector.
+   *
    * \param nixVector the nix vector
    */
-  void SetNixVector (Ptr<NixVector> nixVector);
+  void SetNixVector (Ptr<const NixVector> nixVector);
   /**
-   * \brief Get the packet nix-vector.
+   * \brief Set the packet nix-vector, of which usedBits bits are
+   * already used.
    *
    * See the comment on SetNixVector
    *
+   * \param nixVector the nix vector, shared with the packet
+   * \param usedBits the number of bits already used
+   */
+  void SetNixVector (Ptr<const NixVector> nixVector, uint32_t usedBits);
+  /**
+   * \brief Get the packet nix-vector.
+   *
+   * See the comment on SetNixVector.  The nix-vector may be shared
+   * by other packets: its position is that of the packet which set
+   * it, use GetNixVectorUsedBits for the position of this packet.
+   *
    * \returns the Nix vector
    */
-  Ptr<NixVector> GetNixVector (void) const; 
+  Ptr<const NixVector> GetNixVector (void) const;
+  /**
+   * \brief Get the number of bits of the nix-vector this packet used.
+   *
+   * \returns the number of bits used
+   */
+  uint32_t GetNixVectorUsedBits (void) const;
+  /**
+   * \brief Extract the next neighbor-index of the packet nix-vector.
+   *
+   * This moves the position of the packet in its nix-vector, which
+   * does not change the content of the packet, hence is const.
+   *
+   * \param numberOfBits the number of bits to extract
+   * \returns the neighbor index
+   */
+  uint32_t ExtractNixNeighborIndex (uint32_t numberOfBits) const;
 
   /**
    * TracedCallback signature for Ptr<Packet>
@@ -758,15 +817,59 @@ private:
    */
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
-  Buffer m_buffer;                //!< the packet buffer (it's actual contents)
+  /**
+   * \brief A header added to the packet but not serialized yet.
+   *
+   * The pending headers form a stack in front of the byte buffer, most
+   * recently added first. The nodes are never modified once created,
+   * so copies of a packet share them.
+   */
+  class PendingHeader : public SimpleRefCount<PendingHeader>
+  {
+  public:
+    /**
+     * \param header the header copy, owned by this object.
+     * \param size the serialized size of the header.
+     * \param next the headers below this one.
+     */
+    PendingHeader (Header *header, uint32_t size, Ptr<PendingHeader> next);
+    ~PendingHeader ();
+
+    Header *m_header;            //!< the header copy
+    uint32_t m_size;             //!< serialized size of m_header
+    uint32_t m_totalSize;        //!< serialized size of this and the next headers
+    Ptr<PendingHeader> m_next;   //!< the header below this one
+  };
+
+  /**
+   * \param header the header to match.
+   * \returns true if the top pending header has the same type as \p header
+   */
+  bool IsPendingTop (const Header &header) const;
+  /**
+   * \brief Serialize the pending headers into the byte buffer.
+   *
+   * This does not change the content of the packet, hence is const.
+   */
+  void Flush (void) const;
+  /**
+   * \brief Serialize a pending header and those below it.
+   * \param pending the top header to serialize.
+   */
+  void Flush (const PendingHeader *pending) const;
+
+  mutable Buffer m_buffer;        //!< the packet buffer (it's actual contents)
+  mutable Ptr<PendingHeader> m_pending; //!< headers not yet serialized into m_buffer
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
   PacketMetadata m_metadata;      //!< the packet's metadata
 
   /* Please see comments above about nix-vector */
-  Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
+  Ptr<const NixVector> m_nixVector; //!< the packet's Nix vector, shared
+  mutable uint32_t m_nixUsedBits;   //!< the bits of m_nixVector used by this packet
 
   static uint32_t m_globalUid; //!< Global counter of packets Uid
+  static bool m_lazyHeaders;   //!< Whether AddHeader keeps header copies
 };
 
 /**
@@ -830,7 +933,7 @@ namespace ns3 {
 uint32_t 
 Packet::GetSize (void) const
 {
-  return m_buffer.GetSize ();
+  return m_buffer.GetSize () + (m_pending ? m_pending->m_totalSize : 0);
 }
 
 } // namespace ns3
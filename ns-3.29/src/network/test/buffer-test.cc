@@ -23,6 +23,8 @@
 #include "ns3/double.h"
 #include "ns3/test.h"
 
+#include <algorithm>
+
 using namespace ns3;
 
 /**
@@ -378,6 +380,98 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer::Iterator::CalculateIpChecksum tests: the checksum must match a
+ * word by word sum for every alignment of the zero area.
+ */
+class BufferChecksumTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferChecksumTest ();
+private:
+  /**
+   * Compute the checksum one 16-bit word at a time.
+   * \param i The iterator to start from.
+   * \param size The number of bytes.
+   * \param initial The initial checksum.
+   * \returns The checksum.
+   */
+  uint16_t ReferenceChecksum (Buffer::Iterator i, uint16_t size, uint32_t initial);
+};
+
+BufferChecksumTest::BufferChecksumTest ()
+  : TestCase ("Buffer checksum") {
+}
+
+uint16_t
+BufferChecksumTest::ReferenceChecksum (Buffer::Iterator i, uint16_t size, uint32_t initial)
+{
+  uint32_t sum = initial;
+  for (int j = 0; j < size / 2; j++)
+    {
+      sum += i.ReadU16 ();
+    }
+  if (size & 1)
+    {
+      sum += i.ReadU8 ();
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return ~sum;
+}
+
+void
+BufferChecksumTest::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  uint32_t zeroSizes[] = { 0, 1, 2, 7, 1400 };
+  uint32_t dataSizes[] = { 0, 1, 3, 20, 33, 75 };
+  for (uint32_t z = 0; z < sizeof (zeroSizes) / sizeof (zeroSizes[0]); z++)
+    {
+      for (uint32_t h = 0; h < sizeof (dataSizes) / sizeof (dataSizes[0]); h++)
+        {
+          for (uint32_t t = 0; t < sizeof (dataSizes) / sizeof (dataSizes[0]); t++)
+            {
+              // header bytes, then the zero area, then trailer bytes
+              Buffer buffer (zeroSizes[z]);
+              buffer.AddAtStart (dataSizes[h]);
+              buffer.AddAtEnd (dataSizes[t]);
+              Buffer::Iterator i = buffer.Begin ();
+              for (uint32_t j = 0; j < dataSizes[h]; j++)
+                {
+                  i.WriteU8 (rand->GetInteger (0, 255));
+                }
+              i = buffer.End ();
+              i.Prev (dataSizes[t]);
+              for (uint32_t j = 0; j < dataSizes[t]; j++)
+                {
+                  i.WriteU8 (rand->GetInteger (0, 255));
+                }
+
+              uint32_t total = buffer.GetSize ();
+              for (uint32_t start = 0; start < std::min (total, 3u); start++)
+                {
+                  uint16_t size = total - start;
+                  uint32_t initial = rand->GetInteger (0, 0x3ffff);
+                  i = buffer.Begin ();
+                  i.Next (start);
+                  uint16_t expected = ReferenceChecksum (i, size, initial);
+                  uint16_t checksum = i.CalculateIpChecksum (size, initial);
+                  NS_TEST_EXPECT_MSG_EQ (checksum, expected, "Wrong checksum, zero area " << zeroSizes[z] <<
+                                         ", header " << dataSizes[h] << ", trailer " << dataSizes[t] <<
+                                         ", start " << start);
+                  NS_TEST_EXPECT_MSG_EQ (i.GetRemainingSize (), 0, "Iterator not advanced by the checksum");
+                }
+            }
+        }
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -394,6 +488,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferChecksumTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
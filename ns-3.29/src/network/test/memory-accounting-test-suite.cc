@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/memory-accounting.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief MemoryAccounting test: the objects of a node, the packets of
+ * its device queue and the pending events.
+ */
+class MemoryAccountingTestCase : public TestCase
+{
+public:
+  MemoryAccountingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /** Event scheduled to be pending during the accounting. */
+  void Nothing (void);
+};
+
+MemoryAccountingTestCase::MemoryAccountingTestCase ()
+  : TestCase ("Check the memory accounted for a node")
+{
+}
+
+void
+MemoryAccountingTestCase::Nothing (void)
+{
+}
+
+void
+MemoryAccountingTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  Ptr<DropTailQueue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  device->SetQueue (queue);
+  node->AddDevice (device);
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      queue->Enqueue (Create<Packet> (100));
+    }
+  // the node schedules its initialization
+  uint64_t pending = Simulator::GetPendingEventCount ();
+  Simulator::Schedule (Seconds (1), &MemoryAccountingTestCase::Nothing, this);
+  Simulator::Schedule (Seconds (2), &MemoryAccountingTestCase::Nothing, this);
+
+  MemoryAccounting accounting;
+  accounting.AccountNode (node);
+  accounting.AccountEvents ();
+
+  NS_TEST_EXPECT_MSG_EQ (accounting.GetCount ("ns3::Node"), 1, "Node not accounted");
+  NS_TEST_EXPECT_MSG_EQ (accounting.GetBytes ("ns3::Node"), sizeof (Node), "Wrong size of the node");
+  NS_TEST_EXPECT_MSG_EQ (accounting.GetCount ("ns3::SimpleNetDevice"), 1, "Device not accounted");
+  NS_TEST_EXPECT_MSG_EQ (accounting.GetCount ("ns3::DropTailQueue<Packet>"), 1, "Queue not accounted");
+  NS_TEST_EXPECT_MSG_EQ (accounting.GetCount ("queued packets"), 3, "Wrong number of queued packets");
+  NS_TEST_EXPECT_MSG_EQ (accounting.GetBytes ("queued packets"), 3 * (100 + sizeof (Packet)),
+                         "Wrong size of the queued packets");
+  NS_TEST_EXPECT_MSG_EQ (accounting.GetCount ("pending events"), pending + 2, "Wrong number of pending events");
+  NS_TEST_EXPECT_MSG_EQ (accounting.GetNodeBytes (node->GetId ()),
+                         accounting.GetTotalBytes () - accounting.GetBytes ("pending events"),
+                         "Events charged to the node");
+
+  // objects are accounted once
+  uint64_t total = accounting.GetTotalBytes ();
+  accounting.Visit (queue);
+  accounting.AccountNode (node);
+  NS_TEST_EXPECT_MSG_EQ (accounting.GetTotalBytes (), total, "Objects accounted twice");
+
+  std::ostringstream oss;
+  accounting.Print (oss);
+  NS_TEST_EXPECT_MSG_NE (oss.str ().find ("queued packets"), std::string::npos,
+                         "Queued packets missing from the report:\n" << oss.str ());
+
+  accounting.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (accounting.GetTotalBytes (), 0, "Bytes left after Clear");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief MemoryAccounting TestSuite
+ */
+class MemoryAccountingTestSuite : public TestSuite
+{
+public:
+  MemoryAccountingTestSuite ();
+};
+
+MemoryAccountingTestSuite::MemoryAccountingTestSuite ()
+  : TestSuite ("memory-accounting", UNIT)
+{
+  AddTestCase (new MemoryAccountingTestCase, TestCase::QUICK);
+}
+
+static MemoryAccountingTestSuite g_memoryAccountingTestSuite; //!< Static variable for test initialization
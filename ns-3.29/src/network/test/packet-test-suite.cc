@@ -27,6 +27,7 @@
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <vector>
 
 using namespace ns3;
 
@@ -994,6 +995,46 @@ PacketTagListTest::DoRun (void)
     ReplaceCheck (7);
   }
   
+  { // Inline tags
+    std::cout << GetName () << "check tags stored in the list itself"
+              << std::endl;
+    PacketTagList small;
+    small.Add (t1);
+    small.Add (t2);
+    PacketTagList copy = small;
+    copy.Remove (t1);
+    CheckRef (small, t1, "inline orig after remove");
+    CheckRef (copy, t1, "inline copy after remove", true);
+    CheckRef (copy, t2, "inline copy after remove");
+
+    // a tag too large for a slot moves the inline tags to the heap
+    ALargeTestTag large;
+    copy.Add (large);
+    copy.Add (t3);
+    CheckRef (copy, t2, "spilled copy");
+    CheckRef (copy, t3, "spilled copy");
+    CheckRef (small, t2, "orig after spill of copy");
+    NS_TEST_EXPECT_MSG_EQ (copy.Head ()->tid, t3.GetInstanceTypeId (),
+                           "most recent tag not at the head");
+
+    PacketTagList full;
+    ATestTag<10> t10 (1);
+    for (int i = 0; i < 2; ++i)
+      {
+        full = copy;
+        full.Add (t4);
+        full.Add (t5);
+        full.Add (t6);
+        full.Add (t7);
+        full.Add (t10);
+        CheckRef (full, t2, "full list");
+        CheckRef (full, t10, "full list");
+        CheckRef (copy, t4, "copy of full list", true);
+        full.RemoveAll ();
+        NS_TEST_EXPECT_MSG_EQ (full.Head (), 0, "RemoveAll left tags");
+      }
+  }
+
   { // Timing
     std::cout << GetName () << "add+remove timing" << std::endl;
     int flm = std::numeric_limits<int>::max ();
@@ -1035,6 +1076,225 @@ PacketTagListTest::DoRun (void)
     
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test header which can be carried unserialized
+ *
+ * \note Class internal to packet-test-suite.cc
+ */
+class ALazyTestHeader : public Header
+{
+public:
+  /**
+   * Constructor
+   * \param value The header value
+   */
+  ALazyTestHeader (uint32_t value = 0) : Header (), m_value (value), m_verify (false) {}
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("anon::ALazyTestHeader")
+      .SetParent<Header> ()
+      .SetGroupName ("Network")
+      .HideFromDocumentation ()
+      .AddConstructor<ALazyTestHeader> ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const {
+    return 4;
+  }
+  virtual void Serialize (Buffer::Iterator iter) const {
+    ++m_serialized;
+    iter.WriteHtonU32 (m_value);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator iter) {
+    m_value = iter.ReadNtohU32 ();
+    return 4;
+  }
+  virtual void Print (std::ostream &os) const {
+    os << m_value;
+  }
+  virtual Header *Copy (void) const {
+    return new ALazyTestHeader (*this);
+  }
+  virtual bool Assign (const Header &header) {
+    if (m_verify)
+      {
+        return false;
+      }
+    m_value = static_cast<const ALazyTestHeader &> (header).m_value;
+    return true;
+  }
+  uint32_t m_value;              //!< The header value
+  bool m_verify;                 //!< Refuse Assign, as a checksum would
+  static uint32_t m_serialized;  //!< Number of calls to Serialize
+};
+
+uint32_t ALazyTestHeader::m_serialized = 0;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet headers carried as objects with Packet::EnableLazyHeaders
+ */
+class PacketLazyHeaderTest : public TestCase
+{
+public:
+  PacketLazyHeaderTest ();
+  virtual void DoRun (void);
+};
+
+PacketLazyHeaderTest::PacketLazyHeaderTest ()
+  : TestCase ("Lazy header serialization")
+{
+}
+
+void
+PacketLazyHeaderTest::DoRun (void)
+{
+  Packet::EnableLazyHeaders ();
+  ALazyTestHeader::m_serialized = 0;
+
+  // headers stay objects until the bytes are needed
+  {
+    Ptr<Packet> p = Create<Packet> (10);
+    p->AddHeader (ALazyTestHeader (1));
+    p->AddHeader (ALazyTestHeader (2));
+    NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 18, "pending headers not counted");
+    Ptr<Packet> q = p->Copy ();
+
+    ALazyTestHeader h;
+    NS_TEST_EXPECT_MSG_EQ (p->RemoveHeader (h), 4, "wrong size removed");
+    NS_TEST_EXPECT_MSG_EQ (h.m_value, 2, "wrong header removed");
+    NS_TEST_EXPECT_MSG_EQ (p->PeekHeader (h), 4, "wrong size peeked");
+    NS_TEST_EXPECT_MSG_EQ (h.m_value, 1, "wrong header peeked");
+    NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 14, "wrong size after remove");
+    NS_TEST_EXPECT_MSG_EQ (ALazyTestHeader::m_serialized, 0, "header serialized");
+
+    // the copy still has both headers, in wire order
+    uint8_t buf[18];
+    NS_TEST_EXPECT_MSG_EQ (q->CopyData (buf, 18), 18, "wrong size copied");
+    NS_TEST_EXPECT_MSG_EQ (ALazyTestHeader::m_serialized, 2, "headers not serialized");
+    NS_TEST_EXPECT_MSG_EQ (uint32_t (buf[3]), 2, "outer header not first");
+    NS_TEST_EXPECT_MSG_EQ (uint32_t (buf[7]), 1, "inner header not second");
+    q->RemoveHeader (h);
+    NS_TEST_EXPECT_MSG_EQ (h.m_value, 2, "wrong header deserialized");
+    p->RemoveHeader (h);
+    NS_TEST_EXPECT_MSG_EQ (h.m_value, 1, "copy changed the original");
+  }
+
+  // a header without Copy serializes the pending ones below it
+  {
+    Ptr<Packet> p = Create<Packet> (10);
+    p->AddHeader (ALazyTestHeader (5));
+    p->AddHeader (ATestHeader<3> ());
+    ATestHeader<3> eager;
+    p->RemoveHeader (eager);
+    NS_TEST_EXPECT_MSG_EQ (eager.m_error, false, "eager header corrupted");
+    ALazyTestHeader h;
+    p->RemoveHeader (h);
+    NS_TEST_EXPECT_MSG_EQ (h.m_value, 5, "lazy header corrupted");
+    NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 10, "wrong size");
+  }
+
+  // a header which refuses Assign is deserialized from the bytes
+  {
+    Ptr<Packet> p = Create<Packet> (10);
+    p->AddHeader (ALazyTestHeader (4));
+    p->AddHeader (ALazyTestHeader (3));
+    ALazyTestHeader h;
+    h.m_verify = true;
+    uint32_t serialized = ALazyTestHeader::m_serialized;
+    NS_TEST_EXPECT_MSG_EQ (p->PeekHeader (h), 4, "wrong size peeked");
+    NS_TEST_EXPECT_MSG_EQ (h.m_value, 3, "wrong header peeked");
+    NS_TEST_EXPECT_MSG_EQ (ALazyTestHeader::m_serialized, serialized + 2, "headers not serialized");
+    NS_TEST_EXPECT_MSG_EQ (p->RemoveHeader (h), 4, "wrong size removed");
+    NS_TEST_EXPECT_MSG_EQ (h.m_value, 3, "wrong header removed");
+    p->RemoveHeader (h);
+    NS_TEST_EXPECT_MSG_EQ (h.m_value, 4, "inner header corrupted");
+    NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 10, "wrong size");
+  }
+
+  // fragments and byte tags see the serialized header
+  {
+    Ptr<Packet> p = Create<Packet> (10);
+    p->AddByteTag (ATestTag<1> ());
+    p->AddHeader (ALazyTestHeader (7));
+    Ptr<Packet> f = p->CreateFragment (0, 6);
+    ALazyTestHeader h;
+    f->RemoveHeader (h);
+    NS_TEST_EXPECT_MSG_EQ (h.m_value, 7, "fragment lost the header");
+    NS_TEST_EXPECT_MSG_EQ (f->GetSize (), 2, "wrong fragment size");
+    ByteTagIterator i = p->GetByteTagIterator ();
+    NS_TEST_EXPECT_MSG_EQ (i.Next ().GetStart (), 4, "byte tag covers the header");
+  }
+
+  Packet::DisableLazyHeaders ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Nix-vectors shared by packets, each with its own position
+ */
+class PacketNixVectorTest : public TestCase
+{
+public:
+  PacketNixVectorTest ();
+  virtual void DoRun (void);
+};
+
+PacketNixVectorTest::PacketNixVectorTest ()
+  : TestCase ("Shared nix-vectors")
+{
+}
+
+void
+PacketNixVectorTest::DoRun (void)
+{
+  // neighbor-indexes of 3, 20 and 17 bits, added from the last hop
+  // and extracted from the first; the second spans two entries of
+  // the vector
+  Ptr<NixVector> nix = Create<NixVector> ();
+  nix->AddNeighborIndex (0x1f0f0, 17);
+  nix->AddNeighborIndex (0xabcde, 20);
+  nix->AddNeighborIndex (5, 3);
+
+  Ptr<Packet> p = Create<Packet> (10);
+  p->SetNixVector (nix);
+  NS_TEST_EXPECT_MSG_EQ (p->ExtractNixNeighborIndex (3), 5, "wrong first index");
+  Ptr<Packet> q = p->Copy ();
+  Ptr<Packet> f = p->CreateFragment (0, 5);
+  NS_TEST_EXPECT_MSG_EQ (q->GetNixVector (), p->GetNixVector (), "copy did not share the nix-vector");
+  NS_TEST_EXPECT_MSG_EQ (p->ExtractNixNeighborIndex (20), 0xabcde, "wrong second index");
+  NS_TEST_EXPECT_MSG_EQ (p->ExtractNixNeighborIndex (17), 0x1f0f0, "wrong third index");
+
+  // the copies go on from where the packet was when copied
+  NS_TEST_EXPECT_MSG_EQ (q->GetNixVectorUsedBits (), 3, "copy lost the position");
+  NS_TEST_EXPECT_MSG_EQ (q->ExtractNixNeighborIndex (20), 0xabcde, "wrong second index of the copy");
+  NS_TEST_EXPECT_MSG_EQ (f->ExtractNixNeighborIndex (20), 0xabcde, "wrong second index of the fragment");
+  NS_TEST_EXPECT_MSG_EQ (nix->GetRemainingBits (), 40, "shared nix-vector changed");
+
+  // the position of the packet goes on the wire
+  uint32_t size = q->GetSerializedSize ();
+  std::vector<uint8_t> buffer (size);
+  NS_TEST_EXPECT_MSG_EQ (q->Serialize (&buffer[0], size), 1, "not serialized");
+  Ptr<Packet> r = Create<Packet> (&buffer[0], size, true);
+  NS_TEST_EXPECT_MSG_EQ (r->GetNixVectorUsedBits (), 23, "position not deserialized");
+  NS_TEST_EXPECT_MSG_EQ (r->ExtractNixNeighborIndex (17), 0x1f0f0, "wrong index deserialized");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1052,6 +1312,8 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketLazyHeaderTest, TestCase::QUICK);
+  AddTestCase (new PacketNixVectorTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
@@ -21,10 +21,13 @@
 #include <cstdlib>
 #include <sstream>
 #include <cstring>
+#include <fstream>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
 
 using namespace ns3;
 
@@ -1144,6 +1147,92 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that a file written by the background
+ * thread, with records spanning several blocks, has the same bytes as
+ * a file written on the simulation thread.
+ */
+class AsyncWriteTestCase : public TestCase
+{
+public:
+  AsyncWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /**
+   * Write the known packets, truncated to a snap length.
+   * \param filename the file name
+   * \param blockSize the "AsyncTraceBuffer" value
+   */
+  void WriteKnownPackets (std::string filename, uint32_t blockSize);
+  /**
+   * \param filename the file name
+   * \return the bytes of the file
+   */
+  std::string ReadBytes (std::string filename);
+};
+
+AsyncWriteTestCase::AsyncWriteTestCase ()
+  : TestCase ("Check that a file written in the background is the same as one written at once")
+{
+}
+
+void
+AsyncWriteTestCase::WriteKnownPackets (std::string filename, uint32_t blockSize)
+{
+  GlobalValue::Bind ("AsyncTraceBuffer", UintegerValue (blockSize));
+  PcapFile f;
+  f.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  f.Init (1, N_PACKET_BYTES);
+  for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+    {
+      PacketEntry const & p = knownPackets[i];
+      f.Write (p.tsSec, p.tsUsec, (uint8_t const *)p.data, p.origLen);
+      NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Write must not fail");
+    }
+  f.Close ();
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Close must not fail");
+}
+
+void
+AsyncWriteTestCase::DoTeardown (void)
+{
+  // Restored here so that a failed assertion does not leave the later
+  // test suites writing their traces in the background
+  GlobalValue::Bind ("AsyncTraceBuffer", UintegerValue (0));
+}
+
+std::string
+AsyncWriteTestCase::ReadBytes (std::string filename)
+{
+  std::ifstream file (filename.c_str (), std::ios::binary);
+  std::ostringstream bytes;
+  bytes << file.rdbuf ();
+  return bytes.str ();
+}
+
+void
+AsyncWriteTestCase::DoRun (void)
+{
+  std::string syncFilename = CreateTempDirFilename ("sync.pcap");
+  std::string asyncFilename = CreateTempDirFilename ("async.pcap");
+  WriteKnownPackets (syncFilename, 0);
+  WriteKnownPackets (asyncFilename, 50);
+
+  std::string syncBytes = ReadBytes (syncFilename);
+  NS_TEST_EXPECT_MSG_EQ (syncBytes.size (), 24 + N_KNOWN_PACKETS * (16 + N_PACKET_BYTES),
+                         "The packets must be truncated to the snap length");
+  NS_TEST_EXPECT_MSG_EQ ((ReadBytes (asyncFilename) == syncBytes), true,
+                         "The file written in the background must have the same bytes");
+  std::remove (syncFilename.c_str ());
+  std::remove (asyncFilename.c_str ());
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1167,6 +1256,7 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new AsyncWriteTestCase, TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,476 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <signal.h>
+#include <pthread.h>
+
+#include "ns3/log.h"
+#include "ns3/fatal-error.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/mpsc-queue.h"
+#include "async-file-buffer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AsyncFileBuffer");
+
+/**
+ * \ingroup network
+ * The size of the blocks of the trace files, 0 to write them on the
+ * simulation thread.
+ */
+static GlobalValue g_asyncTraceBuffer =
+  GlobalValue ("AsyncTraceBuffer",
+               "Bytes of a trace file buffered before a background thread writes them, "
+               "0 to write the uncompressed trace files on the simulation thread",
+               UintegerValue (0),
+               MakeUintegerChecker<uint32_t> ());
+
+/**
+ * \ingroup network
+ * The compressor of the trace files written by the background thread.
+ */
+static GlobalValue g_traceCompression =
+  GlobalValue ("TraceCompression",
+               "Compressor of the trace files written by the background thread: none, gzip or zstd",
+               StringValue ("none"),
+               MakeStringChecker ());
+
+/** The bytes of the blocks waiting for the background thread, at most */
+static const std::size_t MAX_PENDING_BYTES = 64 << 20;
+
+/** The size of the blocks of the compressed files if "AsyncTraceBuffer" is 0 */
+static const std::size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+
+/**
+ * \ingroup network
+ *
+ * The background thread of the AsyncFileBuffer, which runs while
+ * files are open.
+ */
+class AsyncFileWriter
+{
+public:
+  /** A block of a file handed to the background thread */
+  struct Block
+  {
+    AsyncFileBuffer *m_buffer; //!< The buffer of the file
+    char *m_data;              //!< The bytes, or 0
+    std::size_t m_size;        //!< The number of bytes
+    bool m_close;              //!< True to close the file after the bytes
+  };
+
+  /**
+   * Start the thread for the first open file.
+   * \param buffer the buffer of the file
+   */
+  static void Open (AsyncFileBuffer *buffer);
+  /**
+   * Stop the thread after the last file is closed.
+   * \param buffer the buffer of the file
+   */
+  static void Close (AsyncFileBuffer *buffer);
+  /**
+   * Close the files still open when the program exits.  The trace
+   * files are often owned by trace sinks which are never destroyed,
+   * and their last blocks would otherwise be lost.
+   */
+  static void CloseAll (void);
+  /**
+   * Hand a block over to the thread, waiting if too many are pending.
+   * \param block the block
+   */
+  static void Push (const Block &block);
+  /**
+   * Wait until the thread has closed the file of a buffer.
+   * \param buffer the buffer
+   */
+  static void WaitClosed (AsyncFileBuffer *buffer);
+  /**
+   * \param size the size of the block
+   * \return a block written earlier, or a new one
+   */
+  static char *Allocate (std::size_t size);
+
+private:
+  /** Write the blocks handed over until the last file is closed */
+  static void Run (void);
+  /**
+   * Write a block, and close its file if requested.
+   * \param block the block
+   */
+  static void Write (const Block &block);
+
+  static MpscQueue<Block> m_blocks;            //!< The blocks handed over
+  static std::mutex m_mutex;                   //!< Guards the fields below and the wake-ups
+  static std::condition_variable m_wake;       //!< Wakes the thread up
+  static std::condition_variable m_closed;     //!< Wakes up the threads waiting for a file to close
+  static std::vector<std::pair<char *, std::size_t> > m_free; //!< The blocks already written
+  static std::thread m_thread;                 //!< The thread
+  static std::set<AsyncFileBuffer *> m_files;  //!< The open files
+  static bool m_stop;                          //!< True to stop the thread once idle
+};
+
+MpscQueue<AsyncFileWriter::Block> AsyncFileWriter::m_blocks;
+std::mutex AsyncFileWriter::m_mutex;
+std::condition_variable AsyncFileWriter::m_wake;
+std::condition_variable AsyncFileWriter::m_closed;
+std::vector<std::pair<char *, std::size_t> > AsyncFileWriter::m_free;
+std::thread AsyncFileWriter::m_thread;
+std::set<AsyncFileBuffer *> AsyncFileWriter::m_files;
+bool AsyncFileWriter::m_stop = false;
+
+/**
+ * \ingroup network
+ *
+ * Close the open files at exit, before the AsyncFileWriter fields
+ * defined above are destroyed.
+ */
+static struct AsyncFileCloser
+{
+  ~AsyncFileCloser ()
+  {
+    AsyncFileWriter::CloseAll ();
+  }
+} g_asyncFileCloser; //!< Closes the open files at exit
+
+void
+AsyncFileWriter::Open (AsyncFileBuffer *buffer)
+{
+  NS_LOG_FUNCTION (buffer);
+  std::lock_guard<std::mutex> lock (m_mutex);
+  m_files.insert (buffer);
+  if (m_files.size () == 1)
+    {
+      m_blocks.SetCapacity (std::max<std::size_t> (4, MAX_PENDING_BYTES / buffer->m_blockSize));
+      m_stop = false;
+      m_thread = std::thread (&AsyncFileWriter::Run);
+    }
+}
+
+void
+AsyncFileWriter::Close (AsyncFileBuffer *buffer)
+{
+  NS_LOG_FUNCTION (buffer);
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_files.erase (buffer);
+    if (!m_files.empty ())
+      {
+        return;
+      }
+    m_stop = true;
+  }
+  m_wake.notify_one ();
+  m_thread.join ();
+
+  std::lock_guard<std::mutex> lock (m_mutex);
+  for (std::size_t i = 0; i < m_free.size (); ++i)
+    {
+      delete [] m_free[i].first;
+    }
+  m_free.clear ();
+  m_blocks.SetCapacity (0);
+}
+
+void
+AsyncFileWriter::CloseAll (void)
+{
+  std::vector<AsyncFileBuffer *> files;
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    files.assign (m_files.begin (), m_files.end ());
+  }
+  for (std::size_t i = 0; i < files.size (); ++i)
+    {
+      files[i]->Close ();
+    }
+}
+
+void
+AsyncFileWriter::Push (const Block &block)
+{
+  m_blocks.Push (block);
+  {
+    // The thread checks for blocks with the mutex held, so it is
+    // either awake or waiting by the time the mutex is taken here.
+    std::lock_guard<std::mutex> lock (m_mutex);
+  }
+  m_wake.notify_one ();
+}
+
+void
+AsyncFileWriter::WaitClosed (AsyncFileBuffer *buffer)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (!buffer->m_closed)
+    {
+      m_closed.wait (lock);
+    }
+}
+
+char *
+AsyncFileWriter::Allocate (std::size_t size)
+{
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    for (std::size_t i = m_free.size (); i > 0; --i)
+      {
+        if (m_free[i - 1].second == size)
+          {
+            char *block = m_free[i - 1].first;
+            m_free.erase (m_free.begin () + (i - 1));
+            return block;
+          }
+      }
+  }
+  return new char[size];
+}
+
+void
+AsyncFileWriter::Run (void)
+{
+  // A compressor which exits makes the writes fail with EPIPE, instead
+  // of killing the program with SIGPIPE.
+  sigset_t signals;
+  sigemptyset (&signals);
+  sigaddset (&signals, SIGPIPE);
+  pthread_sigmask (SIG_BLOCK, &signals, 0);
+
+  while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lock (m_mutex);
+        while (m_blocks.IsEmpty () && !m_stop)
+          {
+            m_wake.wait (lock);
+          }
+        if (m_blocks.IsEmpty ())
+          {
+            return;
+          }
+      }
+      m_blocks.Drain (&AsyncFileWriter::Write);
+    }
+}
+
+void
+AsyncFileWriter::Write (const Block &block)
+{
+  AsyncFileBuffer *buffer = block.m_buffer;
+  bool failed = false;
+  if (block.m_size > 0 && std::fwrite (block.m_data, 1, block.m_size, buffer->m_file) != block.m_size)
+    {
+      failed = true;
+    }
+  if (block.m_close)
+    {
+      int status = buffer->m_pipe ? pclose (buffer->m_file) : std::fclose (buffer->m_file);
+      failed = failed || status != 0;
+    }
+
+  std::lock_guard<std::mutex> lock (m_mutex);
+  if (block.m_data != 0)
+    {
+      m_free.push_back (std::make_pair (block.m_data, buffer->m_blockSize));
+    }
+  buffer->m_failed = buffer->m_failed || failed;
+  if (block.m_close)
+    {
+      buffer->m_closed = true;
+      m_closed.notify_all ();
+    }
+}
+
+/**
+ * \param filename a file name
+ * \return the file name quoted for the shell
+ */
+static std::string
+QuoteForShell (std::string filename)
+{
+  std::string quoted = "'";
+  for (std::string::size_type i = 0; i < filename.size (); ++i)
+    {
+      if (filename[i] == '\'')
+        {
+          quoted += "'\\''";
+        }
+      else
+        {
+          quoted += filename[i];
+        }
+    }
+  return quoted + "'";
+}
+
+AsyncFileBuffer::AsyncFileBuffer (std::string filename, std::ios::openmode mode)
+  : m_file (0),
+    m_pipe (false),
+    m_block (0),
+    m_handedOver (0),
+    m_closed (false),
+    m_failed (false)
+{
+  NS_LOG_FUNCTION (this << filename << mode);
+
+  UintegerValue blockSize;
+  g_asyncTraceBuffer.GetValue (blockSize);
+  m_blockSize = blockSize.Get () > 0 ? blockSize.Get () : DEFAULT_BLOCK_SIZE;
+
+  StringValue compression;
+  g_traceCompression.GetValue (compression);
+  std::string redirect = (mode & std::ios::app) ? " >> " : " > ";
+  if (compression.Get () == "none")
+    {
+      m_file = std::fopen (filename.c_str (), (mode & std::ios::app) ? "ab" : "wb");
+    }
+  else if (compression.Get () == "gzip")
+    {
+      m_file = popen (("gzip -c" + redirect + QuoteForShell (filename + ".gz")).c_str (), "w");
+      m_pipe = true;
+    }
+  else if (compression.Get () == "zstd")
+    {
+      m_file = popen (("zstd -q -c" + redirect + QuoteForShell (filename + ".zst")).c_str (), "w");
+      m_pipe = true;
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown TraceCompression " << compression.Get () << ", not none, gzip or zstd");
+    }
+  if (m_file == 0)
+    {
+      return;
+    }
+
+  AsyncFileWriter::Open (this);
+  m_block = AsyncFileWriter::Allocate (m_blockSize);
+  setp (m_block, m_block + m_blockSize);
+}
+
+AsyncFileBuffer::~AsyncFileBuffer ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+AsyncFileBuffer::IsOpen (void) const
+{
+  return m_file != 0 && m_block != 0;
+}
+
+bool
+AsyncFileBuffer::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!IsOpen ())
+    {
+      return !m_failed;
+    }
+  HandOver (true);
+  AsyncFileWriter::WaitClosed (this);
+  AsyncFileWriter::Close (this);
+  m_file = 0;
+  return !m_failed;
+}
+
+bool
+AsyncFileBuffer::IsEnabled (void)
+{
+  UintegerValue blockSize;
+  g_asyncTraceBuffer.GetValue (blockSize);
+  StringValue compression;
+  g_traceCompression.GetValue (compression);
+  return blockSize.Get () > 0 || compression.Get () != "none";
+}
+
+void
+AsyncFileBuffer::HandOver (bool close)
+{
+  AsyncFileWriter::Block block;
+  block.m_buffer = this;
+  block.m_data = m_block;
+  block.m_size = pptr () - pbase ();
+  block.m_close = close;
+  m_handedOver += block.m_size;
+  if (close)
+    {
+      m_block = 0;
+      setp (0, 0);
+    }
+  else
+    {
+      m_block = AsyncFileWriter::Allocate (m_blockSize);
+      setp (m_block, m_block + m_blockSize);
+    }
+  AsyncFileWriter::Push (block);
+}
+
+AsyncFileBuffer::int_type
+AsyncFileBuffer::overflow (int_type c)
+{
+  if (!IsOpen ())
+    {
+      return traits_type::eof ();
+    }
+  HandOver (false);
+  if (traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      return traits_type::not_eof (c);
+    }
+  *pptr () = traits_type::to_char_type (c);
+  pbump (1);
+  return c;
+}
+
+int
+AsyncFileBuffer::sync (void)
+{
+  return 0;
+}
+
+AsyncFileBuffer::pos_type
+AsyncFileBuffer::seekoff (off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+  off_type position = m_handedOver + (pptr () - pbase ());
+  if ((which & std::ios_base::out) == 0
+      || (dir == std::ios_base::cur && off != 0)
+      || (dir == std::ios_base::beg && off != position)
+      || dir == std::ios_base::end)
+    {
+      return pos_type (off_type (-1));
+    }
+  return pos_type (position);
+}
+
+AsyncFileBuffer::pos_type
+AsyncFileBuffer::seekpos (pos_type pos, std::ios_base::openmode which)
+{
+  return seekoff (off_type (pos), std::ios_base::beg, which);
+}
+
+} // namespace ns3
@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef ASYNC_FILE_BUFFER_H
+#define ASYNC_FILE_BUFFER_H
+
+#include <cstdio>
+#include <ios>
+#include <streambuf>
+#include <string>
+
+#include "ns3/non-copyable.h"
+
+namespace ns3 {
+
+class AsyncFileWriter;
+
+/**
+ * \ingroup network
+ *
+ * \brief A std::streambuf whose file is written by a background thread.
+ *
+ * The bytes written to the stream are copied into a block of
+ * "AsyncTraceBuffer" bytes.  A full block is handed to a background
+ * thread, shared by all the files, which writes it while the
+ * simulation goes on: a trace record costs the writing thread a copy
+ * into memory.  The blocks waiting for the background thread are
+ * bounded; a writer finding too many of them waits until one is
+ * written.
+ *
+ * Flushing the stream does not hand the block over, so that a trace
+ * which ends every line with std::endl still writes large blocks.
+ * The bytes reach the file when their block is full and at Close,
+ * which waits until the whole file is written.  The files still open
+ * when the program exits are closed then; the bytes of a program
+ * which aborts may be lost.
+ *
+ * With the "TraceCompression" GlobalValue set to gzip or zstd, the
+ * background thread pipes the file through the compressor, which runs
+ * in a process of its own, and the suffix of the compressor is added
+ * to the file name.  The compressed files are always written in the
+ * background, in blocks of 1 MiB if "AsyncTraceBuffer" is 0.
+ *
+ * The trace files of PcapFile and of the OutputStreamWrapper created
+ * with a file name go through an AsyncFileBuffer when IsEnabled.
+ */
+class AsyncFileBuffer : public std::streambuf, private NonCopyable
+{
+public:
+  /**
+   * Open a file for writing.
+   * \param filename the file name, without the suffix of the compressor
+   * \param mode std::ios::app to append to the file, else it is truncated
+   */
+  AsyncFileBuffer (std::string filename, std::ios::openmode mode);
+  /** Close the file. */
+  virtual ~AsyncFileBuffer ();
+
+  /**
+   * \return true if the file is open
+   */
+  bool IsOpen (void) const;
+  /**
+   * Hand the buffered bytes over, wait until the file is written and
+   * close it.
+   * \return true if every write succeeded
+   */
+  bool Close (void);
+
+  /**
+   * \return true if the trace files are written by the background
+   * thread, that is if the "AsyncTraceBuffer" GlobalValue is not 0 or
+   * the files are compressed
+   */
+  static bool IsEnabled (void);
+
+protected:
+  /**
+   * Hand the full block over and start a new one.
+   * \param c the character which did not fit, or eof
+   * \return c, or not eof if c is eof
+   */
+  virtual int_type overflow (int_type c);
+  /**
+   * Do nothing: the block is handed over when it is full.
+   * \return 0
+   */
+  virtual int sync (void);
+  /**
+   * Report the position in the file.  The only seeks supported are
+   * those to the current position, like the tellp of the stream.
+   * \param off the offset
+   * \param dir where the offset is from
+   * \param which the sequence, which must be the output
+   * \return the position, or -1 if it would move
+   */
+  virtual pos_type seekoff (off_type off, std::ios_base::seekdir dir,
+                            std::ios_base::openmode which = std::ios_base::out);
+  /**
+   * Report the position in the file, which must not move.
+   * \param pos the position
+   * \param which the sequence, which must be the output
+   * \return the position, or -1 if it would move
+   */
+  virtual pos_type seekpos (pos_type pos, std::ios_base::openmode which = std::ios_base::out);
+
+private:
+  friend class AsyncFileWriter;
+
+  /**
+   * Hand the current block to the background thread.
+   * \param close true to close the file after the block
+   */
+  void HandOver (bool close);
+
+  std::FILE *m_file;        //!< The file, or the pipe to the compressor
+  bool m_pipe;              //!< True if the file is a pipe
+  std::size_t m_blockSize;  //!< The size of the blocks
+  char *m_block;            //!< The block being filled, or 0
+  uint64_t m_handedOver;    //!< The bytes handed to the background thread
+  bool m_closed;            //!< True once the background thread closed the file
+  bool m_failed;            //!< True if a write or the close failed
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_FILE_BUFFER_H */
@@ -0,0 +1,287 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "memory-accounting.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/object-ptr-container.h"
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <utility>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MemoryAccounting");
+
+const uint32_t MemoryAccounting::CONTAINER_NODE_OVERHEAD;
+
+/** Node id of the memory which belongs to no node. */
+static const uint32_t NO_NODE = 0xffffffff;
+
+MemoryAccounting::Usage::Usage ()
+  : bytes (0),
+    count (0)
+{
+}
+
+MemoryAccounting::MemoryAccounting ()
+  : m_node (NO_NODE),
+    m_total (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::map<TypeId, MemoryAccounting::Accountant> &
+MemoryAccounting::GetAccountants (void)
+{
+  static std::map<TypeId, Accountant> accountants;
+  return accountants;
+}
+
+void
+MemoryAccounting::AddAccountant (TypeId tid, Accountant accountant)
+{
+  NS_LOG_FUNCTION (tid << accountant);
+  GetAccountants ()[tid] = accountant;
+}
+
+void
+MemoryAccounting::AccountNodes (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      AccountNode (*i);
+    }
+  AccountEvents ();
+}
+
+void
+MemoryAccounting::AccountNode (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  m_time = Simulator::Now ();
+  m_node = node->GetId ();
+  if (m_node >= m_nodes.size ())
+    {
+      m_nodes.resize (m_node + 1, 0);
+    }
+  Visit (node);
+  m_node = NO_NODE;
+}
+
+void
+MemoryAccounting::AccountEvents (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t events = Simulator::GetPendingEventCount ();
+  // the EventImpl subclasses add the arguments of the event
+  Add ("pending events", events * (sizeof (Scheduler::Event) + sizeof (EventImpl)), events);
+}
+
+void
+MemoryAccounting::Visit (Ptr<Object> object)
+{
+  if (object == 0 || !m_visited.insert (PeekPointer (object)).second)
+    {
+      return;
+    }
+  Ptr<Node> node = DynamicCast<Node> (object);
+  if (node != 0 && node->GetId () != m_node)
+    {
+      // reached through a shared object, accounted on its own
+      m_visited.erase (PeekPointer (object));
+      return;
+    }
+  NS_LOG_FUNCTION (this << object);
+
+  TypeId instanceTid = object->GetInstanceTypeId ();
+  Add (instanceTid.GetName (), instanceTid.GetSize ());
+
+  std::map<TypeId, Accountant> &accountants = GetAccountants ();
+  TypeId nextTid = instanceTid;
+  TypeId tid;
+  do
+    {
+      tid = nextTid;
+      std::map<TypeId, Accountant>::const_iterator accountant = accountants.find (tid);
+      if (accountant != accountants.end ())
+        {
+          accountant->second (object, *this);
+        }
+      VisitAttributes (object, tid);
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+
+  Object::AggregateIterator aggregates = object->GetAggregateIterator ();
+  while (aggregates.HasNext ())
+    {
+      Visit (ConstCast<Object> (aggregates.Next ()));
+    }
+}
+
+void
+MemoryAccounting::VisitAttributes (Ptr<Object> object, TypeId tid)
+{
+  for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+    {
+      struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+      if (!(info.flags & TypeId::ATTR_GET) || !info.accessor->HasGetter ())
+        {
+          continue;
+        }
+      if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+        {
+          PointerValue pointer;
+          if (info.accessor->Get (PeekPointer (object), pointer))
+            {
+              Visit (pointer.Get<Object> ());
+            }
+        }
+      else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+        {
+          ObjectPtrContainerValue container;
+          if (info.accessor->Get (PeekPointer (object), container))
+            {
+              for (ObjectPtrContainerValue::Iterator j = container.Begin (); j != container.End (); ++j)
+                {
+                  Visit (j->second);
+                }
+            }
+        }
+    }
+}
+
+void
+MemoryAccounting::Add (std::string category, uint64_t bytes, uint64_t count)
+{
+  Usage &usage = m_categories[category];
+  usage.bytes += bytes;
+  usage.count += count;
+  m_total += bytes;
+  if (m_node != NO_NODE)
+    {
+      m_nodes[m_node] += bytes;
+    }
+}
+
+uint64_t
+MemoryAccounting::GetBytes (std::string category) const
+{
+  std::map<std::string, Usage>::const_iterator it = m_categories.find (category);
+  return it == m_categories.end () ? 0 : it->second.bytes;
+}
+
+uint64_t
+MemoryAccounting::GetCount (std::string category) const
+{
+  std::map<std::string, Usage>::const_iterator it = m_categories.find (category);
+  return it == m_categories.end () ? 0 : it->second.count;
+}
+
+uint64_t
+MemoryAccounting::GetNodeBytes (uint32_t nodeId) const
+{
+  return nodeId < m_nodes.size () ? m_nodes[nodeId] : 0;
+}
+
+uint64_t
+MemoryAccounting::GetTotalBytes (void) const
+{
+  return m_total;
+}
+
+void
+MemoryAccounting::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_categories.clear ();
+  m_nodes.clear ();
+  m_visited.clear ();
+  m_total = 0;
+}
+
+void
+MemoryAccounting::Print (std::ostream &os, uint32_t maxNodes) const
+{
+  NS_LOG_FUNCTION (this << maxNodes);
+
+  std::vector<std::pair<const Usage *, std::string> > categories;
+  for (std::map<std::string, Usage>::const_iterator it = m_categories.begin (); it != m_categories.end (); ++it)
+    {
+      categories.push_back (std::make_pair (&it->second, it->first));
+    }
+  std::sort (categories.begin (), categories.end (),
+             [] (const std::pair<const Usage *, std::string> &a, const std::pair<const Usage *, std::string> &b)
+    {
+      return a.first->bytes > b.first->bytes;
+    });
+  std::vector<std::pair<uint64_t, uint32_t> > nodes;
+  for (uint32_t i = 0; i < m_nodes.size (); ++i)
+    {
+      nodes.push_back (std::make_pair (m_nodes[i], i));
+    }
+  std::sort (nodes.begin (), nodes.end (),
+             [] (const std::pair<uint64_t, uint32_t> &a, const std::pair<uint64_t, uint32_t> &b)
+    {
+      return a.first > b.first;
+    });
+
+  std::ios_base::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << "MEMORY at " << m_time.GetSeconds () << "s: " << m_total << " bytes accounted in "
+     << m_nodes.size () << " nodes and the event list" << std::endl;
+  os << "       bytes      count  bytes/elem  category" << std::endl;
+  for (uint32_t i = 0; i < categories.size (); ++i)
+    {
+      const Usage &usage = *categories[i].first;
+      os << std::setw (12) << usage.bytes << std::setw (11) << usage.count
+         << std::setw (12) << std::fixed << std::setprecision (0)
+         << (usage.count ? double (usage.bytes) / usage.count : 0.0)
+         << "  " << categories[i].second << std::endl;
+    }
+  os << "       bytes  node (top " << std::min<std::size_t> (maxNodes, nodes.size ()) << ")" << std::endl;
+  for (uint32_t i = 0; i < nodes.size () && i < maxNodes; ++i)
+    {
+      os << std::setw (12) << nodes[i].first << "  " << nodes[i].second << std::endl;
+    }
+  os.flags (flags);
+  os.precision (precision);
+}
+
+void
+MemoryAccounting::PrintNow (Ptr<OutputStreamWrapper> stream)
+{
+  NS_LOG_FUNCTION (stream);
+  MemoryAccounting accounting;
+  accounting.AccountNodes ();
+  accounting.Print (*stream->GetStream ());
+}
+
+void
+MemoryAccounting::PrintAt (Time printTime, Ptr<OutputStreamWrapper> stream)
+{
+  NS_LOG_FUNCTION (printTime << stream);
+  Simulator::Schedule (printTime, &MemoryAccounting::PrintNow, stream);
+}
+
+} // namespace ns3
@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include "ns3/object.h"
+#include "ns3/type-id.h"
+#include "ns3/nstime.h"
+#include "ns3/output-stream-wrapper.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <ostream>
+
+/**
+ * \ingroup network
+ * \brief Register the memory accountant of an Object subclass.
+ *
+ * The class must have a public static method
+ * \code
+ *   static void AccountMemory (Ptr<Object> object, MemoryAccounting &accounting);
+ * \endcode
+ * which MemoryAccounting calls for every object of the class, or of
+ * a subclass, that it visits.  Like NS_OBJECT_ENSURE_REGISTERED, the
+ * macro goes in the namespace of the class.
+ */
+#define NS_MEMORY_ACCOUNTANT(type)                                      \
+  static struct MemoryAccountant ## type ## RegistrationClass           \
+  {                                                                     \
+    MemoryAccountant ## type ## RegistrationClass () {                  \
+      ns3::MemoryAccounting::AddAccountant (type::GetTypeId (),         \
+                                            &type::AccountMemory);      \
+    }                                                                   \
+  } MemoryAccountant ## type ## RegistrationVariable
+
+namespace ns3 {
+
+class Node;
+
+/**
+ * \ingroup network
+ *
+ * \brief Estimate of the memory held by the simulated objects, by
+ * type of object and by node.
+ *
+ * AccountNodes walks the nodes of the NodeList and, from each node,
+ * every object it can reach: the objects aggregated to it and,
+ * recursively, the objects held by readable Pointer and ObjectVector
+ * or ObjectMap attributes (the devices, their queues, the protocols,
+ * the sockets and their buffers...).  Every object is charged the
+ * size of its class, as registered with NS_OBJECT_ENSURE_REGISTERED,
+ * under the name of its TypeId.
+ *
+ * What an object holds beyond its own size, such as the contents of a
+ * buffer or of a cache, is added by the accountant of its class (see
+ * NS_MEMORY_ACCOUNTANT) under its own category.  Accountants may also
+ * Visit objects which are not reachable through attributes.  The
+ * contents of containers are estimated from their number of elements,
+ * so the figures are a lower bound of what the allocator hands out.
+ *
+ * An object shared by several nodes, like a channel, is charged to the
+ * first node which reaches it.  The pending events are accounted by
+ * AccountEvents, which AccountNodes calls too.
+ *
+ * The accounting only reads the objects, and can be done at any time
+ * of the simulation, e.g.
+ * \code
+ *   MemoryAccounting::PrintAt (Seconds (10), Create<OutputStreamWrapper> (&std::cout));
+ * \endcode
+ */
+class MemoryAccounting
+{
+public:
+  /**
+   * The memory accountant of a class.
+   * \param [in] object The object to account, an instance of the class.
+   * \param [in,out] accounting The accounting to add to.
+   */
+  typedef void (* Accountant)(Ptr<Object> object, MemoryAccounting &accounting);
+
+  /**
+   * The bookkeeping of an element of a node based container (map,
+   * list, hash map), approximated to four pointers.
+   */
+  static const uint32_t CONTAINER_NODE_OVERHEAD = 4 * sizeof (void *);
+
+  MemoryAccounting ();
+
+  /**
+   * Register the accountant of a class, see NS_MEMORY_ACCOUNTANT.
+   * \param [in] tid The TypeId of the class.
+   * \param [in] accountant The accountant.
+   */
+  static void AddAccountant (TypeId tid, Accountant accountant);
+
+  /** Account all the nodes of the NodeList and the pending events. */
+  void AccountNodes (void);
+  /**
+   * Account the objects reachable from a node.
+   * \param [in] node The node.
+   */
+  void AccountNode (Ptr<Node> node);
+  /** Account the events pending in the simulator. */
+  void AccountEvents (void);
+  /**
+   * Account an object and the objects it holds, unless it was already
+   * accounted.  The bytes are charged to the node being accounted.
+   * \param [in] object The object, may be null.
+   */
+  void Visit (Ptr<Object> object);
+  /**
+   * Charge memory to a category and to the node being accounted.
+   * \param [in] category The category, e.g. the TypeId name of the object.
+   * \param [in] bytes The number of bytes.
+   * \param [in] count The number of elements which hold them.
+   */
+  void Add (std::string category, uint64_t bytes, uint64_t count = 1);
+
+  /**
+   * \param [in] category The category.
+   * \returns The bytes charged to the category.
+   */
+  uint64_t GetBytes (std::string category) const;
+  /**
+   * \param [in] category The category.
+   * \returns The number of elements of the category.
+   */
+  uint64_t GetCount (std::string category) const;
+  /**
+   * \param [in] nodeId The id of the node.
+   * \returns The bytes charged to the node.
+   */
+  uint64_t GetNodeBytes (uint32_t nodeId) const;
+  /** \returns The bytes charged to all the categories. */
+  uint64_t GetTotalBytes (void) const;
+
+  /**
+   * Print the categories, largest first, and the nodes which hold the
+   * most memory.
+   * \param [in,out] os The output stream.
+   * \param [in] maxNodes The number of nodes to list.
+   */
+  void Print (std::ostream &os, uint32_t maxNodes = 10) const;
+  /** Forget everything accounted so far. */
+  void Clear (void);
+
+  /**
+   * Account all the nodes and print the result.
+   * \param [in] stream The output stream.
+   */
+  static void PrintNow (Ptr<OutputStreamWrapper> stream);
+  /**
+   * Schedule PrintNow.
+   * \param [in] printTime The delay from now.
+   * \param [in] stream The output stream.
+   */
+  static void PrintAt (Time printTime, Ptr<OutputStreamWrapper> stream);
+
+private:
+  /** Bytes and number of elements of a category. */
+  struct Usage
+  {
+    Usage ();
+    uint64_t bytes;  //!< Bytes charged.
+    uint64_t count;  //!< Elements charged.
+  };
+
+  /**
+   * Visit the objects held by the attributes of an object.
+   * \param [in] object The object.
+   * \param [in] tid The class of the attributes, \p object or a parent.
+   */
+  void VisitAttributes (Ptr<Object> object, TypeId tid);
+
+  /** \returns The accountants, by TypeId. */
+  static std::map<TypeId, Accountant> & GetAccountants (void);
+
+  std::map<std::string, Usage> m_categories;  //!< Usage by category.
+  std::vector<uint64_t> m_nodes;              //!< Bytes by node id.
+  std::set<Object *> m_visited;               //!< Objects already accounted.
+  uint32_t m_node;                            //!< Node being accounted.
+  uint64_t m_total;                           //!< Bytes of all the categories.
+  Time m_time;                                //!< Time of the accounting.
+};
+
+} // namespace ns3
+
+#endif /* MEMORY_ACCOUNTING_H */
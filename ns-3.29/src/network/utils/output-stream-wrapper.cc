@@ -17,6 +17,7 @@
  */
 
 #include "output-stream-wrapper.h"
+#include "async-file-buffer.h"
 #include "ns3/log.h"
 #include "ns3/fatal-impl.h"
 #include "ns3/abort.h"
@@ -27,19 +28,31 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("OutputStreamWrapper");
 
 OutputStreamWrapper::OutputStreamWrapper (std::string filename, std::ios::openmode filemode)
-  : m_destroyable (true)
+  : m_buffer (0),
+    m_destroyable (true)
 {
   NS_LOG_FUNCTION (this << filename << filemode);
-  std::ofstream* os = new std::ofstream ();
-  os->open (filename.c_str (), filemode);
-  m_ostream = os;
+  bool isOpen;
+  if (AsyncFileBuffer::IsEnabled ())
+    {
+      m_buffer = new AsyncFileBuffer (filename, filemode);
+      m_ostream = new std::ostream (m_buffer);
+      isOpen = m_buffer->IsOpen ();
+    }
+  else
+    {
+      std::ofstream* os = new std::ofstream ();
+      os->open (filename.c_str (), filemode);
+      m_ostream = os;
+      isOpen = os->is_open ();
+    }
   FatalImpl::RegisterStream (m_ostream);
-  NS_ABORT_MSG_UNLESS (os->is_open (), "AsciiTraceHelper::CreateFileStream():  " <<
+  NS_ABORT_MSG_UNLESS (isOpen, "AsciiTraceHelper::CreateFileStream():  " <<
                        "Unable to Open " << filename << " for mode " << filemode);
 }
 
 OutputStreamWrapper::OutputStreamWrapper (std::ostream* os)
-  : m_ostream (os), m_destroyable (false)
+  : m_ostream (os), m_buffer (0), m_destroyable (false)
 {
   NS_LOG_FUNCTION (this << os);
   FatalImpl::RegisterStream (m_ostream);
@@ -52,6 +65,12 @@ OutputStreamWrapper::~OutputStreamWrapper ()
   FatalImpl::UnregisterStream (m_ostream);
   if (m_destroyable) delete m_ostream;
   m_ostream = 0;
+  if (m_buffer != 0)
+    {
+      NS_ABORT_MSG_UNLESS (m_buffer->Close (), "Unable to write a trace file");
+      delete m_buffer;
+      m_buffer = 0;
+    }
 }
 
 std::ostream *
@@ -26,6 +26,8 @@
 
 namespace ns3 {
 
+class AsyncFileBuffer;
+
 /**
  * @brief A class encapsulating an output stream.
  *
@@ -66,6 +68,10 @@ namespace ns3 {
  *
  * This class uses a basic ns-3 reference counting base class but is not 
  * an ns3::Object with attributes, TypeId, or aggregation.
+ *
+ * The file opened by the wrapper is written by a background thread,
+ * and possibly compressed, when AsyncFileBuffer::IsEnabled.  The file
+ * is then complete only once the wrapper is destroyed.
  */
 class OutputStreamWrapper : public SimpleRefCount<OutputStreamWrapper>
 {
@@ -94,6 +100,7 @@ public:
 
 private:
   std::ostream *m_ostream; //!< The output stream
+  AsyncFileBuffer *m_buffer; //!< The buffer of a file written in the background, or 0
   bool m_destroyable; //!< Can be destroyed
 };
 
@@ -27,6 +27,7 @@
 #include "ns3/header.h"
 #include "ns3/buffer.h"
 #include "pcap-file.h"
+#include "async-file-buffer.h"
 #include "ns3/log.h"
 #include "ns3/build-profile.h"
 //
@@ -49,6 +50,9 @@ const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pc
 
 PcapFile::PcapFile ()
   : m_file (),
+    m_asyncBuffer (0),
+    m_asyncStream (0),
+    m_output (&m_file),
     m_swapMode (false),
     m_nanosecMode (false)
 {
@@ -68,7 +72,7 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
-  return m_file.fail ();
+  return m_file.fail () || (m_asyncStream != 0 && m_asyncStream->fail ());
 }
 bool 
 PcapFile::Eof (void) const
@@ -88,6 +92,19 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_asyncBuffer != 0)
+    {
+      if (!m_asyncBuffer->Close ())
+        {
+          m_file.setstate (std::ios::failbit);
+        }
+      delete m_asyncStream;
+      delete m_asyncBuffer;
+      m_asyncStream = 0;
+      m_asyncBuffer = 0;
+      m_output = &m_file;
+      return;
+    }
   m_file.close ();
 }
 
@@ -206,7 +223,7 @@ PcapFile::WriteFileHeader (void)
   // If we're initializing the file, we need to write the pcap file header
   // at the start of the file.
   //
-  m_file.seekp (0, std::ios::beg);
+  m_output->seekp (0, std::ios::beg);
  
   //
   // We have the ability to write out the pcap file header in a foreign endian
@@ -234,13 +251,13 @@ PcapFile::WriteFileHeader (void)
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
   //
-  m_file.write ((const char *)&headerOut->m_magicNumber, sizeof(headerOut->m_magicNumber));
-  m_file.write ((const char *)&headerOut->m_versionMajor, sizeof(headerOut->m_versionMajor));
-  m_file.write ((const char *)&headerOut->m_versionMinor, sizeof(headerOut->m_versionMinor));
-  m_file.write ((const char *)&headerOut->m_zone, sizeof(headerOut->m_zone));
-  m_file.write ((const char *)&headerOut->m_sigFigs, sizeof(headerOut->m_sigFigs));
-  m_file.write ((const char *)&headerOut->m_snapLen, sizeof(headerOut->m_snapLen));
-  m_file.write ((const char *)&headerOut->m_type, sizeof(headerOut->m_type));
+  m_output->write ((const char *)&headerOut->m_magicNumber, sizeof(headerOut->m_magicNumber));
+  m_output->write ((const char *)&headerOut->m_versionMajor, sizeof(headerOut->m_versionMajor));
+  m_output->write ((const char *)&headerOut->m_versionMinor, sizeof(headerOut->m_versionMinor));
+  m_output->write ((const char *)&headerOut->m_zone, sizeof(headerOut->m_zone));
+  m_output->write ((const char *)&headerOut->m_sigFigs, sizeof(headerOut->m_sigFigs));
+  m_output->write ((const char *)&headerOut->m_snapLen, sizeof(headerOut->m_snapLen));
+  m_output->write ((const char *)&headerOut->m_type, sizeof(headerOut->m_type));
 }
 
 void
@@ -333,6 +350,17 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
   mode |= std::ios::binary;
 
   m_filename=filename;
+  if ((mode & std::ios::in) == 0 && AsyncFileBuffer::IsEnabled ())
+    {
+      m_asyncBuffer = new AsyncFileBuffer (filename, mode);
+      m_asyncStream = new std::ostream (m_asyncBuffer);
+      m_output = m_asyncStream;
+      if (!m_asyncBuffer->IsOpen ())
+        {
+          m_file.setstate (std::ios::failbit);
+        }
+      return;
+    }
   m_file.open (filename.c_str (), mode);
   if (mode & std::ios::in)
     {
@@ -403,7 +431,7 @@ uint32_t
 PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
-  NS_ASSERT (m_file.good ());
+  NS_ASSERT (m_output->good ());
 
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
 
@@ -422,11 +450,11 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
   //
-  m_file.write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
-  m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
-  m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
-  m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
-  NS_BUILD_DEBUG(m_file.flush());
+  m_output->write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
+  m_output->write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
+  m_output->write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
+  m_output->write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
+  NS_BUILD_DEBUG(m_output->flush());
   return inclLen;
 }
 
@@ -435,8 +463,8 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, ui
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
-  m_file.write ((const char *)data, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  m_output->write ((const char *)data, inclLen);
+  NS_BUILD_DEBUG(m_output->flush());
 }
 
 void 
@@ -444,8 +472,8 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
-  p->CopyData (&m_file, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  p->CopyData (m_output, inclLen);
+  NS_BUILD_DEBUG(m_output->flush());
 }
 
 void 
@@ -460,9 +488,9 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
-  headerBuffer.CopyData (&m_file, toCopy);
+  headerBuffer.CopyData (m_output, toCopy);
   inclLen -= toCopy;
-  p->CopyData (&m_file, inclLen);
+  p->CopyData (m_output, inclLen);
 }
 
 void
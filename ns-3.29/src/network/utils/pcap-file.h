@@ -30,6 +30,7 @@ namespace ns3 {
 
 class Packet;
 class Header;
+class AsyncFileBuffer;
 
 
 /**
@@ -38,6 +39,10 @@ class Header;
  * A class representing a pcap file.  This allows easy creation, writing and 
  * reading of files composed of stored packets; which may be viewed using
  * standard tools.
+ *
+ * A file opened for writing only is written by a background thread,
+ * and possibly compressed, when AsyncFileBuffer::IsEnabled.  The file
+ * is then complete only once it is closed.
  */
 class PcapFile
 {
@@ -368,6 +373,9 @@ private:
 
   std::string    m_filename;    //!< file name
   std::fstream   m_file;        //!< file stream
+  AsyncFileBuffer *m_asyncBuffer; //!< buffer of a file written in the background, or 0
+  std::ostream   *m_asyncStream; //!< stream of the file written in the background, or 0
+  std::ostream   *m_output;     //!< stream the records are written to
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
@@ -20,7 +20,9 @@
 #include "ns3/enum.h"
 #include "ns3/uinteger.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/packet.h"
 #include "queue.h"
+#include "memory-accounting.h"
 
 namespace ns3 {
 
@@ -28,6 +30,7 @@ NS_LOG_COMPONENT_DEFINE ("Queue");
 
 NS_OBJECT_ENSURE_REGISTERED (QueueBase);
 NS_OBJECT_TEMPLATE_CLASS_DEFINE (Queue,Packet);
+NS_MEMORY_ACCOUNTANT (QueueBase);
 
 TypeId
 QueueBase::GetTypeId (void)
@@ -106,6 +109,15 @@ QueueBase::GetNBytes (void) const
   return m_nBytes;
 }
 
+void
+QueueBase::AccountMemory (Ptr<Object> object, MemoryAccounting &accounting)
+{
+  Ptr<QueueBase> queue = DynamicCast<QueueBase> (object);
+  // the Packet objects and their bytes, not the headers and metadata
+  accounting.Add ("queued packets", queue->m_nBytes + queue->m_nPackets * sizeof (Packet),
+                  queue->m_nPackets);
+}
+
 QueueSize
 QueueBase::GetCurrentSize (void) const
 {
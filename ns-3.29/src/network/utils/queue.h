@@ -36,6 +36,8 @@
 
 namespace ns3 {
 
+class MemoryAccounting;
+
 /**
  * \ingroup network
  * \defgroup queue Queue
@@ -57,6 +59,13 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /**
+   * \brief Account the packets held by a queue, see MemoryAccounting
+   * \param object the queue
+   * \param accounting the accounting to add to
+   */
+  static void AccountMemory (Ptr<Object> object, MemoryAccounting &accounting);
+
   QueueBase ();
   virtual ~QueueBase ();
 
@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "segment-offload-tag.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SegmentOffloadTag");
+
+NS_OBJECT_ENSURE_REGISTERED (SegmentOffloadTag);
+
+TypeId 
+SegmentOffloadTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SegmentOffloadTag")
+    .SetParent<Tag> ()
+    .SetGroupName("Network")
+    .AddConstructor<SegmentOffloadTag> ()
+  ;
+  return tid;
+}
+TypeId 
+SegmentOffloadTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+uint32_t 
+SegmentOffloadTag::GetSerializedSize (void) const
+{
+  return 12;
+}
+void 
+SegmentOffloadTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU16 (m_segments);
+  buf.WriteU16 (m_payloadSize);
+  buf.WriteU64 (m_lead);
+}
+void 
+SegmentOffloadTag::Deserialize (TagBuffer buf)
+{
+  m_segments = buf.ReadU16 ();
+  m_payloadSize = buf.ReadU16 ();
+  m_lead = buf.ReadU64 ();
+}
+void 
+SegmentOffloadTag::Print (std::ostream &os) const
+{
+  os << "Segments=" << m_segments << " PayloadSize=" << m_payloadSize
+     << " Lead=" << GetLead ();
+}
+SegmentOffloadTag::SegmentOffloadTag ()
+  : Tag (),
+    m_segments (1),
+    m_payloadSize (0),
+    m_lead (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SegmentOffloadTag::SegmentOffloadTag (uint16_t segments, uint16_t payloadSize)
+  : Tag (),
+    m_segments (segments),
+    m_payloadSize (payloadSize),
+    m_lead (0)
+{
+  NS_LOG_FUNCTION (this << segments << payloadSize);
+}
+
+void
+SegmentOffloadTag::SetSegments (uint16_t segments)
+{
+  m_segments = segments;
+}
+uint16_t
+SegmentOffloadTag::GetSegments (void) const
+{
+  return m_segments;
+}
+void
+SegmentOffloadTag::SetPayloadSize (uint16_t payloadSize)
+{
+  m_payloadSize = payloadSize;
+}
+uint16_t
+SegmentOffloadTag::GetPayloadSize (void) const
+{
+  return m_payloadSize;
+}
+void
+SegmentOffloadTag::SetLead (Time lead)
+{
+  m_lead = lead.GetTimeStep ();
+}
+Time
+SegmentOffloadTag::GetLead (void) const
+{
+  return TimeStep (m_lead);
+}
+
+uint32_t
+SegmentOffloadTag::GetWireSize (uint32_t packetSize) const
+{
+  NS_ASSERT (packetSize >= m_payloadSize);
+  return m_payloadSize + m_segments * (packetSize - m_payloadSize);
+}
+
+} // namespace ns3
@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SEGMENT_OFFLOAD_TAG_H
+#define SEGMENT_OFFLOAD_TAG_H
+
+#include "ns3/tag.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Marks a packet which stands for a train of wire packets.
+ *
+ * A transport protocol doing segmentation offload sends one packet
+ * carrying the payload of several segments, instead of one packet per
+ * segment.  The tag tells the devices on the path how many segments
+ * the packet replaces and how much of it is payload, so that they can
+ * account for the headers every wire packet would carry
+ * (GetWireSize).
+ *
+ * Since the train is handed over as one packet only once its last
+ * segment has arrived, the tag also records how long before that the
+ * first segment arrived (the lead): a store-and-forward hop can start
+ * serializing the train that much earlier, as it would have with the
+ * individual segments.
+ */
+class SegmentOffloadTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  SegmentOffloadTag ();
+
+  /**
+   * \param segments the number of wire segments the packet stands for
+   * \param payloadSize the payload size of the packet
+   */
+  SegmentOffloadTag (uint16_t segments, uint16_t payloadSize);
+  /**
+   * \param segments the number of wire segments the packet stands for
+   */
+  void SetSegments (uint16_t segments);
+  /**
+   * \returns the number of wire segments the packet stands for
+   */
+  uint16_t GetSegments (void) const;
+  /**
+   * \param payloadSize the payload size of the packet
+   */
+  void SetPayloadSize (uint16_t payloadSize);
+  /**
+   * \returns the payload size of the packet
+   */
+  uint16_t GetPayloadSize (void) const;
+  /**
+   * \param lead how long before the packet the first segment of the
+   *        train arrived at the current node
+   */
+  void SetLead (Time lead);
+  /**
+   * \returns how long before the packet the first segment of the
+   *          train arrived at the current node
+   */
+  Time GetLead (void) const;
+  /**
+   * \param packetSize the current size of the tagged packet
+   * \returns the number of bytes the train of segments takes on the
+   *          wire: the payload plus, for every segment, the headers
+   *          currently added on top of the payload
+   */
+  uint32_t GetWireSize (uint32_t packetSize) const;
+private:
+  uint16_t m_segments;     //!< Number of wire segments
+  uint16_t m_payloadSize;  //!< Payload size of the packet
+  int64_t m_lead;          //!< Lead of the first segment, in time steps
+};
+
+} // namespace ns3
+
+#endif /* SEGMENT_OFFLOAD_TAG_H */
@@ -25,6 +25,7 @@
 #include "ns3/abort.h"
 #include "ns3/names.h"
 #include "ns3/ipv4-list-routing.h"
+#include "ns3/memory-accounting.h"
 
 #include "ipv4-nix-vector-routing.h"
 
@@ -33,6 +34,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Ipv4NixVectorRouting");
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4NixVectorRouting);
+NS_MEMORY_ACCOUNTANT (Ipv4NixVectorRouting);
 
 bool Ipv4NixVectorRouting::g_isCacheDirty = false;
 
@@ -47,6 +49,23 @@ Ipv4NixVectorRouting::GetTypeId (void)
   return tid;
 }
 
+void
+Ipv4NixVectorRouting::AccountMemory (Ptr<Object> object, MemoryAccounting &accounting)
+{
+  Ptr<Ipv4NixVectorRouting> nix = DynamicCast<Ipv4NixVectorRouting> (object);
+  uint64_t bytes = 0;
+  for (NixMap_t::const_iterator it = nix->m_nixCache.begin (); it != nix->m_nixCache.end (); ++it)
+    {
+      bytes += sizeof (NixMap_t::value_type) + MemoryAccounting::CONTAINER_NODE_OVERHEAD
+        + sizeof (NixVector) + it->second->GetSerializedSize ();
+    }
+  accounting.Add ("nix vector cache", bytes, nix->m_nixCache.size ());
+  uint64_t routes = nix->m_ipv4RouteCache.size ();
+  accounting.Add ("nix route cache", routes * (sizeof (Ipv4RouteMap_t::value_type) + sizeof (Ipv4Route)
+                                               + MemoryAccounting::CONTAINER_NODE_OVERHEAD),
+                  routes);
+}
+
 Ipv4NixVectorRouting::Ipv4NixVectorRouting ()
   : m_totalNeighbors (0)
 {
@@ -166,7 +185,7 @@ Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetD
     }
 }
 
-Ptr<NixVector>
+Ptr<const NixVector>
 Ipv4NixVectorRouting::GetNixVectorInCache (Ipv4Address address)
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -492,8 +511,7 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
 {
   NS_LOG_FUNCTION_NOARGS ();
   Ptr<Ipv4Route> rtentry;
-  Ptr<NixVector> nixVectorInCache;
-  Ptr<NixVector> nixVectorForPacket;
+  Ptr<const NixVector> nixVectorInCache;
 
   CheckCacheStateAndFlush ();
 
@@ -518,11 +536,6 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
     {
       NS_LOG_LOGIC ("Nix-vector contents: " << *nixVectorInCache);
 
-      // create a new nix vector to be used, 
-      // we want to keep the cached version clean
-      nixVectorForPacket = Create<NixVector> ();
-      nixVectorForPacket = nixVectorInCache->Copy (); 
-
       // Get the interface number that we go out of, by extracting
       // from the nix-vector
       if (m_totalNeighbors == 0)
@@ -531,9 +544,11 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
         }
 
       // Get the interface number that we go out of, by extracting
-      // from the nix-vector
-      uint32_t numberOfBits = nixVectorForPacket->BitCount (m_totalNeighbors);
-      uint32_t nodeIndex = nixVectorForPacket->ExtractNeighborIndex (numberOfBits);
+      // from the nix-vector.  The cached version is shared by the
+      // packets, which only carry the number of bits used
+      uint32_t usedBits = nixVectorInCache->GetUsedBits ();
+      uint32_t numberOfBits = nixVectorInCache->BitCount (m_totalNeighbors);
+      uint32_t nodeIndex = nixVectorInCache->ExtractNeighborIndex (numberOfBits, usedBits);
 
       // Search here in a cache for this node index 
       // and look for a Ipv4Route
@@ -591,14 +606,14 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
           m_ipv4RouteCache.insert (Ipv4RouteMap_t::value_type (header.GetDestination (), rtentry));
         }
 
-      NS_LOG_LOGIC ("Nix-vector contents: " << *nixVectorInCache << " : Remaining bits: " << nixVectorForPacket->GetRemainingBits ());
+      NS_LOG_LOGIC ("Nix-vector contents: " << *nixVectorInCache << " : Remaining bits: " << nixVectorInCache->GetRemainingBits (usedBits));
 
       // Add  nix-vector in the packet class 
       // make sure the packet exists first
       if (p)
         {
-          NS_LOG_LOGIC ("Adding Nix-vector to packet: " << *nixVectorForPacket);
-          p->SetNixVector (nixVectorForPacket);
+          NS_LOG_LOGIC ("Adding Nix-vector to packet: " << *nixVectorInCache);
+          p->SetNixVector (nixVectorInCache, usedBits);
         }
     }
   else // path doesn't exist
@@ -647,7 +662,7 @@ Ipv4NixVectorRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
   Ptr<Ipv4Route> rtentry;
 
   // Get the nix-vector from the packet
-  Ptr<NixVector> nixVector = p->GetNixVector ();
+  Ptr<const NixVector> nixVector = p->GetNixVector ();
 
   // If nixVector isn't in packet, something went wrong
   NS_ASSERT (nixVector);
@@ -659,7 +674,7 @@ Ipv4NixVectorRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
       m_totalNeighbors = FindTotalNeighbors ();
     }
   uint32_t numberOfBits = nixVector->BitCount (m_totalNeighbors);
-  uint32_t nodeIndex = nixVector->ExtractNeighborIndex (numberOfBits);
+  uint32_t nodeIndex = p->ExtractNixNeighborIndex (numberOfBits);
 
   rtentry = GetIpv4RouteInCache (header.GetDestination ());
   // not in cache
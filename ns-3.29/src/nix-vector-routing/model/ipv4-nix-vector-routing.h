@@ -35,6 +35,8 @@
 
 namespace ns3 {
 
+class MemoryAccounting;
+
 /**
  * \defgroup nix-vector-routing Nix-Vector Routing
  *
@@ -44,9 +46,10 @@ namespace ns3 {
 
 /**
  * \ingroup nix-vector-routing
- * Map of Ipv4Address to NixVector
+ * Map of Ipv4Address to NixVector.  The cached nix-vectors are
+ * shared by the packets to the destination, and never changed.
  */
-typedef std::map<Ipv4Address, Ptr<NixVector> > NixMap_t;
+typedef std::map<Ipv4Address, Ptr<const NixVector> > NixMap_t;
 /**
  * \ingroup nix-vector-routing
  * Map of Ipv4Address to Ipv4Route
@@ -68,6 +71,12 @@ public:
    * @see Object::GetObject ()
    */
   static TypeId GetTypeId (void);
+  /**
+   * @brief Account the nix vector and route caches, see MemoryAccounting
+   * @param object the routing protocol
+   * @param accounting the accounting to add to
+   */
+  static void AccountMemory (Ptr<Object> object, MemoryAccounting &accounting);
   /**
    * @brief Set the Node pointer of the node for which this
    * routing protocol is to be placed
@@ -126,7 +135,7 @@ private:
    * \param address Address to check
    * \returns The NixVector to be used in routing.
    */
-  Ptr<NixVector> GetNixVectorInCache (Ipv4Address address);
+  Ptr<const NixVector> GetNixVectorInCache (Ipv4Address address);
 
   /**
    * Checks the cache based on dest IP for the Ipv4Route
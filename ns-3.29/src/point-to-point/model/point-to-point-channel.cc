@@ -22,6 +22,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
 
 namespace ns3 {
 
@@ -40,6 +41,14 @@ PointToPointChannel::GetTypeId (void)
                    TimeValue (Seconds (0)),
                    MakeTimeAccessor (&PointToPointChannel::m_delay),
                    MakeTimeChecker ())
+    .AddAttribute ("CoalesceDelivery",
+                   "If true, packets in flight on a wire are kept in a FIFO "
+                   "and a single receive event, armed for the head of the "
+                   "FIFO, delivers every packet due at that time.  Delivery "
+                   "times are unchanged.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointChannel::m_coalesceDelivery),
+                   MakeBooleanChecker ())
     .AddTraceSource ("TxRxPointToPoint",
                      "Trace source indicating transmission of packet "
                      "from the PointToPointChannel, used by the Animation "
@@ -57,11 +66,24 @@ PointToPointChannel::PointToPointChannel()
   :
     Channel (),
     m_delay (Seconds (0.)),
-    m_nDevices (0)
+    m_nDevices (0),
+    m_coalesceDelivery (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
 
+void
+PointToPointChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::size_t i = 0; i < N_DEVICES; ++i)
+    {
+      m_link[i].m_inFlight.clear ();
+      m_link[i].m_armed = false;
+    }
+  Channel::DoDispose ();
+}
+
 void
 PointToPointChannel::Attach (Ptr<PointToPointNetDevice> device)
 {
@@ -97,15 +119,122 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
-  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
-                                  txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p->Copy ());
+  Propagate (wire, p->Copy (), 0, false, txTime + m_delay);
 
   // Call the tx anim callback on the net device
   m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
   return true;
 }
 
+bool
+PointToPointChannel::TransmitDirect (
+  Ptr<const Packet> p,
+  Ptr<PointToPointNetDevice> src,
+  uint16_t protocol,
+  Time txDelay,
+  Time txTime)
+{
+  NS_LOG_FUNCTION (this << p << src << protocol << txDelay);
+  NS_LOG_LOGIC ("UID is " << p->GetUid () << ")");
+
+  NS_ASSERT (m_link[0].m_state != INITIALIZING);
+  NS_ASSERT (m_link[1].m_state != INITIALIZING);
+
+  uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+
+  Propagate (wire, p->Copy (), protocol, true, txDelay + txTime + m_delay);
+
+  m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
+  return true;
+}
+
+void
+PointToPointChannel::Propagate (uint32_t wire, Ptr<Packet> p, uint16_t protocol, bool direct, Time delay)
+{
+  NS_LOG_FUNCTION (this << wire << p << protocol << direct << delay);
+
+  Link &link = m_link[wire];
+  Time rxTime = Simulator::Now () + delay;
+
+  //
+  // A wire is a FIFO as long as the delay does not change under our feet,
+  // so the packet can join the train already in flight.  Otherwise (or if
+  // coalescing is off) it gets its own receive event.
+  //
+  if (!m_coalesceDelivery
+      || (!link.m_inFlight.empty () && link.m_inFlight.back ().m_rxTime > rxTime))
+    {
+      uint32_t context = link.m_dst->GetNode ()->GetId ();
+      if (direct)
+        {
+          Simulator::ScheduleWithContext (context, delay, &PointToPointNetDevice::ReceiveDirect,
+                                          link.m_dst, p, protocol);
+        }
+      else
+        {
+          Simulator::ScheduleWithContext (context, delay, &PointToPointNetDevice::Receive,
+                                          link.m_dst, p);
+        }
+      return;
+    }
+
+  Link::InFlight inFlight;
+  inFlight.m_rxTime = rxTime;
+  inFlight.m_packet = p;
+  inFlight.m_protocol = protocol;
+  inFlight.m_direct = direct;
+  link.m_inFlight.push_back (inFlight);
+
+  if (!link.m_armed)
+    {
+      NS_LOG_LOGIC ("Arm delivery event of wire " << wire);
+      link.m_armed = true;
+      Simulator::ScheduleWithContext (link.m_dst->GetNode ()->GetId (), delay,
+                                      &PointToPointChannel::DeliverDue, this, wire);
+    }
+}
+
+void
+PointToPointChannel::DeliverDue (uint32_t wire)
+{
+  NS_LOG_FUNCTION (this << wire);
+
+  Link &link = m_link[wire];
+  NS_ASSERT (link.m_armed);
+  NS_ASSERT (!link.m_inFlight.empty ());
+  NS_ASSERT (link.m_inFlight.front ().m_rxTime == Simulator::Now ());
+
+  //
+  // The wire stays armed while the train is handed over, since the receive
+  // path may well transmit on this very channel: packets it puts on the
+  // wire only join the FIFO, and are delivered here if they are due now.
+  //
+  while (!link.m_inFlight.empty ()
+         && link.m_inFlight.front ().m_rxTime == Simulator::Now ())
+    {
+      Link::InFlight head = link.m_inFlight.front ();
+      link.m_inFlight.pop_front ();
+      if (head.m_direct)
+        {
+          link.m_dst->ReceiveDirect (head.m_packet, head.m_protocol);
+        }
+      else
+        {
+          link.m_dst->Receive (head.m_packet);
+        }
+    }
+
+  if (link.m_inFlight.empty ())
+    {
+      link.m_armed = false;
+    }
+  else
+    {
+      Simulator::Schedule (link.m_inFlight.front ().m_rxTime - Simulator::Now (),
+                           &PointToPointChannel::DeliverDue, this, wire);
+    }
+}
+
 std::size_t
 PointToPointChannel::GetNDevices (void) const
 {
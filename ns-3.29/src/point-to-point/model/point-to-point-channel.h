@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_CHANNEL_H
 
 #include <list>
+#include <deque>
 #include "ns3/channel.h"
 #include "ns3/ptr.h"
 #include "ns3/nstime.h"
@@ -80,6 +81,22 @@ public:
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src, Time txTime);
 
+  /**
+   * \brief Transmit a packet over this channel in direct link mode
+   *
+   * The packet is delivered to the destination device by a single event,
+   * scheduled for the time its last bit arrives.
+   *
+   * \param p Packet to transmit
+   * \param src Source PointToPointNetDevice
+   * \param protocol Ethernet protocol number of the packet
+   * \param txDelay Time until the source starts serializing the packet
+   * \param txTime Transmit time to apply
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitDirect (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src,
+                               uint16_t protocol, Time txDelay, Time txTime);
+
   /**
    * \brief Get number of devices on this channel
    * \returns number of devices on this channel
@@ -101,6 +118,8 @@ public:
   virtual Ptr<NetDevice> GetDevice (std::size_t i) const;
 
 protected:
+  virtual void DoDispose (void);
+
   /**
    * \brief Get the delay associated with this channel
    * \returns Time delay
@@ -149,8 +168,34 @@ private:
   /** Each point to point link has exactly two net devices. */
   static const std::size_t N_DEVICES = 2;
 
+  /**
+   * \brief Put a packet on a wire for later delivery
+   *
+   * Without delivery coalescing a receive event is scheduled right away.
+   * Otherwise the packet is appended to the in-flight FIFO of the wire and
+   * an event is only scheduled if the wire has none pending.
+   *
+   * \param wire the wire the packet is sent on
+   * \param p the packet (already copied)
+   * \param protocol Ethernet protocol number, used in direct link mode
+   * \param direct true if the packet was sent in direct link mode
+   * \param delay time until the last bit reaches the destination
+   */
+  void Propagate (uint32_t wire, Ptr<Packet> p, uint16_t protocol, bool direct, Time delay);
+
+  /**
+   * \brief Deliver the packets of the in-flight FIFO of a wire that are due
+   *
+   * Hands over every packet at the head of the FIFO whose last bit arrives
+   * now, then re-arms itself for the next packet in the FIFO, if any.
+   *
+   * \param wire the wire to deliver from
+   */
+  void DeliverDue (uint32_t wire);
+
   Time          m_delay;    //!< Propagation delay
   std::size_t        m_nDevices; //!< Devices of this channel
+  bool          m_coalesceDelivery; //!< Schedule one event per train of packets
 
   /**
    * The trace source for the packet transmission animation events that the 
@@ -194,11 +239,24 @@ public:
     /** \brief Create the link, it will be in INITIALIZING state
      *
      */
-    Link() : m_state (INITIALIZING), m_src (0), m_dst (0) {}
+    Link() : m_state (INITIALIZING), m_src (0), m_dst (0), m_armed (false) {}
+
+    /**
+     * \brief A packet on the wire, waiting for its last bit to arrive
+     */
+    struct InFlight
+    {
+      Time        m_rxTime;   //!< Absolute time the last bit arrives
+      Ptr<Packet> m_packet;   //!< The packet
+      uint16_t    m_protocol; //!< Protocol number (direct link mode only)
+      bool        m_direct;   //!< Sent in direct link mode
+    };
 
     WireState                  m_state; //!< State of the link
     Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
     Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    std::deque<InFlight>       m_inFlight; //!< Packets on the wire, in arrival order
+    bool                       m_armed; //!< A delivery event is pending for the FIFO
   };
 
   Link    m_link[N_DEVICES]; //!< Link model
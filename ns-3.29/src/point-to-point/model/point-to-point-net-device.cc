@@ -25,9 +25,12 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/segment-offload-tag.h"
+#include "ns3/boolean.h"
 #include "ns3/net-device-queue-interface.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
+#include "point-to-point-remote-channel.h"
 #include "ppp-header.h"
 
 namespace ns3 {
@@ -68,6 +71,15 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("DirectLink",
+                   "If true, packets bypass the transmit queue and the PPP "
+                   "framing and are handed straight to the channel, with a "
+                   "single scheduled event per packet.  Serialization and "
+                   "propagation delays are preserved.  Queue traces and "
+                   "PhyTxEnd do not fire in this mode.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointNetDevice::m_directLink),
+                   MakeBooleanChecker ())
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -176,6 +188,9 @@ PointToPointNetDevice::GetTypeId (void)
 PointToPointNetDevice::PointToPointNetDevice () 
   :
     m_txMachineState (READY),
+    m_directLink (false),
+    m_txFreeTime (Seconds (0)),
+    m_remoteChannel (false),
     m_channel (0),
     m_linkUp (false),
     m_currentPkt (0)
@@ -284,8 +299,9 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   m_currentPkt = p;
   m_phyTxBeginTrace (m_currentPkt);
 
-  Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+  Time txTime = GetTxEnd (p, m_txFreeTime) - Simulator::Now ();
   Time txCompleteTime = txTime + m_tInterframeGap;
+  m_txFreeTime = Simulator::Now () + txCompleteTime;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
   Simulator::Schedule (txCompleteTime, &PointToPointNetDevice::TransmitComplete, this);
@@ -332,12 +348,77 @@ PointToPointNetDevice::TransmitComplete (void)
   TransmitStart (p);
 }
 
+bool
+PointToPointNetDevice::TransmitDirect (Ptr<Packet> p, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << p << protocolNumber);
+  NS_LOG_LOGIC ("UID is " << p->GetUid () << ")");
+
+  m_macTxTrace (p);
+  m_snifferTrace (p);
+  m_promiscSnifferTrace (p);
+  m_phyTxBeginTrace (p);
+
+  //
+  // The wire is busy until m_txFreeTime.  A packet arriving earlier starts
+  // serializing when the wire frees up, exactly as if it had been sitting
+  // in an unbounded device queue.
+  //
+  Time now = Simulator::Now ();
+  Time txEnd = GetTxEnd (p, m_txFreeTime);
+  Time txTime = std::min (txEnd - now, m_bps.CalculateBytesTxTime (p->GetSize ()));
+  m_txFreeTime = txEnd + m_tInterframeGap;
+
+  NS_LOG_LOGIC ("Direct transmit starts in " << (txEnd - now - txTime).GetSeconds () << "sec");
+
+  bool result = m_channel->TransmitDirect (p, this, protocolNumber, txEnd - now - txTime, txTime);
+  if (result == false)
+    {
+      m_phyTxDropTrace (p);
+    }
+  return result;
+}
+
+Time
+PointToPointNetDevice::GetTxEnd (Ptr<Packet> p, Time txFreeTime)
+{
+  NS_LOG_FUNCTION (this << p << txFreeTime);
+
+  Time now = Simulator::Now ();
+  SegmentOffloadTag tag;
+  if (!p->PeekPacketTag (tag))
+    {
+      return std::max (now, txFreeTime) + m_bps.CalculateBytesTxTime (p->GetSize ());
+    }
+
+  //
+  // A TCP super-segment stands for a train of segments sent back to back,
+  // each with its own headers.  The train occupies the wire for as long as
+  // the segments would, but the first of them could have been forwarded as
+  // soon as it was received: the lead carried by the tag is how much earlier
+  // than the arrival of the whole train that was, and the train may start
+  // that much in the past if the wire was free.  The train cannot complete
+  // before one segment has been serialized from now on.
+  //
+  uint32_t segments = tag.GetSegments ();
+  uint32_t wireSize = tag.GetWireSize (p->GetSize ());
+  Time trainTime = m_bps.CalculateBytesTxTime (wireSize) + m_tInterframeGap * (segments - 1);
+  Time segmentTime = m_bps.CalculateBytesTxTime (wireSize / segments);
+  Time txStart = std::max (now - tag.GetLead (), txFreeTime);
+  Time txEnd = std::max (txStart + trainTime, now + segmentTime);
+
+  tag.SetLead (txEnd - (txStart + segmentTime));
+  p->ReplacePacketTag (tag);
+  return txEnd;
+}
+
 bool
 PointToPointNetDevice::Attach (Ptr<PointToPointChannel> ch)
 {
   NS_LOG_FUNCTION (this << &ch);
 
   m_channel = ch;
+  m_remoteChannel = (DynamicCast<PointToPointRemoteChannel> (ch) != 0);
 
   m_channel->Attach (this);
 
@@ -414,6 +495,35 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
     }
 }
 
+void
+PointToPointNetDevice::ReceiveDirect (Ptr<Packet> packet, uint16_t protocol)
+{
+  NS_LOG_FUNCTION (this << packet << protocol);
+
+  if (m_receiveErrorModel && m_receiveErrorModel->IsCorrupt (packet) ) 
+    {
+      m_phyRxDropTrace (packet);
+      return;
+    }
+
+  m_snifferTrace (packet);
+  m_promiscSnifferTrace (packet);
+  m_phyRxEndTrace (packet);
+
+  //
+  // There is no header to strip, so the trace sinks and the protocol stack
+  // can share the packet; no copy is needed.
+  //
+  if (!m_promiscCallback.IsNull ())
+    {
+      m_macPromiscRxTrace (packet);
+      m_promiscCallback (this, packet, protocol, GetRemote (), GetAddress (), NetDevice::PACKET_HOST);
+    }
+
+  m_macRxTrace (packet);
+  m_rxCallback (this, packet, protocol, GetRemote ());
+}
+
 Ptr<Queue<Packet> >
 PointToPointNetDevice::GetQueue (void) const
 { 
@@ -559,6 +669,11 @@ PointToPointNetDevice::Send (
       return false;
     }
 
+  if (m_directLink && !m_remoteChannel)
+    {
+      return TransmitDirect (packet, protocolNumber);
+    }
+
   //
   // Stick a point to point protocol header on the packet in preparation for
   // shoving it out the door.
@@ -150,6 +150,18 @@ public:
    */
   void Receive (Ptr<Packet> p);
 
+  /**
+   * Receive a packet from a connected PointToPointChannel in direct link
+   * mode.
+   *
+   * Packets sent in direct link mode carry no PPP header, so the channel
+   * hands the protocol number over alongside the packet.
+   *
+   * \param p Ptr to the received packet.
+   * \param protocol the Ethernet protocol number of the packet.
+   */
+  void ReceiveDirect (Ptr<Packet> p, uint16_t protocol);
+
   // The remaining methods are documented in ns3::NetDevice*
 
   virtual void SetIfIndex (const uint32_t index);
@@ -279,6 +291,36 @@ private:
    */
   void TransmitComplete (void);
 
+  /**
+   * Send a Packet Down the Wire in direct link mode.
+   *
+   * The packet bypasses the device queue and the PPP framing and is handed
+   * straight to the channel.  The device only remembers when the wire
+   * becomes free again, so a packet sent while the wire is busy starts
+   * serializing right after the previous one, as it would have after
+   * waiting in the queue.  No transmit complete event is scheduled.
+   *
+   * \see PointToPointChannel::TransmitDirect ()
+   * \param p a reference to the packet to send
+   * \param protocolNumber protocol number of the packet
+   * \returns true if success, false on failure
+   */
+  bool TransmitDirect (Ptr<Packet> p, uint16_t protocolNumber);
+
+  /**
+   * Compute when the transmission of a packet ends.
+   *
+   * A packet carrying a SegmentOffloadTag is a TCP super-segment and is
+   * timed as the train of segments it stands for, pipelined with the hop
+   * it arrived from; its tag is updated for the next hop.  Any other packet
+   * starts when the wire is free and lasts its serialization time.
+   *
+   * \param p the packet to send
+   * \param txFreeTime the time at which the wire is free again
+   * \returns the time at which the last bit of the packet leaves
+   */
+  Time GetTxEnd (Ptr<Packet> p, Time txFreeTime);
+
   /**
    * \brief Make the link up and running
    *
@@ -311,6 +353,22 @@ private:
    */
   Time           m_tInterframeGap;
 
+  /**
+   * True if packets bypass the device queue and the PPP framing
+   */
+  bool           m_directLink;
+
+  /**
+   * Time at which the wire is free again
+   */
+  Time           m_txFreeTime;
+
+  /**
+   * True if the attached channel is a PointToPointRemoteChannel, on which
+   * direct link mode falls back to the regular transmit path
+   */
+  bool           m_remoteChannel;
+
   /**
    * The PointToPointChannel to which this PointToPointNetDevice has been
    * attached.
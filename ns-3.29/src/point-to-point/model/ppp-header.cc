@@ -92,6 +92,19 @@ PppHeader::Deserialize (Buffer::Iterator start)
   return GetSerializedSize ();
 }
 
+Header *
+PppHeader::Copy (void) const
+{
+  return new PppHeader (*this);
+}
+
+bool
+PppHeader::Assign (const Header &header)
+{
+  m_protocol = static_cast<const PppHeader &> (header).m_protocol;
+  return true;
+}
+
 void
 PppHeader::SetProtocol (uint16_t protocol)
 {
@@ -77,6 +77,8 @@ public:
   virtual void Print (std::ostream &os) const;
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual Header *Copy (void) const;
+  virtual bool Assign (const Header &header);
   virtual uint32_t GetSerializedSize (void) const;
 
   /**
@@ -24,6 +24,11 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
+#include "ns3/node-container.h"
+#include "ns3/segment-offload-tag.h"
+#include <set>
 
 using namespace ns3;
 
@@ -101,6 +106,421 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test class for the direct link mode of the PointToPoint model
+ *
+ * It sends a burst of packets back to back over a direct link and checks
+ * that each one arrives after its serialization and propagation delay,
+ * without PPP header and with the protocol number preserved.
+ */
+class PointToPointDirectLinkTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointDirectLinkTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send a burst of packets to the device specified
+   *
+   * \param device NetDevice to send to
+   */
+  void SendBurst (Ptr<PointToPointNetDevice> device);
+
+  /**
+   * \brief Receive callback of the destination device
+   *
+   * \param device the receiving NetDevice
+   * \param p the received packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  std::vector<Time> m_rxTimes;  //!< Arrival time of each packet
+};
+
+PointToPointDirectLinkTest::PointToPointDirectLinkTest ()
+  : TestCase ("PointToPoint direct link")
+{
+}
+
+void
+PointToPointDirectLinkTest::SendBurst (Ptr<PointToPointNetDevice> device)
+{
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      device->Send (p, device->GetBroadcast (), 0x800);
+    }
+}
+
+bool
+PointToPointDirectLinkTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  NS_TEST_EXPECT_MSG_EQ (protocol, 0x800, "Protocol number lost on direct link");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 1000, "Direct link should not add a PPP header");
+  m_rxTimes.push_back (Simulator::Now ());
+  return true;
+}
+
+void
+PointToPointDirectLinkTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+
+  devA->SetAttribute ("DirectLink", BooleanValue (true));
+  devA->SetDataRate (DataRate ("8Mbps"));
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->SetAttribute ("DirectLink", BooleanValue (true));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  // Node::AddDevice installs its own receive callback, so override it afterwards
+  devB->SetReceiveCallback (MakeCallback (&PointToPointDirectLinkTest::Receive, this));
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointDirectLinkTest::SendBurst, this, devA);
+
+  Simulator::Run ();
+
+  // 1000 bytes at 8Mbps take 1ms on the wire, plus 1ms of propagation
+  NS_TEST_ASSERT_MSG_EQ (m_rxTimes.size (), 3, "Not all packets were received");
+  for (uint32_t i = 0; i < m_rxTimes.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_rxTimes[i], Seconds (1.0) + MilliSeconds (2 + i),
+                             "Packet " << i << " received at the wrong time");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Test class for coalesced delivery on PointToPointChannel
+ *
+ * It sends the same bursts of packets in both directions with and
+ * without delivery coalescing, in regular and direct link mode, and checks
+ * that every packet is delivered at exactly the same time.  It also checks
+ * that packets arriving at the same time are delivered by a single event.
+ */
+class PointToPointCoalescedDeliveryTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointCoalescedDeliveryTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send a burst of packets of increasing size to the device specified
+   *
+   * \param device NetDevice to send to
+   * \param n number of packets
+   */
+  void SendBurst (Ptr<PointToPointNetDevice> device, uint32_t n);
+
+  /**
+   * \brief Receive callback of both devices
+   *
+   * \param device the receiving NetDevice
+   * \param p the received packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  /**
+   * \brief Simulate the bursts and record the arrival times
+   *
+   * \param direct whether to use direct link mode
+   * \param coalesce whether to coalesce delivery events
+   * \returns the arrival time of each packet, in arrival order
+   */
+  std::vector<std::pair<uint32_t, Time> > Simulate (bool direct, bool coalesce);
+
+  /**
+   * \brief Simulate a burst whose packets all arrive at the same time
+   *
+   * \param coalesce whether to coalesce delivery events
+   * \returns the number of events which delivered the burst
+   */
+  uint32_t SimulateSimultaneous (bool coalesce);
+
+  std::vector<std::pair<uint32_t, Time> > m_rxTimes;  //!< Size and arrival time of each packet
+  std::set<uint64_t> m_rxEvents;  //!< Events which delivered a packet
+};
+
+PointToPointCoalescedDeliveryTest::PointToPointCoalescedDeliveryTest ()
+  : TestCase ("PointToPoint coalesced delivery")
+{
+}
+
+void
+PointToPointCoalescedDeliveryTest::SendBurst (Ptr<PointToPointNetDevice> device, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Ptr<Packet> p = Create<Packet> (100 * (i + 1));
+      device->Send (p, device->GetBroadcast (), 0x800);
+    }
+}
+
+bool
+PointToPointCoalescedDeliveryTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_rxTimes.push_back (std::make_pair (p->GetSize (), Simulator::Now ()));
+  m_rxEvents.insert (Simulator::GetEventCount ());
+  return true;
+}
+
+std::vector<std::pair<uint32_t, Time> >
+PointToPointCoalescedDeliveryTest::Simulate (bool direct, bool coalesce)
+{
+  m_rxTimes.clear ();
+
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  channel->SetAttribute ("CoalesceDelivery", BooleanValue (coalesce));
+
+  devA->SetAttribute ("DirectLink", BooleanValue (direct));
+  devA->SetDataRate (DataRate ("8Mbps"));
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->SetAttribute ("DirectLink", BooleanValue (direct));
+  devB->SetDataRate (DataRate ("4Mbps"));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devA->SetReceiveCallback (MakeCallback (&PointToPointCoalescedDeliveryTest::Receive, this));
+  devB->SetReceiveCallback (MakeCallback (&PointToPointCoalescedDeliveryTest::Receive, this));
+
+  // Two overlapping trains from a, one from b, and a late straggler from a
+  Simulator::Schedule (Seconds (1.0), &PointToPointCoalescedDeliveryTest::SendBurst, this, devA, 10);
+  Simulator::Schedule (Seconds (1.0) + MicroSeconds (1500), &PointToPointCoalescedDeliveryTest::SendBurst, this, devA, 5);
+  Simulator::Schedule (Seconds (1.0) + MicroSeconds (700), &PointToPointCoalescedDeliveryTest::SendBurst, this, devB, 8);
+  Simulator::Schedule (Seconds (2.0), &PointToPointCoalescedDeliveryTest::SendBurst, this, devA, 1);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  return m_rxTimes;
+}
+
+uint32_t
+PointToPointCoalescedDeliveryTest::SimulateSimultaneous (bool coalesce)
+{
+  m_rxTimes.clear ();
+  m_rxEvents.clear ();
+
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  channel->SetAttribute ("CoalesceDelivery", BooleanValue (coalesce));
+
+  // Small packets on a very fast link take no time to serialize
+  devA->SetAttribute ("DirectLink", BooleanValue (true));
+  devA->SetDataRate (DataRate ("4000Gbps"));
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->SetAttribute ("DirectLink", BooleanValue (true));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointCoalescedDeliveryTest::Receive, this));
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointCoalescedDeliveryTest::SendBurst, this, devA, 1);
+  Simulator::Schedule (Seconds (1.0), &PointToPointCoalescedDeliveryTest::SendBurst, this, devA, 1);
+  Simulator::Schedule (Seconds (1.0), &PointToPointCoalescedDeliveryTest::SendBurst, this, devA, 1);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes.size (), 3, "Not all packets were received");
+  for (uint32_t i = 0; i < m_rxTimes.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_rxTimes[i].second, Seconds (1) + MilliSeconds (1),
+                             "Packet " << i << " delivered at the wrong time");
+    }
+  return m_rxEvents.size ();
+}
+
+void
+PointToPointCoalescedDeliveryTest::DoRun (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (SimulateSimultaneous (false), 3, "Expected one event per packet");
+  NS_TEST_EXPECT_MSG_EQ (SimulateSimultaneous (true), 1, "Expected one event for the packets due together");
+
+  for (uint32_t direct = 0; direct < 2; ++direct)
+    {
+      std::vector<std::pair<uint32_t, Time> > reference = Simulate (direct, false);
+      std::vector<std::pair<uint32_t, Time> > coalesced = Simulate (direct, true);
+
+      NS_TEST_ASSERT_MSG_EQ (reference.size (), 24, "Not all packets were received");
+      NS_TEST_ASSERT_MSG_EQ (coalesced.size (), reference.size (), "Coalescing lost packets");
+      for (uint32_t i = 0; i < reference.size (); ++i)
+        {
+          NS_TEST_EXPECT_MSG_EQ (coalesced[i].first, reference[i].first,
+                                 "Packet " << i << " delivered out of order");
+          NS_TEST_EXPECT_MSG_EQ (coalesced[i].second, reference[i].second,
+                                 "Packet " << i << " delivered at the wrong time");
+        }
+    }
+}
+
+/**
+ * \brief Test class for TCP super-segments on the PointToPoint model
+ *
+ * It forwards a packet tagged as a train of segments over two direct
+ * links and checks that each hop takes the time of the train, headers of
+ * every segment included, and that the second hop starts as soon as the
+ * first segment of the train has arrived.
+ */
+class PointToPointSegmentOffloadTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointSegmentOffloadTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Receive callback of the middle node, forwards the packet
+   *
+   * \param device the receiving NetDevice
+   * \param p the received packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \returns true
+   */
+  bool Forward (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  /**
+   * \brief Receive callback of the last node
+   *
+   * \param device the receiving NetDevice
+   * \param p the received packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  Ptr<PointToPointNetDevice> m_next;  //!< Device the middle node forwards to
+  std::vector<Time> m_rxTimes;        //!< Arrival time at each hop
+};
+
+PointToPointSegmentOffloadTest::PointToPointSegmentOffloadTest ()
+  : TestCase ("PointToPoint segmentation offload")
+{
+}
+
+bool
+PointToPointSegmentOffloadTest::Forward (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+  m_next->Send (p->Copy (), m_next->GetBroadcast (), protocol);
+  return true;
+}
+
+bool
+PointToPointSegmentOffloadTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+  return true;
+}
+
+void
+PointToPointSegmentOffloadTest::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  std::vector<Ptr<PointToPointNetDevice> > devices;
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+      channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+      for (uint32_t j = 0; j < 2; ++j)
+        {
+          Ptr<PointToPointNetDevice> device = CreateObject<PointToPointNetDevice> ();
+          device->SetAttribute ("DirectLink", BooleanValue (true));
+          device->SetDataRate (DataRate ("8Mbps"));
+          device->Attach (channel);
+          device->SetAddress (Mac48Address::Allocate ());
+          device->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+          nodes.Get (i + j)->AddDevice (device);
+          devices.push_back (device);
+        }
+    }
+  m_next = devices[2];
+  devices[1]->SetReceiveCallback (MakeCallback (&PointToPointSegmentOffloadTest::Forward, this));
+  devices[3]->SetReceiveCallback (MakeCallback (&PointToPointSegmentOffloadTest::Receive, this));
+
+  // 4 segments of 250 bytes of payload, each with 40 bytes of headers
+  Ptr<Packet> p = Create<Packet> (1040);
+  p->AddPacketTag (SegmentOffloadTag (4, 1000));
+  Simulator::Schedule (Seconds (1.0), &PointToPointNetDevice::Send, devices[0],
+                       p, devices[0]->GetBroadcast (), 0x800);
+
+  Simulator::Run ();
+
+  // The train is 1160 bytes, 1.16ms at 8Mbps, a segment 0.29ms.  The first
+  // segment reaches the middle node at 1.29ms, which starts forwarding then
+  // and is done 1.16ms later.
+  NS_TEST_ASSERT_MSG_EQ (m_rxTimes.size (), 2, "Packet not forwarded");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes[0], Seconds (1.0) + MicroSeconds (2160),
+                         "Super-segment received at the wrong time on the first hop");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes[1], Seconds (1.0) + MicroSeconds (3450),
+                         "Super-segment received at the wrong time on the second hop");
+
+  Simulator::Destroy ();
+  m_next = 0;
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -117,6 +537,9 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointDirectLinkTest, TestCase::QUICK);
+  AddTestCase (new PointToPointCoalescedDeliveryTest, TestCase::QUICK);
+  AddTestCase (new PointToPointSegmentOffloadTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -36,6 +36,8 @@ NS_LOG_COMPONENT_DEFINE ("SqliteDataOutput");
 //--------------------------------------------------------------
 //----------------------------------------------
 SqliteDataOutput::SqliteDataOutput()
+  : m_db (0),
+    m_batch (false)
 {
   NS_LOG_FUNCTION (this);
 
@@ -44,6 +46,7 @@ SqliteDataOutput::SqliteDataOutput()
 SqliteDataOutput::~SqliteDataOutput()
 {
   NS_LOG_FUNCTION (this);
+  Close ();
 }
 /* static */
 TypeId
@@ -61,6 +64,7 @@ SqliteDataOutput::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
 
+  Close ();
   DataOutputInterface::DoDispose ();
   // end SqliteDataOutput::DoDispose
 }
@@ -110,23 +114,93 @@ SqliteDataOutput::Exec (std::string exe) {
   // end SqliteDataOutput::Exec
 }
 
-//----------------------------------------------
-void
-SqliteDataOutput::Output (DataCollector &dc)
+bool
+SqliteDataOutput::Open (void)
 {
-  NS_LOG_FUNCTION (this << &dc);
+  NS_LOG_FUNCTION (this);
 
-  std::string m_dbFile = m_filePrefix + ".db";
+  std::string dbFile = m_filePrefix + ".db";
+  if (m_db != 0 && dbFile == m_dbFile)
+    {
+      return true;
+    }
+  Close ();
 
-  if (sqlite3_open (m_dbFile.c_str (), &m_db)) {
-      NS_LOG_ERROR ("Could not open sqlite3 database \"" << m_dbFile << "\"");
+  if (sqlite3_open (dbFile.c_str (), &m_db)) {
+      NS_LOG_ERROR ("Could not open sqlite3 database \"" << dbFile << "\"");
       NS_LOG_ERROR ("sqlite3 error \"" << sqlite3_errmsg (m_db) << "\"");
       sqlite3_close (m_db);
+      m_db = 0;
       /// \todo Better error reporting, management!
-      return;
+      return false;
     }
+  m_dbFile = dbFile;
+
+  // Wait for the other processes writing to the same database.
+  sqlite3_busy_timeout (m_db, 60000);
 
   Exec ("create table if not exists Experiments (run, experiment, strategy, input, description text)");
+  Exec ("create table if not exists Metadata ( run text, key text, value)");
+  Exec ("create table if not exists Singletons ( run text, name text, variable text, value )");
+  return true;
+}
+
+void
+SqliteDataOutput::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_db == 0)
+    {
+      return;
+    }
+  EndBatch ();
+  sqlite3_close (m_db);
+  m_db = 0;
+}
+
+void
+SqliteDataOutput::BeginBatch (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_batch && Open ())
+    {
+      Exec ("BEGIN IMMEDIATE");
+      m_batch = true;
+    }
+}
+
+void
+SqliteDataOutput::EndBatch (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_batch)
+    {
+      Exec ("COMMIT");
+      m_batch = false;
+    }
+}
+
+//----------------------------------------------
+void
+SqliteDataOutput::Output (DataCollector &dc)
+{
+  NS_LOG_FUNCTION (this << &dc);
+
+  if (!Open ())
+    {
+      return;
+    }
+
+  // Write the whole run in one transaction, or in that of the batch:
+  // each commit is a sync of the file, which dominates the cost of a
+  // run with few values.
+  if (!m_batch)
+    {
+      Exec ("BEGIN IMMEDIATE");
+    }
 
   sqlite3_stmt *stmt;
   sqlite3_prepare_v2 (m_db,
@@ -149,7 +223,6 @@ SqliteDataOutput::Output (DataCollector &dc)
   sqlite3_step (stmt);
   sqlite3_finalize (stmt);
 
-  Exec ("create table if not exists Metadata ( run text, key text, value)");
 
   sqlite3_prepare_v2 (m_db,
     "insert into Metadata (run, key, value) values (?, ?, ?)",
@@ -172,15 +245,19 @@ SqliteDataOutput::Output (DataCollector &dc)
     }
   sqlite3_finalize (stmt);
 
-  Exec ("BEGIN");
-  SqliteOutputCallback callback (this, run);
-  for (DataCalculatorList::iterator i = dc.DataCalculatorBegin ();
-       i != dc.DataCalculatorEnd (); i++) {
-      (*i)->Output (callback);
+  // The callback finalizes its statement when it goes out of scope,
+  // which must happen before the transaction is committed.
+  {
+    SqliteOutputCallback callback (this, run);
+    for (DataCalculatorList::iterator i = dc.DataCalculatorBegin ();
+         i != dc.DataCalculatorEnd (); i++) {
+        (*i)->Output (callback);
+      }
+  }
+  if (!m_batch)
+    {
+      Exec ("COMMIT");
     }
-  Exec ("COMMIT");
-
-  sqlite3_close (m_db);
 
   // end SqliteDataOutput::Output
 }
@@ -192,8 +269,6 @@ SqliteDataOutput::SqliteOutputCallback::SqliteOutputCallback
 {
   NS_LOG_FUNCTION (this << owner << run);
 
-  m_owner->Exec ("create table if not exists Singletons ( run text, name text, variable text, value )");
-
   sqlite3_prepare_v2 (m_owner->m_db,
     "insert into Singletons (run, name, variable, value) values (?, ?, ?, ?)",
     -1,
@@ -37,6 +37,12 @@ namespace ns3 {
  * \ingroup dataoutput
  * \class SqliteDataOutput
  * \brief Outputs data in a format compatible with SQLite
+ *
+ * The database stays open from the first call to Output until the
+ * object is disposed or the file prefix changes.  Each call to Output
+ * is written in a transaction of its own, unless BeginBatch was
+ * called: the calls up to EndBatch then share one transaction, and a
+ * single sync of the file.
  */
 class SqliteDataOutput : public DataOutputInterface {
 public:
@@ -51,6 +57,18 @@ public:
   
   virtual void Output (DataCollector &dc);
 
+  /**
+   * \brief Write the following calls to Output in one transaction.
+   *
+   * The transaction is committed by EndBatch, or when the database
+   * is closed.
+   */
+  void BeginBatch (void);
+  /**
+   * \brief Commit the calls to Output since BeginBatch.
+   */
+  void EndBatch (void);
+
 protected:
   virtual void DoDispose ();
 
@@ -143,7 +161,19 @@ private:
   };
 
 
-  sqlite3 *m_db; //!< pointer to the SQL database
+  sqlite3 *m_db; //!< pointer to the SQL database, or 0 if not open
+  std::string m_dbFile; //!< the file of the open database
+  bool m_batch; //!< true if a transaction is open across calls to Output
+
+  /**
+   * \brief Open the database of the file prefix, and create its tables.
+   * \return true if the database is open
+   */
+  bool Open (void);
+  /**
+   * \brief Commit the open transaction, if any, and close the database.
+   */
+  void Close (void);
 
   /**
    * \brief Execute a sqlite3 query
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <utility>
+
+#include "ns3/core-module.h"
+#include "ns3/system-thread.h"
+
+using namespace ns3;
+
+// Output field width
+int g_fwidth = 12;
+
+/// Bench class: producer threads inject events into a running simulation
+class CrossThreadBench
+{
+public:
+  /**
+   * constructor
+   * \param producers the number of producer threads
+   * \param events the number of events injected by each producer
+   */
+  CrossThreadBench (uint32_t producers, uint32_t events)
+    : m_producers (producers),
+      m_events (events)
+  {
+  }
+
+  /// Run function
+  void RunBench (void);
+private:
+  /**
+   * Producer thread body
+   * \param context the bench and the producer number
+   */
+  static void Produce (std::pair<CrossThreadBench *, uint32_t> context);
+  /// Injected event
+  void Cb (void);
+  /// Keep the simulation alive until all injected events ran
+  void Poll (void);
+
+  uint32_t m_producers; ///< number of producer threads
+  uint32_t m_events;    ///< events per producer
+  std::atomic<uint64_t> m_count;  ///< injected events executed
+  std::atomic<bool> m_go;         ///< start flag for the producers
+  std::atomic<uint64_t> m_pushMs; ///< sum of producer times, in ms
+};
+
+void
+CrossThreadBench::Produce (std::pair<CrossThreadBench *, uint32_t> context)
+{
+  CrossThreadBench *me = context.first;
+  while (!me->m_go)
+    {
+    }
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < me->m_events; ++i)
+    {
+      Simulator::ScheduleWithContext (context.second, NanoSeconds (1), &CrossThreadBench::Cb, me);
+    }
+  me->m_pushMs += time.End ();
+}
+
+void
+CrossThreadBench::Cb (void)
+{
+  ++m_count;
+}
+
+void
+CrossThreadBench::Poll (void)
+{
+  if (m_count < (uint64_t) m_producers * m_events)
+    {
+      Simulator::Schedule (NanoSeconds (1), &CrossThreadBench::Poll, this);
+    }
+}
+
+void
+CrossThreadBench::RunBench (void)
+{
+  m_count = 0;
+  m_go = false;
+  m_pushMs = 0;
+
+  std::list<Ptr<SystemThread> > threads;
+  for (uint32_t p = 0; p < m_producers; ++p)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (
+          MakeBoundCallback (&CrossThreadBench::Produce, std::pair<CrossThreadBench *, uint32_t> (this, p)));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+
+  SystemWallClockMs time;
+  Simulator::Schedule (NanoSeconds (1), &CrossThreadBench::Poll, this);
+  time.Start ();
+  m_go = true;
+  Simulator::Run ();
+  double simu = time.End () / 1000.0;
+
+  for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+
+  uint64_t total = m_count;
+  double push = m_pushMs / 1000.0 / m_producers;
+  std::cout << std::setw (g_fwidth) << simu <<
+    std::setw (g_fwidth) << (total / simu) <<
+    std::setw (g_fwidth) << push <<
+    std::setw (g_fwidth) << (m_events / push) <<
+    std::endl;
+}
+
+
+int main (int argc, char *argv[])
+{
+  uint32_t producers = 4;
+  uint32_t events = 1000000;
+  uint32_t capacity = 0;
+  uint32_t runs = 3;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark events scheduled into a running simulation "
+             "from several threads.\n"
+             "\n"
+             "Each producer thread calls Simulator::ScheduleWithContext\n"
+             "as fast as it can while the main thread runs the simulation.");
+  cmd.AddValue ("producers", "number of producer threads", producers);
+  cmd.AddValue ("events", "events scheduled by each producer", events);
+  cmd.AddValue ("capacity", "DefaultSimulatorImpl::MaxEventsWithContext (0: unbounded)", capacity);
+  cmd.AddValue ("runs", "number of runs", runs);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::MaxEventsWithContext", UintegerValue (capacity));
+
+  std::cout << cmd.GetName () << ": producers: " << producers <<
+    ", events per producer: " << events <<
+    ", capacity: " << capacity << std::endl;
+  std::cout << std::left << std::setw (g_fwidth) << "Run #" <<
+    std::setw (g_fwidth) << "Time (s)" <<
+    std::setw (g_fwidth) << "Rate (ev/s)" <<
+    std::setw (g_fwidth) << "Push (s)" <<
+    std::setw (g_fwidth) << "Push (ev/s)" <<
+    std::endl;
+
+  CrossThreadBench bench (producers, events);
+  for (uint32_t i = 0; i < runs; i++)
+    {
+      std::cout << std::setw (g_fwidth) << i;
+      bench.RunBench ();
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}